@@ -122,6 +122,10 @@ mkdir %workingdir%\out_%ver_name%\York_nc6\
 chdir %workingdir%\_InputFiles\York_nc\
 %ravexe% York_nongridded_m_subdaily_i_daily -o %workingdir%\out_%ver_name%\York_nc6\
 
+mkdir %workingdir%\out_%ver_name%\York_nc7\
+chdir %workingdir%\_InputFiles\York_nc\
+%ravexe% York_gridded_m_daily_i_subdaily_chunked -o %workingdir%\out_%ver_name%\York_nc7\
+
 mkdir %workingdir%\out_%ver_name%\ElbowHistoric\
 chdir %workingdir%\_InputFiles\ElbowHistoric\
 %ravexe% elbow -o %workingdir%\out_%ver_name%\ElbowHistoric\
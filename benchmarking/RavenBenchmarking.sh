@@ -34,8 +34,8 @@ if [ -e ${workingdir}"/out_"${ver_name} ] ; then
 fi
 mkdir ${workingdir}"/out_"${ver_name}
 
-test_cases=(    "Alouette" "Alouette2" "York" "York2" "Irondequoit" "LOTW" "LaJoie" "Nith" "Revelstoke" "Salmon_GR4J" "Salmon_HBV" "Salmon_HMETS" "Salmon_MOHYSE" "Williston_Finlay")
-test_cases_rvi=("Alouette_ws" "Alouette2" "York_gridded_m_daily_i_daily" "York2_gridded_m_subdaily_i_subdaily" "Irondequoit" "LOWRL" "La_Joie_ws" "Nith" "Revelstoke_ws" "raven-gr4j-salmon" "raven-hbv-salmon" "raven-hmets-salmon" "raven-mohyse-salmon" "Williston_Finlay_ws")
+test_cases=(    "Alouette" "Alouette2" "York" "York2" "York_nc" "Irondequoit" "LOTW" "LaJoie" "Nith" "Revelstoke" "Salmon_GR4J" "Salmon_HBV" "Salmon_HMETS" "Salmon_MOHYSE" "Williston_Finlay")
+test_cases_rvi=("Alouette_ws" "Alouette2" "York_gridded_m_daily_i_daily" "York2_gridded_m_subdaily_i_subdaily" "York_gridded_m_daily_i_subdaily_chunked" "Irondequoit" "LOWRL" "La_Joie_ws" "Nith" "Revelstoke_ws" "raven-gr4j-salmon" "raven-hbv-salmon" "raven-hmets-salmon" "raven-mohyse-salmon" "Williston_Finlay_ws")
 
 ntest_cases=$( echo "${#test_cases[@]}" )
 # 
@@ -41,6 +41,7 @@ public:/*-------------------------------------------------------*/
                         const optStruct   &Options,
                         const time_struct &t,
                         double      *rates) const;
+  bool IsThreadSafe() const { return false; } //uses static work arrays
 
   void        GetParticipatingParamList   (string  *aP, class_type *aPC, int &nP) const;
 };
@@ -305,3 +305,87 @@ void   CmvBaseflow::ApplyConstraints( const double     *storage,
   //cannot pull water from river
   rates[0]=max(rates[0],0.0);
 }
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns rates of baseflow for a block of HRUs [mm/d]
+/// \details Method and soil layer are resolved once per block; the common linear, analytic linear
+/// and power law methods are evaluated in a tight HRU loop. Other methods use GetRatesOfChange()
+///
+/// \param **storage [in] state variable arrays of HRUs in block
+/// \param **pHRUs [in] HRUs in block
+/// \param nHRUs [in] number of HRUs in block
+/// \param &Options [in] Global model options information
+/// \param &tt [in] Current input time structure
+/// \param **rates [out] Rates of baseflow for each HRU [mm/d]
+//
+void   CmvBaseflow::GetRatesOfChangeBlock(const double      *const *storage,
+                                          const CHydroUnit  *const *pHRUs,
+                                          const int                 nHRUs,
+                                          const optStruct          &Options,
+                                          const time_struct        &tt,
+                                                double      *const *rates) const
+{
+  if ((pModel->GetStateVarType(iFrom[0])!=SOIL) ||
+      ((type!=BASE_LINEAR) && (type!=BASE_LINEAR_ANALYTIC) && (type!=BASE_POWER_LAW)))
+  {
+    CHydroProcessABC::GetRatesOfChangeBlock(storage,pHRUs,nHRUs,Options,tt,rates);
+    return;
+  }
+
+  const int    i0   =iFrom[0];
+  const int    m    =pModel->GetStateVarLayer(i0); //which soil layer
+  const double tstep=Options.timestep;
+  double       stor;
+  const soil_struct *pSoil;
+
+  if (type==BASE_LINEAR)
+  {
+    for (int b=0;b<nHRUs;b++){
+      pSoil=pHRUs[b]->GetSoilProps(m);
+      stor =min(max(storage[b][i0],0.0),pHRUs[b]->GetSoilCapacity(m));
+      rates[b][0]=pSoil->baseflow_coeff*stor;
+    }
+  }
+  else if (type==BASE_LINEAR_ANALYTIC)
+  {
+    for (int b=0;b<nHRUs;b++){
+      pSoil=pHRUs[b]->GetSoilProps(m);
+      stor =min(max(storage[b][i0],0.0),pHRUs[b]->GetSoilCapacity(m));
+      rates[b][0]=stor*(1-exp(-pSoil->baseflow_coeff*tstep))/tstep;
+    }
+  }
+  else if (type==BASE_POWER_LAW)
+  {
+    for (int b=0;b<nHRUs;b++){
+      pSoil=pHRUs[b]->GetSoilProps(m);
+      stor =min(max(storage[b][i0],0.0),pHRUs[b]->GetSoilCapacity(m));
+      rates[b][0]=pSoil->baseflow_coeff*pow(stor,pSoil->baseflow_n);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Applies constraints to baseflow for a block of HRUs
+/// \details identical to ApplyConstraints(), applied to each HRU in block
+///
+/// \param **storage [in] state variable arrays of HRUs in block
+/// \param **pHRUs [in] HRUs in block (unused)
+/// \param nHRUs [in] number of HRUs in block
+/// \param &Options [in] Global model options information
+/// \param &tt [in] Current input time structure (unused)
+/// \param **rates [out] Rates of baseflow for each HRU [mm/d]
+//
+void   CmvBaseflow::ApplyConstraintsBlock(const double      *const *storage,
+                                          const CHydroUnit  *const * /*pHRUs*/,
+                                          const int                 nHRUs,
+                                          const optStruct          &Options,
+                                          const time_struct        & /*tt*/,
+                                                double      *const *rates) const
+{
+  const int    i0      =iFrom[0];
+  const double min_stor=g_min_storage;
+  for (int b=0;b<nHRUs;b++){
+    rates[b][0]=threshMin(rates[b][0],max(storage[b][i0],min_stor)/Options.timestep,0.0); //cant remove more than is there
+    rates[b][0]=max(rates[b][0],0.0);                                                      //cannot pull water from river
+  }
+}
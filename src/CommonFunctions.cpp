@@ -1321,11 +1321,14 @@ void SubstringReplace(string &str,const string &from,const string &to)
 void WriteWarning(const string warn, bool noisy)
 {
   if (!g_suppress_warnings){
-    ofstream WARNINGS;
-    WARNINGS.open((g_output_directory+"Raven_errors.txt").c_str(),ios::app);
-    if (noisy){cout<<"WARNING!: "<<warn<<endl;}
-    WARNINGS<<"WARNING  : "<<warn<<endl;
-    WARNINGS.close();
+    #pragma omp critical(raven_errors_file) //may be called from within parallel solver loops
+    {
+      ofstream WARNINGS;
+      WARNINGS.open((g_output_directory+"Raven_errors.txt").c_str(),ios::app);
+      if (noisy){cout<<"WARNING!: "<<warn<<endl;}
+      WARNINGS<<"WARNING  : "<<warn<<endl;
+      WARNINGS.close();
+    }
   }
 }
 /////////////////////////////////////////////////////////////////
@@ -1335,11 +1338,14 @@ void WriteWarning(const string warn, bool noisy)
 void WriteAdvisory(const string warn, bool noisy)
 {
   if (!g_suppress_warnings){
-    ofstream WARNINGS;
-    WARNINGS.open((g_output_directory+"Raven_errors.txt").c_str(),ios::app);
-    if (noisy){cout<<"ADVISORY: "<<warn<<endl;}
-    WARNINGS<<"ADVISORY : "<<warn<<endl;
-    WARNINGS.close();
+    #pragma omp critical(raven_errors_file) //may be called from within parallel solver loops
+    {
+      ofstream WARNINGS;
+      WARNINGS.open((g_output_directory+"Raven_errors.txt").c_str(),ios::app);
+      if (noisy){cout<<"ADVISORY: "<<warn<<endl;}
+      WARNINGS<<"ADVISORY : "<<warn<<endl;
+      WARNINGS.close();
+    }
   }
 }
 ///////////////////////////////////////////////////////////////////
@@ -1844,7 +1850,7 @@ int SmartIntervalSearch(const double &x,const double *ax,const int N,const int i
 //
 double InterpolateCurve(const double x,const double *xx,const double *y,int N,bool extrapbottom)
 {
-  static int ilast=0;
+  static thread_local int ilast=0; //search hint only; per-thread so that subbasins may be routed in parallel
   if(x<=xx[0])
   {
     if(extrapbottom) { return y[0]+(y[1]-y[0])/(xx[1]-xx[0])*(x-xx[0]); }
@@ -1721,6 +1721,73 @@ void CConstituentModel::WriteMajorOutput(ofstream &RVC) const
   RVC<<":EndBasinTransportVariables"<<endl;
 }
 //////////////////////////////////////////////////////////////////
+/// \brief returns number of values stored by SaveToSnapshot()
+/// \return size of constituent routing state in an in-memory model snapshot
+//
+int CConstituentModel::GetSnapshotSize() const
+{
+  int size=0;
+  for(int p=0;p<_pModel->GetNumSubBasins();p++)
+  {
+    size+=2+(_pModel->GetSubBasin(p)->GetNumSegments()+1)+(_nMlatHist[p]+1)+_nMinHist[p];
+    if(_pModel->GetSubBasin(p)->GetReservoir()!=NULL) { size+=6; }
+    if(_type==ENTHALPY)                               { size++;  }
+  }
+  return size;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief copies constituent routing state variables (same as those in solution file) to in-memory snapshot
+/// \param *aSnapshot [out] snapshot array
+/// \param &ii [in/out] current position in snapshot array (incremented by GetSnapshotSize())
+//
+void CConstituentModel::SaveToSnapshot(double *aSnapshot, int &ii) const
+{
+  for(int p=0;p<_pModel->GetNumSubBasins();p++)
+  {
+    int nSegs=_pModel->GetSubBasin(p)->GetNumSegments();
+    aSnapshot[ii++]=_channel_storage[p];
+    aSnapshot[ii++]=_rivulet_storage[p];
+    for(int i=0;i<nSegs;        i++) { aSnapshot[ii++]=_aMout    [p][i]; } aSnapshot[ii++]=_aMout_last[p];
+    for(int i=0;i<_nMlatHist[p];i++) { aSnapshot[ii++]=_aMlatHist[p][i]; } aSnapshot[ii++]=_aMlat_last[p];
+    for(int i=0;i<_nMinHist[p]; i++) { aSnapshot[ii++]=_aMinHist [p][i]; }
+    if(_pModel->GetSubBasin(p)->GetReservoir()!=NULL) {
+      aSnapshot[ii++]=_aMout_res[p]; aSnapshot[ii++]=_aMout_res_last[p];
+      aSnapshot[ii++]=_aMres    [p]; aSnapshot[ii++]=_aMres_last    [p];
+      aSnapshot[ii++]=_aMsed    [p]; aSnapshot[ii++]=_aMsed_last    [p];
+    }
+    if (_type == ENTHALPY) {
+      CEnthalpyModel *pEnth=(CEnthalpyModel*)(this);
+      aSnapshot[ii++]=pEnth->GetBedTemperature(p);
+    }
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief restores constituent routing state variables from in-memory snapshot written by SaveToSnapshot()
+/// \param *aSnapshot [in] snapshot array
+/// \param &ii [in/out] current position in snapshot array (incremented by GetSnapshotSize())
+//
+void CConstituentModel::RestoreFromSnapshot(const double *aSnapshot, int &ii)
+{
+  for(int p=0;p<_pModel->GetNumSubBasins();p++)
+  {
+    int nSegs=_pModel->GetSubBasin(p)->GetNumSegments();
+    _channel_storage[p]=aSnapshot[ii++];
+    _rivulet_storage[p]=aSnapshot[ii++];
+    for(int i=0;i<nSegs;        i++) { _aMout    [p][i]=aSnapshot[ii++]; } _aMout_last[p]=aSnapshot[ii++];
+    for(int i=0;i<_nMlatHist[p];i++) { _aMlatHist[p][i]=aSnapshot[ii++]; } _aMlat_last[p]=aSnapshot[ii++];
+    for(int i=0;i<_nMinHist[p]; i++) { _aMinHist [p][i]=aSnapshot[ii++]; }
+    if(_pModel->GetSubBasin(p)->GetReservoir()!=NULL) {
+      _aMout_res[p]=aSnapshot[ii++]; _aMout_res_last[p]=aSnapshot[ii++];
+      _aMres    [p]=aSnapshot[ii++]; _aMres_last    [p]=aSnapshot[ii++];
+      _aMsed    [p]=aSnapshot[ii++]; _aMsed_last    [p]=aSnapshot[ii++];
+    }
+    if (_type == ENTHALPY) {
+      CEnthalpyModel *pEnth=(CEnthalpyModel*)(this);
+      pEnth->SetBedTemperature(p,aSnapshot[ii++]);
+    }
+  }
+}
+//////////////////////////////////////////////////////////////////
 /// \brief clears all time series data for re-read of .rvt file
 /// \remark Called only in ensemble mode
 ///
@@ -286,9 +286,9 @@ void   CmvConvolution::GetRatesOfChange( const double      *state_vars,
   int i;
   double TS_old;
   double tstep=Options.timestep;
-  static double S         [MAX_CONVOL_STORES];
-  static double aUnitHydro[MAX_CONVOL_STORES];
-  static int    aInterval [MAX_CONVOL_STORES];
+  double S         [MAX_CONVOL_STORES];
+  double aUnitHydro[MAX_CONVOL_STORES];
+  int    aInterval [MAX_CONVOL_STORES];
 
   int N =0;
   GenerateUnitHydrograph(pHRU,Options,&aUnitHydro[0],&aInterval[0],N); //THIS IS SLOW!! - create aUnitHydro as process array
@@ -297,6 +297,7 @@ void   CmvConvolution::GetRatesOfChange( const double      *state_vars,
   TS_old=state_vars[iFrom[2*_nStores-1]]; //total storage after water added to convol stores earlier in process list
   double sum(0.0);
   int NN=0;
+  S[0]=0.0; //empty unit hydrograph
   for (i=0;i<N;i++){
     S[i]=state_vars[iFrom[i]];
     sum+=S[i];
@@ -5,8 +5,6 @@ Copyright (c) 2008-2023 the Raven Development Team
 #include "ModelEnsemble.h"
 
 //external function declarations
-double UniformRandom();
-double GaussRandom();
 bool   ParseInitialConditions(CModel *&pModel,const optStruct &Options);
 
 //////////////////////////////////////////////////////////////////
@@ -24,6 +22,11 @@ CDDSEnsemble::CDDSEnsemble(const int num_members,const optStruct &Options)
   _TestParams=NULL;
   _Fbest=ALMOST_INF;
   _r_val=0.2;
+  _nCompleted=0;
+  _aCandidates=NULL;
+  _early_term=false;
+  _pObjAccum=NULL;
+  _terminated=false;
 
   _calib_SBID=DOESNT_EXIST;
   _calib_Obj=DIAG_NASH_SUTCLIFFE;
@@ -41,6 +44,11 @@ CDDSEnsemble::~CDDSEnsemble()
   delete[] _pParamDists; _nParamDists=0;
   delete[] _BestParams;
   delete[] _TestParams;
+  if(_aCandidates!=NULL) {
+    for(int e=0;e<_nMembers;e++) { delete [] _aCandidates[e]; }
+    delete [] _aCandidates;
+  }
+  delete _pObjAccum;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -74,6 +82,15 @@ void CDDSEnsemble::SetCalibrationTarget(const long SBID,const diag_type object_d
   _calib_Period=period;
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief turns on early termination of candidates whose objective function cannot improve upon the best solution
+/// \param early_term [in] true if candidate runs are to be terminated early
+//
+void CDDSEnsemble::SetEarlyTermination(const bool early_term)
+{
+  _early_term=early_term;
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief initializes DDS caliobration run
 /// \param &Options [out] Global model options information
@@ -101,6 +118,19 @@ void CDDSEnsemble::Initialize(const CModel* pModel,const optStruct &Options)
     _BestParams[i]=_TestParams[i]=_pParamDists[i]->default_val;
   }
 
+  // Set up online objective function accumulation for early termination
+  //-----------------------------------------------
+  if(_early_term)
+  {
+    if(CDiagAccumulator::IsBounded(_calib_Obj)) {
+      _pObjAccum=pModel->CreateObjFuncAccumulator(_calib_SBID,_calib_Obj,_calib_Period);
+    }
+    else {
+      WriteWarning("CDDSEnsemble::Initialize: :EarlyTermination is only supported for DIAG_NASH_SUTCLIFFE, DIAG_RMSE, and DIAG_ABSERR objective functions; command will be ignored",Options.noisy);
+      _early_term=false;
+    }
+  }
+
   // Create and open DDSOutput file
   //-----------------------------------------------
   string filename=Options.main_output_dir+"DDSOutput.csv";
@@ -119,6 +149,7 @@ Translated by James Craig July 2006 from Bryan Tolson's Fortran DDS code
 returns  new decision variable value (within specified min and max)
 **********************************************************************/
 double CDDSEnsemble::PerturbParam(const double &x_best, //current best decision variable (DV) value
+                                  const double &z,      //standard normal random variate
                                   const double &lowerbound,
                                   const double &upperbound)
 {
@@ -126,7 +157,7 @@ double CDDSEnsemble::PerturbParam(const double &x_best, //current best decision
   double x_min = lowerbound;
   double x_max = upperbound;
 
-  x_new=x_best+GaussRandom()*_r_val*(x_max-x_min);
+  x_new=x_best+z*_r_val*(x_max-x_min);
 
   // need if statements to check within DV bounds.  If not, bounds are reflecting.
   if(x_new<x_min)
@@ -143,46 +174,68 @@ double CDDSEnsemble::PerturbParam(const double &x_best, //current best decision
 }
 
 //////////////////////////////////////////////////////////////////
-/// \brief updates model - called PRIOR to each model ensemble run
-/// \param pModel [out] pointer to global model instance
-/// \param &Options [out] Global model options information
+/// \brief generates DDS candidate parameter vector for iteration e by perturbing current best solution
+/// \param e [in] DDS iteration (ensemble member) index
+/// \param params [out] candidate parameter vector [size: _nParamDists]
 //
-void CDDSEnsemble::UpdateModel(CModel *pModel,optStruct &Options,const int e)
+void CDDSEnsemble::GenerateCandidate(const int e,double *params)
 {
-  CEnsemble::UpdateModel(pModel,Options,e);
-  ExitGracefullyIf(e>=_nMembers,"CDDSEnsemble::UpdateMode: invalid ensemble member index",RUNTIME_ERR);
-
-  //int iters_remaining=_nMembers-e;
-  double u;
-
-  //- update output file/ run names ----------------------------
-  Options.output_dir=_aOutputDirs[e];
-  Options.run_name  =_aRunNames[e];
+  //- random variates for iteration e: u[k] selects DV k, u[_nParamDists] selects a DV if none are
+  //  selected, and z[k] is perturbation of DV k (keyed by iteration, so parallel DDS is reproducible)
+  double *u=new double [_nParamDists+1];
+  double *z=new double [_nParamDists];
+  const double std_normal[3]={0.0,1.0,0.0};
+  rand_key key={_rand_seed,RAND_DDS_SELECT,e,0,0};
+  RandomUniform(key,u,_nParamDists+1);
+  key.stream=RAND_DDS_PERTURB;
+  SampleFromDistribution(DIST_NORMAL,std_normal,key,z,_nParamDists);
 
-  //- Update parameter values ----------------------------------
   // Determine variable selected as neighbour
   double Pn=1.0-log(double(e))/log(double(_nMembers));
   int dvn_count=0;
 
-  //- define TestParams initially as best current solution------
+  //- define candidate initially as best current solution------
   for(int k=0;k<_nParamDists;k++)
   {
-    _TestParams[k]=_BestParams[k];
+    params[k]=_BestParams[k];
   }
 
-  //- perturb TestParams --------------------------------------
+  //- perturb candidate ---------------------------------------
   for(int k=0;k<_nParamDists;k++)
   {
-    u=UniformRandom();
-    if(u<Pn) {
+    if(u[k]<Pn) {
       dvn_count++;
-      _TestParams[k]=PerturbParam(_BestParams[k],_pParamDists[k]->distpar[0],_pParamDists[k]->distpar[1]);
+      params[k]=PerturbParam(_BestParams[k],z[k],_pParamDists[k]->distpar[0],_pParamDists[k]->distpar[1]);
     }
   }
   if(dvn_count==0) {
-    u=UniformRandom();
-    int dv=(int)(ceil((double)(_nParamDists)*u))-1; // index for one DV
-    _TestParams[dv]=PerturbParam(_BestParams[dv],_pParamDists[dv]->distpar[0],_pParamDists[dv]->distpar[1]);
+    int dv=(int)(ceil((double)(_nParamDists)*u[_nParamDists]))-1; // index for one DV
+    params[dv]=PerturbParam(_BestParams[dv],z[dv],_pParamDists[dv]->distpar[0],_pParamDists[dv]->distpar[1]);
+  }
+  delete [] u;
+  delete [] z;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief updates model - called PRIOR to each model ensemble run
+/// \param pModel [out] pointer to global model instance
+/// \param &Options [out] Global model options information
+//
+void CDDSEnsemble::UpdateModel(CModel *pModel,optStruct &Options,const int e)
+{
+  CEnsemble::UpdateModel(pModel,Options,e);
+  ExitGracefullyIf(e>=_nMembers,"CDDSEnsemble::UpdateMode: invalid ensemble member index",RUNTIME_ERR);
+
+  //- update output file/ run names ----------------------------
+  Options.output_dir=_aOutputDirs[e];
+  Options.run_name  =_aRunNames[e];
+
+  //- Update parameter values ----------------------------------
+  if((_aCandidates!=NULL) && (_aCandidates[e]!=NULL)) { //generated in parent process by PrepareMemberRun
+    for(int k=0;k<_nParamDists;k++) { _TestParams[k]=_aCandidates[e][k]; }
+  }
+  else {
+    GenerateCandidate(e,_TestParams);
   }
 
   //- update parameters in model -----------------------------
@@ -199,24 +252,78 @@ void CDDSEnsemble::UpdateModel(CModel *pModel,optStruct &Options,const int e)
   }
   pModel->CalculateInitialWaterStorage(Options);
 
+  //- Reset online objective function -------------------------
+  _terminated=false;
+  if(_pObjAccum!=NULL) { _pObjAccum->Reset(); }
+
   //The model is run following this routine call...
 }
+
+//////////////////////////////////////////////////////////////////
+/// \brief called at end of each time step of DDS iteration e
+/// \details accumulates objective function of candidate online; since the partial error sum bounds the final
+/// objective function from below, the candidate is rejected as soon as the bound exceeds the best solution found so far.
+/// In parallel DDS, the best solution is that known when the candidate was dispatched.
+/// \param pModel [in] pointer to global model instance
+/// \param &Options [in] Global model options information
+/// \param &tt [in] current model time structure
+/// \param e [in] DDS iteration (ensemble member) index
+//
+void CDDSEnsemble::CloseTimeStepOps(CModel *pModel,optStruct &Options,const time_struct &tt,const int e)
+{
+  if((_pObjAccum==NULL) || (_terminated)) { return; }
+
+  _pObjAccum->Update(tt.model_time);
+
+  if(_pObjAccum->GetBound()>_Fbest)
+  {
+    _terminated=true;
+    if(!Options.silent) {
+      cout<<"DDS candidate "<<e+1<<" terminated at t="<<tt.model_time<<": Obj. Function >= "<<_pObjAccum->GetBound()<<" [best: "<<_Fbest<<"]"<<endl;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief returns true if current DDS candidate run has been terminated early
+//
+bool CDDSEnsemble::TerminateMemberRun(const int) const
+{
+  return _terminated;
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief called AFTER each model ensemble run
+/// \details objective function of terminated candidates is the bound, which is known to be worse than best
 /// \param pModel [out] pointer to global model instance
 /// \param &Options [out] Global model options information
 /// \param e [out] ensembe member index
 //
 void CDDSEnsemble::FinishEnsembleRun(CModel *pModel,optStruct &Options,const time_struct &tt,const int e)
 {
-  double Ftest=pModel->GetObjFuncVal(_calib_SBID,_calib_Obj,_calib_Period);
+  double Ftest;
+  if(_terminated) { Ftest=_pObjAccum->GetBound(); }
+  else            { Ftest=pModel->GetObjFuncVal(_calib_SBID,_calib_Obj,_calib_Period); }
+
+  RecordResult(e,Ftest,_TestParams);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief updates best solution with result of DDS iteration e and writes progress
+/// \param e [in] DDS iteration (ensemble member) index
+/// \param &Ftest [in] objective function value of candidate
+/// \param params [in] candidate parameter vector [size: _nParamDists]
+//
+void CDDSEnsemble::RecordResult(const int e,const double &Ftest,const double *params)
+{
+  _nCompleted++;
 
   // update current (best) solution - optimization is minimization
   //----------------------------------------------
   if(Ftest<=_Fbest)
   {
     _Fbest = Ftest;
-    for(int k=0;k<_nParamDists;k++) { _BestParams[k]=_TestParams[k]; }
+    for(int k=0;k<_nParamDists;k++) { _BestParams[k]=params[k]; }
 
     //write results
     _DDSOUT<<e+1<<", "<<_Fbest<<","<<endl;
@@ -229,10 +336,56 @@ void CDDSEnsemble::FinishEnsembleRun(CModel *pModel,optStruct &Options,const tim
 
   // write best parameter vector
   //----------------------------------------------
-  if(e==_nMembers-1)
+  if(_nCompleted==_nMembers)
   {
     _DDSOUT<<"Best parameter vector:"<<endl;
     for(int k=0;k<_nParamDists;k++) {_DDSOUT<<_pParamDists[k]->param_name<<"("<<_pParamDists[k]->class_group <<"), "<<_BestParams[k]<<endl; }
     _DDSOUT.close();
   }
 }
+
+//////////////////////////////////////////////////////////////////
+/// \brief called in parent process before DDS iteration e is dispatched to a worker process (parallel DDS)
+/// \details the candidate perturbs the best solution found among iterations completed so far, so that
+/// workers never wait for each other (asynchronous parallel DDS)
+/// \param pModel [in] pointer to global model instance
+/// \param &Options [in] Global model options information
+/// \param e [in] DDS iteration (ensemble member) index
+//
+void CDDSEnsemble::PrepareMemberRun(CModel *pModel,optStruct &Options,const int e)
+{
+  if(_aCandidates==NULL) {
+    _aCandidates=new double *[_nMembers];
+    ExitGracefullyIf(_aCandidates==NULL,"CDDSEnsemble::PrepareMemberRun",OUT_OF_MEMORY);
+    for(int ee=0;ee<_nMembers;ee++) { _aCandidates[ee]=NULL; }
+  }
+  _aCandidates[e]=new double [_nParamDists];
+  ExitGracefullyIf(_aCandidates[e]==NULL,"CDDSEnsemble::PrepareMemberRun(2)",OUT_OF_MEMORY);
+  GenerateCandidate(e,_aCandidates[e]);
+
+  _DDSOUT.flush(); //otherwise buffered output is duplicated in worker
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief called in worker process after DDS iteration e is run (parallel DDS)
+/// \param pModel [in] pointer to global model instance
+/// \param e [in] DDS iteration (ensemble member) index
+/// \return objective function value
+//
+double CDDSEnsemble::GetMemberResult(const CModel *pModel,const int e) const
+{
+  if(_terminated) { return _pObjAccum->GetBound(); }
+  return pModel->GetObjFuncVal(_calib_SBID,_calib_Obj,_calib_Period);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief called in parent process once worker process has finished DDS iteration e (parallel DDS)
+/// \param e [in] DDS iteration (ensemble member) index
+/// \param result [in] objective function value
+//
+void CDDSEnsemble::AcceptMemberResult(const int e,const double result)
+{
+  RecordResult(e,result,_aCandidates[e]);
+  delete [] _aCandidates[e];
+  _aCandidates[e]=NULL;
+}
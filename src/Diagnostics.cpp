@@ -82,30 +82,30 @@ diag_type CDiagnostic::GetType() const
 }
 
 //////////////////////////////////////////////////////////////////
-/// \brief Implementation of the CDiagnostic constructor
-/// \param typ [in] type of diagnostics
+/// \brief returns base weight of each observation within evaluation period
+/// \details weights are zero for blank observations and for observations excluded by the threshold comparison
+/// \param nnstart [out] index of first observation in evaluation period
+/// \param nnend [out] index following last observation in evaluation period
+/// \return array of base weights [size: nnend]; must be deleted by calling routine
 //
-double CDiagnostic::CalculateDiagnostic(CTimeSeriesABC  *pTSMod,
-                                        CTimeSeriesABC  *pTSObs,
-                                        CTimeSeriesABC  *pTSWeights,
-                                        const double    &starttime,
-                                        const double    &endtime,
-                                        comparison       compare,
-                                        double           threshold,
-                                        const optStruct &Options) const
+double *CDiagnostic::GetBaseWeights(CTimeSeriesABC  *pTSObs,
+                                    CTimeSeriesABC  *pTSWeights,
+                                    const double    &starttime,
+                                    const double    &endtime,
+                                    comparison       compare,
+                                    double           threshold,
+                                    const optStruct &Options,
+                                    int             &nnstart,
+                                    int             &nnend)
 {
   int nn;
-  double N=0;
-  string filename =pTSObs->GetSourceFile();
   double obsval,modval;
-  double weight=1;
 
   int    skip  =0;
   if (!strcmp(pTSObs->GetName().c_str(), "HYDROGRAPH") && (Options.ave_hydrograph == true)){ skip = 1; }
-  double dt = Options.timestep;
 
-  int nnstart=pTSObs->GetTimeIndexFromModelTime(starttime)+skip; //works for avg. hydrographs
-  int nnend  =pTSObs->GetTimeIndexFromModelTime(endtime  )+1; //+1 is just because below loops expressed w.r.t N, not N-1
+  nnstart=pTSObs->GetTimeIndexFromModelTime(starttime)+skip; //works for avg. hydrographs
+  nnend  =pTSObs->GetTimeIndexFromModelTime(endtime  )+1; //+1 is just because below loops expressed w.r.t N, not N-1
 
   threshold=max(min(threshold,1.0),0.0);
 
@@ -153,6 +153,34 @@ double CDiagnostic::CalculateDiagnostic(CTimeSeriesABC  *pTSMod,
       if(obsval>thresh_obsval) {baseweight[nn]=0.0;}
     }
   }
+  return baseweight;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Implementation of the CDiagnostic constructor
+/// \param typ [in] type of diagnostics
+//
+double CDiagnostic::CalculateDiagnostic(CTimeSeriesABC  *pTSMod,
+                                        CTimeSeriesABC  *pTSObs,
+                                        CTimeSeriesABC  *pTSWeights,
+                                        const double    &starttime,
+                                        const double    &endtime,
+                                        comparison       compare,
+                                        double           threshold,
+                                        const optStruct &Options) const
+{
+  int nn;
+  double N=0;
+  string filename =pTSObs->GetSourceFile();
+  double obsval,modval;
+  double weight=1;
+
+  int    skip  =0;
+  if (!strcmp(pTSObs->GetName().c_str(), "HYDROGRAPH") && (Options.ave_hydrograph == true)){ skip = 1; }
+  double dt = Options.timestep;
+
+  int nnstart,nnend;
+  double *baseweight=GetBaseWeights(pTSObs,pTSWeights,starttime,endtime,compare,threshold,Options,nnstart,nnend);
 
 
   switch (_type)
@@ -1329,6 +1357,110 @@ case(DIAG_DAILY_KGE)://----------------------------------------------------
   delete [] baseweight; //\todo: fix! This never gets called!!
   return 0;
 }
+
+/*****************************************************************
+Online diagnostic accumulator
+------------------------------------------------------------------
+*****************************************************************/
+//////////////////////////////////////////////////////////////////
+/// \brief Implementation of the CDiagAccumulator constructor
+/// \details observation weights and normalizing term depend only upon observations, so are calculated once up front
+/// \param typ [in] type of diagnostic (must satisfy IsBounded())
+/// \param pTSMod [in] modeled time series, filled in by CModel::UpdateDiagnostics during simulation
+/// \param pTSObs [in] observed time series
+/// \param pTSWeights [in] observation weights time series (or NULL)
+//
+CDiagAccumulator::CDiagAccumulator(const diag_type  typ,
+                                   CTimeSeriesABC  *pTSMod,
+                                   CTimeSeriesABC  *pTSObs,
+                                   CTimeSeriesABC  *pTSWeights,
+                                   const double    &starttime,
+                                   const double    &endtime,
+                                   comparison       compare,
+                                   double           threshold,
+                                   const optStruct &Options)
+{
+  ExitGracefullyIf(!IsBounded(typ),"CDiagAccumulator: diagnostic cannot be accumulated online",RUNTIME_ERR);
+  _type  =typ;
+  _pTSMod=pTSMod;
+  _pTSObs=pTSObs;
+  _aWeights=CDiagnostic::GetBaseWeights(pTSObs,pTSWeights,starttime,endtime,compare,threshold,Options,_nnstart,_nnend);
+
+  double N(0.0),avgobs(0.0);
+  for(int nn=_nnstart;nn<_nnend;nn++) {
+    avgobs+=_aWeights[nn]*_pTSObs->GetSampledValue(nn);
+    N     +=_aWeights[nn];
+  }
+  _norm=N;
+  if(_type==DIAG_NASH_SUTCLIFFE)
+  {
+    if(N>0.0) { avgobs/=N; }
+    _norm=0.0;
+    for(int nn=_nnstart;nn<_nnend;nn++) {
+      _norm+=_aWeights[nn]*pow(_pTSObs->GetSampledValue(nn)-avgobs,2);
+    }
+  }
+  Reset();
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Implementation of the CDiagAccumulator destructor
+//
+CDiagAccumulator::~CDiagAccumulator()
+{
+  delete [] _aWeights;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief returns true if partial sums of diagnostic bound final value of objective function
+/// \param typ [in] diagnostic type
+//
+bool CDiagAccumulator::IsBounded(const diag_type typ)
+{
+  return ((typ==DIAG_NASH_SUTCLIFFE) || (typ==DIAG_RMSE) || (typ==DIAG_ABSERR));
+}
+//////////////////////////////////////////////////////////////////
+/// \brief clears partial sums - called prior to each model run
+//
+void CDiagAccumulator::Reset()
+{
+  _nn =_nnstart;
+  _sum=0.0;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief adds error terms of all observations simulated by model time t
+/// \details uses same criterion as CModel::UpdateDiagnostics to determine which modeled values are final
+/// \param &t [in] current model time
+//
+void CDiagAccumulator::Update(const double &t)
+{
+  double obsval,modval;
+  double interval=_pTSObs->GetSampledInterval();
+  while((_nn<_nnend) && (t>=_pTSObs->GetSampledTime(_nn)+interval))
+  {
+    if(_aWeights[_nn]>0.0)
+    {
+      obsval=_pTSObs->GetSampledValue(_nn);
+      modval=_pTSMod->GetSampledValue(_nn);
+      if(_type==DIAG_ABSERR) { _sum+=_aWeights[_nn]*fabs(obsval-modval);  }
+      else                   { _sum+=_aWeights[_nn]*pow(obsval-modval,2); }
+    }
+    _nn++;
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief returns lower bound on final objective function value given observations simulated so far
+/// \details expressed for minimization (i.e., -NSE), consistent with CModel::GetObjFuncVal
+//
+double CDiagAccumulator::GetBound() const
+{
+  if(_norm<=0.0) { return -ALMOST_INF; } //no information
+  switch(_type)
+  {
+  case(DIAG_NASH_SUTCLIFFE): { return _sum/_norm-1.0; }
+  case(DIAG_RMSE):           { return sqrt(_sum/_norm); }
+  case(DIAG_ABSERR):         { return _sum/_norm; }
+  default:                   { return -ALMOST_INF; }
+  }
+}
 /*****************************************************************
 Constructor/Destructor
 ------------------------------------------------------------------
@@ -76,6 +76,56 @@ public:/*------------------------------------------------------*/
                              comparison       compare,
                              double           threshold,
                              const optStruct &Options) const;
+
+  static double *GetBaseWeights(CTimeSeriesABC  *pTSObs,
+                                CTimeSeriesABC  *pTSWeights,
+                                const double    &starttime,
+                                const double    &endtime,
+                                comparison       compare,
+                                double           threshold,
+                                const optStruct &Options,
+                                int             &nnstart,
+                                int             &nnend);
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief Online accumulator of diagnostic error sums, updated as modeled values become available during simulation
+/// \details For diagnostics built from sums of non-negative error terms (NSE, RMSE, ABSERR), the partial sum over
+/// the observations simulated so far is a lower bound on the final objective function value (expressed,
+/// as in CModel::GetObjFuncVal, for minimization)
+class CDiagAccumulator
+{
+private:/*------------------------------------------------------*/
+
+  diag_type       _type;     ///< diagnostic type
+  CTimeSeriesABC *_pTSMod;   ///< modeled time series, sampled at observation times
+  CTimeSeriesABC *_pTSObs;   ///< observed time series
+  double         *_aWeights; ///< base weight of each observation [size: _nnend]
+  int             _nnstart;  ///< index of first observation in evaluation period
+  int             _nnend;    ///< index following last observation in evaluation period
+  double          _norm;     ///< normalizing term (sum of weights, or weighted sum of squared deviations from mean for NSE)
+
+  int             _nn;       ///< index of next observation to be accumulated
+  double          _sum;      ///< weighted partial error sum
+
+public:/*------------------------------------------------------*/
+
+  CDiagAccumulator(const diag_type  typ,
+                   CTimeSeriesABC  *pTSMod,
+                   CTimeSeriesABC  *pTSObs,
+                   CTimeSeriesABC  *pTSWeights,
+                   const double    &starttime,
+                   const double    &endtime,
+                   comparison       compare,
+                   double           threshold,
+                   const optStruct &Options);
+  ~CDiagAccumulator();
+
+  static bool IsBounded(const diag_type typ);
+
+  void   Reset   ();
+  void   Update  (const double &t);
+  double GetBound() const;
 };
 
 ///////////////////////////////////////////////////////////////////
@@ -5,6 +5,9 @@ Copyright (c) 2008-2024 the Raven Development Team
 
 #include "EnKF.h"
 #include "Matrix.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 bool IsContinuousFlowObs(const CTimeSeriesABC* pObs,long SBID);
 bool ParseInitialConditions(CModel*& pModel,const optStruct& Options);
@@ -18,6 +21,8 @@ bool ParseTimeSeriesFile(CModel*& pModel,const optStruct& Options);
 // in .rve file:
 //  :EnKFMode ENKF_CLOSED_LOOP or ENKF_SPINUP or ENKF_CLOSED_FORECAST...
 //  :DataHorizon 1 # no. of timesteps (1 for standard EnKF or huge if all data since sim start is used; 2+ for variational approach)
+//  :ForecastHorizon 10 # [d] ENKF_CLOSED_FORECAST only: last 10 days of :Duration are forecast from the assimilated states
+//  :LocalizationRadius 3 {UPSTREAM_ONLY} # states only updated from observations within 3 subbasin links (default: global update)
 //
 //  :ForecastRVTFilename ./meteo/model_forecast.rvt
 //
@@ -66,32 +71,67 @@ CEnKFEnsemble::CEnKFEnsemble(const int num_members,const optStruct &Options)
   _noise_matrix =NULL;
   _nObsDatapoints=0;
 
+  _HA=_A=_P=_Y=_Z=NULL; //assimilation workspace, built upon first assimilation
+  _work=NULL;
+
   _window_size=1;
   _nTimeSteps =0;
+
+  _forecast_horizon=0.0;
+  _t_assim         =0.0; //set in ::Initialize
+  _full_duration   =0.0;
+
+  _loc_radius       =DOESNT_EXIST;
+  _loc_upstream_only=false;
+  _aStateSB     =NULL;
+  _aObsSB       =NULL;
+  _nLocalDomains=0;
+  _aLocStates   =NULL;
+  _aLocNumStates=NULL;
+  _aLocObs      =NULL;
+  _aLocNumObs   =NULL;
+  _nThreads     =1;
+
+  _aFinalStates=NULL;
+  _aInitState  =NULL;
 }
 //////////////////////////////////////////////////////////////////
 /// \brief EnKF Ensemble Destrucutor
 //
 CEnKFEnsemble::~CEnKFEnsemble()
 {
-  for(int e=0;e<_nEnKFMembers;e++) {
-    delete [] _state_matrix [e]; _state_matrix [e]=NULL;
-    delete [] _obs_matrix   [e]; _obs_matrix   [e]=NULL;
-    delete [] _output_matrix[e]; _output_matrix[e]=NULL;
-    delete [] _noise_matrix [e]; _noise_matrix [e]=NULL;
-  }
-  delete [] _state_matrix;
-  delete [] _obs_matrix;
-  delete [] _output_matrix;
-  delete [] _noise_matrix;
+  DeleteContiguousMatrix(_state_matrix);
+  DeleteContiguousMatrix(_obs_matrix);
+  DeleteContiguousMatrix(_output_matrix);
+  DeleteContiguousMatrix(_noise_matrix);
   delete [] _state_names;
 
+  DeleteContiguousMatrix(_HA);
+  DeleteContiguousMatrix(_A);
+  DeleteContiguousMatrix(_P);
+  DeleteContiguousMatrix(_Y);
+  DeleteContiguousMatrix(_Z);
+  delete [] _work;
+
   for (int i=0;i<_nObsPerturbations;i++){delete _pObsPerturbations[i];} delete [] _pObsPerturbations;
 
   delete [] _aAssimStates;
   delete [] _aAssimLayers;
   delete [] _aAssimGroupID;
   delete [] _aObsIndices;
+  if (_aFinalStates!=NULL){
+    for(int e=0;e<_nEnKFMembers;e++) {delete [] _aFinalStates[e];}
+    delete [] _aFinalStates;
+  }
+  delete [] _aInitState;
+
+  delete [] _aStateSB;
+  delete [] _aObsSB;
+  for(int d=0;d<_nLocalDomains;d++) {delete [] _aLocStates[d]; delete [] _aLocObs[d];}
+  delete [] _aLocStates;
+  delete [] _aLocNumStates;
+  delete [] _aLocObs;
+  delete [] _aLocNumObs;
 }
 //////////////////////////////////////////////////////////////////
 /// \brief adds additional state observation perturbation - applied to ALL observations of this type
@@ -167,6 +207,44 @@ void CEnKFEnsemble::SetWindowSize(const int nTimesteps){ _window_size=nTimesteps
 //
 void CEnKFEnsemble::SetExtraRVTFile(string filename){_extra_rvt=filename;}
 
+//////////////////////////////////////////////////////////////////
+/// \brief set duration of forecast following assimilation (ENKF_CLOSED_FORECAST mode)
+/// \param horizon [in] forecast duration [d]
+//
+void CEnKFEnsemble::SetForecastHorizon(const double horizon){_forecast_horizon=horizon;}
+
+//////////////////////////////////////////////////////////////////
+/// \brief enables observation localization
+/// \param radius [in] maximum network distance between state subbasin and observation subbasin [# of subbasin links]
+/// \param upstream_only [in] true if only observations at or downstream of the state subbasin are used
+//
+void CEnKFEnsemble::SetLocalization(const int radius,const bool upstream_only)
+{
+  _loc_radius       =radius;
+  _loc_upstream_only=upstream_only;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Accessor - gets number of model runs in ensemble
+/// \details in ENKF_CLOSED_FORECAST mode, the _nEnKFMembers hindcast runs are followed by
+/// _nEnKFMembers forecast runs, which start from the assimilated hindcast states
+/// \return number of model runs
+//
+int CEnKFEnsemble::GetNumMembers() const
+{
+  if (_EnKF_mode==ENKF_CLOSED_FORECAST){return 2*_nEnKFMembers;}
+  return _nEnKFMembers;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief returns true if run e is a post-assimilation forecast of member e-_nEnKFMembers
+/// \param e [in] ensemble run index
+//
+bool CEnKFEnsemble::IsForecastMember(const int e) const
+{
+  return (e>=_nEnKFMembers);
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Accessor - gets ensemble start time (in local model time)
 /// \param e [in] ensemble index
@@ -174,6 +252,7 @@ void CEnKFEnsemble::SetExtraRVTFile(string filename){_extra_rvt=filename;}
 //
 double CEnKFEnsemble::GetStartTime(const int e) const
 {
+  if (IsForecastMember(e)){return _t_assim;}
   return 0.0;
 }
 
@@ -206,6 +285,13 @@ void CEnKFEnsemble::Initialize(const CModel* pModel,const optStruct &Options)
   if ((_nAssimStates==0) && (_EnKF_mode!=ENKF_FORECAST) && (_EnKF_mode!=ENKF_OPEN_FORECAST)) {
     ExitGracefully("CEnKFEnsemble::Initialize: at least one assimilated state must be set in :ForcingPerturbation command",BAD_DATA);
   }
+  if ((_EnKF_mode==ENKF_CLOSED_FORECAST) && ((_forecast_horizon<Options.timestep-TIME_CORRECTION) || (_forecast_horizon>=Options.duration))) {
+    ExitGracefully("CEnKFEnsemble::Initialize: ENKF_CLOSED_FORECAST mode requires a :ForecastHorizon of at least one time step and shorter than the simulation duration",BAD_DATA);
+  }
+  if ((_EnKF_mode!=ENKF_CLOSED_FORECAST) && (_forecast_horizon!=0.0)) {
+    WriteWarning("CEnKFEnsemble::Initialize: :ForecastHorizon command will be ignored; only valid in ENKF_CLOSED_FORECAST mode",Options.noisy);
+    _forecast_horizon=0.0;
+  }
   if (Options.assimilate_flow == true) {
     WriteWarning("CEnKFEnsemble::Initialize: It is not recommended to use EnKF data assimilation simultaneously with direct insertion streamflow assimilation (enabled with the :AssimilateStreamflow command in the .rvi file). The two assimilation strategies may interfere with each other, particularly when the assimilated observations are shared by both.",Options.noisy);
   }
@@ -251,6 +337,11 @@ void CEnKFEnsemble::Initialize(const CModel* pModel,const optStruct &Options)
   // get names of state variables
   //-----------------------------------------------
   _state_names=new string [ _nStateVars];
+  if(_loc_radius!=DOESNT_EXIST) {
+    _aStateSB=new int [_nStateVars];
+    ExitGracefullyIf(_aStateSB==NULL,"CEnKFEnsemble::Initialize(2)",OUT_OF_MEMORY);
+  }
+  int jj=0;
   for(int i=0;i<_nAssimStates;i++)
   {
     kk=_aAssimGroupID[i];
@@ -268,6 +359,9 @@ void CEnKFEnsemble::Initialize(const CModel* pModel,const optStruct &Options)
           _state_names[ii]="resflow_"    +to_string(pp); ii++;
           _state_names[ii]="resflowlast_"+to_string(pp); ii++;
         }
+        if(_aStateSB!=NULL) {
+          for(;jj<ii;jj++) { _aStateSB[jj]=pModel->GetSubBasinIndex(pBasin->GetID()); }
+        }
       }
     }
     else if(_aAssimStates[i]==RESERVOIR_STAGE) {
@@ -279,6 +373,9 @@ void CEnKFEnsemble::Initialize(const CModel* pModel,const optStruct &Options)
           _state_names[ii]="resstage_"    +to_string(pp); ii++;
           _state_names[ii]="resstagelast_"+to_string(pp); ii++;
         }
+        if(_aStateSB!=NULL) {
+          for(;jj<ii;jj++) { _aStateSB[jj]=pModel->GetSubBasinIndex(pBasin->GetID()); }
+        }
       }
     }
     else { //HRU state variable
@@ -287,6 +384,9 @@ void CEnKFEnsemble::Initialize(const CModel* pModel,const optStruct &Options)
         long long int k=pModel->GetHRUGroup(kk)->GetHRU(n)->GetHRUID();
         string svname = pModel->GetStateVarInfo()->SVTypeToString(_aAssimStates[i], _aAssimLayers[i]);
         _state_names[ii]=svname+"_" +to_string(k); ii++;
+        if(_aStateSB!=NULL) {
+          _aStateSB[jj]=pModel->GetHRUGroup(kk)->GetHRU(n)->GetSubBasinIndex(); jj++;
+        }
       }
     }
   }
@@ -294,22 +394,38 @@ void CEnKFEnsemble::Initialize(const CModel* pModel,const optStruct &Options)
 
   //create empty _state_matrix
   //-----------------------------------------------
-  _state_matrix=new double* [_nEnKFMembers];
-  ExitGracefullyIf(_state_matrix==NULL,"CEnKFEnsemble::Initialize",OUT_OF_MEMORY);
-  for(int e = 0; e < _nEnKFMembers; e++)
+  AllocateContiguousMatrix(_nEnKFMembers,_nStateVars,_state_matrix); // gets populated later upon selecting states
+  cout<<"ENKF: Found "<<_nStateVars<<" state variables for assimilation. State matrix built."<<endl<<endl;
+
+  //create storage for end-of-run model states, updated after assimilation
+  //-----------------------------------------------
+  int snapsize=pModel->GetStateSnapshotSize();
+  if ((_EnKF_mode==ENKF_SPINUP) || (_EnKF_mode==ENKF_CLOSED_LOOP) || (_EnKF_mode==ENKF_CLOSED_FORECAST))
   {
-    _state_matrix[e]=NULL;
-    _state_matrix[e]=new double [_nStateVars]; // gets populated later upon selecting states
-    ExitGracefullyIf(_state_matrix[e]==NULL,"CEnKFEnsemble::Initialize(2)",OUT_OF_MEMORY);
-    for(int i=0;i<_nStateVars;i++) {
-      _state_matrix[e][i]=0.0;
+    _aFinalStates=new double* [_nEnKFMembers];
+    ExitGracefullyIf(_aFinalStates==NULL,"CEnKFEnsemble::Initialize(3)",OUT_OF_MEMORY);
+    for(int e = 0; e < _nEnKFMembers; e++)
+    {
+      _aFinalStates[e]=new double [snapsize];
+      ExitGracefullyIf(_aFinalStates[e]==NULL,"CEnKFEnsemble::Initialize(4)",OUT_OF_MEMORY);
     }
   }
-  cout<<"ENKF: Found "<<_nStateVars<<" state variables for assimilation. State matrix built."<<endl<<endl;
+  if (_EnKF_mode==ENKF_SPINUP) //all members start from the same initial conditions
+  {
+    _aInitState=new double [snapsize];
+    ExitGracefullyIf(_aInitState==NULL,"CEnKFEnsemble::Initialize(5)",OUT_OF_MEMORY);
+  }
+
+  _nThreads=max(Options.num_threads,1);
+
+  //determine hindcast period (t=0 to t0)
+  //-----------------------------------------------
+  _full_duration=Options.duration;
+  _t_assim   =ceil((_full_duration-_forecast_horizon)/Options.timestep-TIME_CORRECTION)*Options.timestep; //first time step on or after (duration - horizon)
+  _nTimeSteps=(int)(rvn_floor((_t_assim+TIME_CORRECTION)/Options.timestep));
 
   //determine total number of observations
   //-----------------------------------------------
-  _nTimeSteps=(int)(rvn_floor((Options.duration+TIME_CORRECTION)/Options.timestep));
   _window_size=min(_window_size,_nTimeSteps);
 
   bool good;
@@ -347,21 +463,21 @@ void CEnKFEnsemble::Initialize(const CModel* pModel,const optStruct &Options)
 
   //allocate _output_matrix and _noise_matrix
   //-----------------------------------------------
-  _obs_matrix   =new double *[_nEnKFMembers];
-  _output_matrix=new double *[_nEnKFMembers];
-  _noise_matrix =new double *[_nEnKFMembers];
-  for(int e=0;e<_nEnKFMembers;e++) {
-    _noise_matrix [e]=NULL;
-    _obs_matrix   [e]=new double [_nObsDatapoints];
-    _output_matrix[e]=new double [_nObsDatapoints];
-    _noise_matrix [e]=new double [_nObsDatapoints];
-    ExitGracefullyIf(_noise_matrix[e]==NULL,"EnKF Initialization: noise matrix",OUT_OF_MEMORY);
+  AllocateContiguousMatrix(_nEnKFMembers,_nObsDatapoints,_obs_matrix);
+  AllocateContiguousMatrix(_nEnKFMembers,_nObsDatapoints,_output_matrix);
+  AllocateContiguousMatrix(_nEnKFMembers,_nObsDatapoints,_noise_matrix);
+  if(_loc_radius!=DOESNT_EXIST) {
+    _aObsSB=new int [max(_nObsDatapoints,1)];
+    ExitGracefullyIf(_aObsSB==NULL,"CEnKFEnsemble::Initialize(6)",OUT_OF_MEMORY);
   }
 
   //populate _output_matrix, _obs_matrix
   //-----------------------------------------------
   int j;
   double eps;
+  rand_key key;
+  key.seed  =_rand_seed;
+  key.stream=RAND_OBS_PERTURB;
   for(int e=0;e<_nEnKFMembers;e++)
   {
     j=0;
@@ -386,11 +502,13 @@ void CEnKFEnsemble::Initialize(const CModel* pModel,const optStruct &Options)
         if(obsval!=RAV_BLANK_DATA) {
           _noise_matrix[e][j]=0;
           if (pPerturb!=NULL){
-            eps=SampleFromDistribution(pPerturb->distribution,pPerturb->distpar);
+            key.member=e; key.index=ii; key.step=nn;
+            SampleFromDistribution(pPerturb->distribution,pPerturb->distpar,key,&eps,1);
             if      (pPerturb->adj_type == ADJ_ADDITIVE      ){ _noise_matrix[e][j]=eps;}
             else if (pPerturb->adj_type == ADJ_MULTIPLICATIVE){ _noise_matrix[e][j]=(eps*obsval)-obsval; }
           }
           _obs_matrix[e][j]=obsval+_noise_matrix[e][j];
+          if(_aObsSB!=NULL) { _aObsSB[j]=pModel->GetSubBasinIndex(pTSObs->GetLocID()); }
           j++;
         }
       }
@@ -401,6 +519,12 @@ void CEnKFEnsemble::Initialize(const CModel* pModel,const optStruct &Options)
     }
   }
 
+  //group states and observations into independent local analysis domains
+  //-----------------------------------------------
+  if(_loc_radius!=DOESNT_EXIST) {
+    BuildLocalDomains(pModel);
+  }
+
   // Create and open EnKFOutput file
   //-----------------------------------------------
   string filename= FilenamePrepare("EnKFOutput.csv",Options);
@@ -421,7 +545,7 @@ void CEnKFEnsemble::StartTimeStepOps(CModel* pModel,optStruct& Options,const tim
 {
   //Apply forcing perturbations for the current time step
   //----------------------------------------------------------
-  if ((_EnKF_mode!=ENKF_FORECAST) && (_EnKF_mode!=ENKF_OPEN_FORECAST))
+  if ((_EnKF_mode!=ENKF_FORECAST) && (_EnKF_mode!=ENKF_OPEN_FORECAST) && (!IsForecastMember(e)))
   {
     pModel->PrepareForcingPerturbation(Options, tt);
   }
@@ -435,7 +559,9 @@ void CEnKFEnsemble::StartTimeStepOps(CModel* pModel,optStruct& Options,const tim
 //
 void CEnKFEnsemble::CloseTimeStepOps(CModel* pModel,optStruct& Options,const time_struct& tt,const int e)
 {
-  if (fabs(tt.model_time-Options.duration)<0.25*Options.timestep) { //t=t_end
+  if (IsForecastMember(e)){return;} //no assimilation after t0
+
+  if (fabs(tt.model_time-_t_assim)<0.25*Options.timestep) { //t=t_end
     AddToStateMatrix(pModel,Options,e);
   }
 
@@ -466,12 +592,13 @@ void CEnKFEnsemble::CloseTimeStepOps(CModel* pModel,optStruct& Options,const tim
 //////////////////////////////////////////////////////////////////
 /// \brief the EnKF assimilation matrix calculations for updating states
 /// Based upon Mandel, J., Efficient Implementation of the Ensemble Kalman Filter, Report, Univ of Colorado, 2006.
+/// \details ensemble matrices are stored one row per member (i.e., transposed relative to Mandel);
+/// workspace is allocated on first call and reused in subsequent assimilations
 //
 void CEnKFEnsemble::AssimilationCalcs()
 {
   if (_nObsDatapoints==0){return; } //skips assimilation if no observations available
 
-  //return;
   int i,j,k;
 
   //some shorthand to clean up local variable names
@@ -479,111 +606,260 @@ void CEnKFEnsemble::AssimilationCalcs()
   int M       =_nStateVars;     //# of assimilated state vars
   int Nobs    =_nObsDatapoints; //# of observed state variables
 
-  double** X  =_state_matrix;   //state matrix is [NxM]
-  double** eQT=_noise_matrix; //outerr matrix is [NxNobs]
-
-  double** HA;   //output matrix difference from ensemble mean [NobsxN]
-  double** HAT;  //HA transpose [NxNobs]
-  double** A;    //prediction ensemble variation matrix [MxN]
-  double** P;    //inverted matrix term
-  double** eQ;
-  double** tmp;
-  double** MM;
-  double** Z;
-  double** X_deltaT;
-  double** X_delta;
-  double* ans =new double[Nobs];
-  double* diff=new double[Nobs];
-
-  AllocateMatrix(M,N,A);
-  AllocateMatrix(Nobs,N,HA);
-  AllocateMatrix(N,Nobs,HAT);
-  AllocateMatrix(Nobs,Nobs,P);
-  AllocateMatrix(Nobs,N,eQ);
-  AllocateMatrix(Nobs,Nobs,tmp);
-  AllocateMatrix(Nobs,N,MM);
-  AllocateMatrix(N,N,Z);
-  AllocateMatrix(M,N,X_deltaT);
-  AllocateMatrix(N,M,X_delta);
-
-  /*cout << "_output_matrix[][]:" << endl;
-  for(int i=0;i<N;i++) {
-    for(int j=0;j<Nobs;j++) {cout<<_output_matrix[i][j]<<"| ";}cout<<endl;
-  }
-  cout<<"_obs_matrix[][]:"<<endl;
-  for(int i=0;i<N;i++) {
-    for(int j=0;j<Nobs;j++) {cout<<_obs_matrix[i][j]<<"| ";}cout<<endl;
-  } */
-
-
-  //HA=O_sim-1/N*(O_sim*e_N1)*e_1N
-  double outMean=0;
-  for(j = 0; j < Nobs; j++) {
-    outMean=0;
-    for(i = 0; i < N; i++) {outMean+=_output_matrix[i][j]/N;}
-    for(i = 0; i < N; i++) {
-      HA[j][i]=_output_matrix[i][j]-outMean; // Nobs x N
-    }
-  }
-
-  //A =X -1/N*(X *e_N1)*e_1N
-  double Xmean=0;
-  for(k = 0; k < M; k++) {
-    Xmean=0;
-    for(i = 0; i < N; i++) {Xmean+=X[i][k]/N;}
-    for(i = 0; i < N; i++) {
-      A[k][i]=X[i][k]-Xmean; // M x N
-    }
-  }
-  //cout<<"  -calculated HA, A matrices"<<endl;
+  if (_HA==NULL)
+  {
+    AllocateContiguousMatrix(N,Nobs,_HA);    //output matrix difference from ensemble mean, HA' [NxNobs]
+    AllocateContiguousMatrix(N,M,_A);        //prediction ensemble variation matrix, A' [NxM]
+    if(_loc_radius==DOESNT_EXIST) {          //local analyses use their own (smaller) workspace
+      AllocateContiguousMatrix(Nobs,Nobs,_P);//innovation covariance matrix [NobsxNobs]
+      AllocateContiguousMatrix(N,Nobs,_Y);   //innovations [NxNobs]
+      AllocateContiguousMatrix(N,N,_Z);
+    }
+    _work=new double [max(max(M,Nobs),1)];
+    ExitGracefullyIf(_work==NULL,"CEnKFEnsemble::AssimilationCalcs",OUT_OF_MEMORY);
+  }
+
+  //HA'=O_sim-1/N*e_N1*(e_1N*O_sim)
+  for(j = 0; j < Nobs; j++) {_work[j]=0.0;}
+  for(i = 0; i < N; i++) {
+    for(j = 0; j < Nobs; j++) {_work[j]+=_output_matrix[i][j]/N;}
+  }
+  for(i = 0; i < N; i++) {
+    for(j = 0; j < Nobs; j++) {_HA[i][j]=_output_matrix[i][j]-_work[j];}
+  }
+
+  //A'=X-1/N*e_N1*(e_1N*X)
+  for(k = 0; k < M; k++) {_work[k]=0.0;}
+  for(i = 0; i < N; i++) {
+    for(k = 0; k < M; k++) {_work[k]+=_state_matrix[i][k]/N;}
+  }
+  for(i = 0; i < N; i++) {
+    for(k = 0; k < M; k++) {_A[i][k]=_state_matrix[i][k]-_work[k];}
+  }
+
+  if(_loc_radius!=DOESNT_EXIST) {
+    LocalAssimilationCalcs();
+    return;
+  }
 
   //P=1/(N-1)*HA*(HA)'+1/(N-1)*(eQ*eQ');
   // 1st term is covariance matrix of simulated output states
   // 2nd term is the covariance matrix (R) of ths measurement error
-  TransposeMat(HA,Nobs,N,HAT);
-  MatMult(HA,HAT,Nobs,N,Nobs,P);        //P is Nobs x Nobs
-  TransposeMat(eQT,N,Nobs,eQ);          //eQ is Nobs x N
-  MatMult(eQ,eQT,Nobs,N,Nobs,tmp);      //tmp is Nobs x Nobs
-  MatAdd(P,tmp,Nobs,Nobs,P);            //P is Nobs x Nobs
-  ScalarMatMult(P,1.0/(N-1),Nobs,Nobs,P);
-
-  //Z=HA'*(inv(P)*(O_obs-O_sim));
-  double svd_tol=1e-8;
-  for(i=0; i<N; i++)
+  SYRK(_HA,          true,Nobs,N,1.0/(N-1),0.0,_P);
+  SYRK(_noise_matrix,true,Nobs,N,1.0/(N-1),1.0,_P);
+
+  //Y'=(inv(P)*(O_obs-O_sim))'
+  for(i=0; i<N; i++) {
+    for(j=0;j<Nobs;j++) { _Y[i][j]=_obs_matrix[i][j]-_output_matrix[i][j]; }
+  }
+  if (CholeskyFactor(_P,Nobs)) {
+    CholeskySolve(_P,Nobs,_Y,N);
+  }
+  else { //P singular (e.g., unperturbed observations, few members) - use SVD pseudo-inverse
+    double svd_tol=1e-8;
+    SYRK(_HA,          true,Nobs,N,1.0/(N-1),0.0,_P);
+    SYRK(_noise_matrix,true,Nobs,N,1.0/(N-1),1.0,_P);
+    for(i=0; i<N; i++) {
+      SVD(_P,_Y[i],_work,Nobs,svd_tol);
+      for(j=0;j<Nobs;j++) { _Y[i][j]=_work[j]; }
+    }
+  }
+
+  //Z=HA'*(inv(P)*(O_obs-O_sim)) [NxN]
+  GEMM(_HA,false,_Y,true,N,Nobs,N,1.0,0.0,_Z);
+
+  //update state matrix Xa=X+X_delta, X_delta = 1/(N-1)*A*Z
+  GEMM(_Z,true,_A,false,N,N,M,1.0/(N-1),1.0,_state_matrix);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief groups assimilated states by subbasin and identifies the observations within the localization radius of each group
+/// \details network distance is the number of subbasin links between state and observation subbasins, traversed
+/// in either direction (or only downstream from the state subbasin if _loc_upstream_only is true).
+/// Subbasins with no observations within the radius are not updated.
+/// \param pModel [in] pointer to model
+//
+void CEnKFEnsemble::BuildLocalDomains(const CModel *pModel)
+{
+  int p,q,d,j,k;
+  int nSB=pModel->GetNumSubBasins();
+
+  //count states and observations per subbasin
+  int *nStatesInSB=new int [nSB];
+  int *nObsInSB   =new int [nSB];
+  for(p=0;p<nSB;p++) { nStatesInSB[p]=0; nObsInSB[p]=0; }
+  for(k=0;k<_nStateVars;    k++) { if(_aStateSB[k]>=0) { nStatesInSB[_aStateSB[k]]++; } }
+  for(j=0;j<_nObsDatapoints;j++) { if(_aObsSB  [j]>=0) { nObsInSB   [_aObsSB  [j]]++; } }
+
+  //build upstream adjacency (compressed row storage)
+  int *upStart=new int [nSB+1];
+  int *upList =new int [max(nSB,1)];
+  int *upCount=new int [nSB];
+  for(p=0;p<=nSB;p++) { upStart[p]=0; }
+  for(p=0;p<nSB;p++) {
+    q=pModel->GetDownstreamBasin(p);
+    if(q>=0) { upStart[q+1]++; }
+  }
+  for(p=0;p<nSB;p++) { upStart[p+1]+=upStart[p]; upCount[p]=0; }
+  for(p=0;p<nSB;p++) {
+    q=pModel->GetDownstreamBasin(p);
+    if(q>=0) { upList[upStart[q]+upCount[q]]=p; upCount[q]++; }
+  }
+
+  //breadth-first search from each subbasin with states, out to localization radius
+  int  *dist   =new int [nSB];
+  int  *queue  =new int [nSB];
+  bool *isNear =new bool[nSB];
+  int   nReached,head;
+  for(p=0;p<nSB;p++) { dist[p]=DOESNT_EXIST; isNear[p]=false; }
+
+  _nLocalDomains=0;
+  _aLocStates   =new int *[nSB];
+  _aLocNumStates=new int  [nSB];
+  _aLocObs      =new int *[nSB];
+  _aLocNumObs   =new int  [nSB];
+  ExitGracefullyIf(_aLocNumObs==NULL,"CEnKFEnsemble::BuildLocalDomains",OUT_OF_MEMORY);
+
+  for(p=0;p<nSB;p++)
+  {
+    if(nStatesInSB[p]==0) { continue; }
+
+    nReached=0; head=0;
+    queue[nReached++]=p; dist[p]=0;
+    while(head<nReached)
+    {
+      q=queue[head++];
+      isNear[q]=true;
+      if(dist[q]==_loc_radius) { continue; }
+      int qdown=pModel->GetDownstreamBasin(q);
+      if((qdown>=0) && (dist[qdown]==DOESNT_EXIST)) {
+        dist[qdown]=dist[q]+1; queue[nReached++]=qdown;
+      }
+      if(!_loc_upstream_only) {
+        for(int u=upStart[q];u<upStart[q+1];u++) {
+          if(dist[upList[u]]==DOESNT_EXIST) { dist[upList[u]]=dist[q]+1; queue[nReached++]=upList[u]; }
+        }
+      }
+    }
+
+    int nLocObs=0;
+    for(int n=0;n<nReached;n++) { nLocObs+=nObsInSB[queue[n]]; }
+
+    if(nLocObs>0)
+    {
+      d=_nLocalDomains;
+      _aLocNumStates[d]=nStatesInSB[p];
+      _aLocNumObs   [d]=nLocObs;
+      _aLocStates   [d]=new int [nStatesInSB[p]];
+      _aLocObs      [d]=new int [nLocObs];
+      ExitGracefullyIf(_aLocObs[d]==NULL,"CEnKFEnsemble::BuildLocalDomains(2)",OUT_OF_MEMORY);
+      int n=0;
+      for(k=0;k<_nStateVars;k++) {
+        if(_aStateSB[k]==p) { _aLocStates[d][n]=k; n++; }
+      }
+      n=0;
+      for(j=0;j<_nObsDatapoints;j++) { //preserves global ordering of observations
+        if((_aObsSB[j]>=0) && (isNear[_aObsSB[j]])) { _aLocObs[d][n]=j; n++; }
+      }
+      _nLocalDomains++;
+    }
+
+    for(int n=0;n<nReached;n++) { dist[queue[n]]=DOESNT_EXIST; isNear[queue[n]]=false; }
+  }
+
+  cout<<"ENKF: Observation localization radius of "<<_loc_radius<<" subbasin links";
+  if(_loc_upstream_only) { cout<<" (upstream only)"; }
+  cout<<": "<<_nLocalDomains<<" local analysis domains built."<<endl;
+
+  delete [] nStatesInSB;
+  delete [] nObsInSB;
+  delete [] upStart;
+  delete [] upList;
+  delete [] upCount;
+  delete [] dist;
+  delete [] queue;
+  delete [] isNear;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief localized EnKF update - each local domain is updated only from its nearby observations
+/// \details called from AssimilationCalcs once the anomaly matrices _HA and _A are built.
+/// Domains have disjoint state variables and only read pre-update anomalies, so the local analyses
+/// are independent and are run in parallel
+//
+void CEnKFEnsemble::LocalAssimilationCalcs()
+{
+  int N=_nEnKFMembers;
+  int maxObs=1,maxStates=1;
+  for(int d=0;d<_nLocalDomains;d++) {
+    maxObs   =max(maxObs,   _aLocNumObs   [d]);
+    maxStates=max(maxStates,_aLocNumStates[d]);
+  }
+
+  #pragma omp parallel num_threads(_nThreads) if(_nThreads>1)
   {
-    for(j=0;j<Nobs;j++) { diff[j]=_obs_matrix[i][j]-_output_matrix[i][j]; }
-    SVD(P,diff,ans,Nobs,svd_tol);
-    for(j=0;j<Nobs;j++) { MM[j][i]=ans[j]; } //MM is Nobs x N
-  }
-  MatMult(HAT,MM,N,Nobs,N,Z);           //Z is N x N
-
-  //X_delta = 1/(N-1)*A*Z;
-  MatMult(A,Z,M,N,N,X_deltaT);          //X_deltaT is M x N
-  ScalarMatMult(X_deltaT,1.0/(N-1),M,N,X_deltaT);
-  TransposeMat (X_deltaT,M,N,X_delta);  //X_delta is N x M
-
-  //update state matrix Xa=X+X_delta
-  MatAdd(_state_matrix,X_delta,N,M,_state_matrix);
-
-  /*cout << "X_delta[][]" << endl;
-  for(int i=0;i<N;i++) {
-    for(int j=0;j<M;j++) {cout<<X_delta[i][j]<<"| ";}cout<<endl;
-  }*/
-
-  //clean up
-  delete[] ans;
-  delete[] diff;
-  DeleteMatrix(M,N,A);
-  DeleteMatrix(Nobs,N,HA);
-  DeleteMatrix(N,Nobs,HAT);
-  DeleteMatrix(Nobs,Nobs,P);
-  DeleteMatrix(Nobs,N,eQ);
-  DeleteMatrix(Nobs,Nobs,tmp);
-  DeleteMatrix(Nobs,N,MM);
-  DeleteMatrix(N,N,Z);
-  DeleteMatrix(M,N,X_deltaT);
-  DeleteMatrix(N,M,X_delta);
+    int i,j,k,nO,nS;
+    const int *obs,*states;
+    double **HA=NULL,**R=NULL,**Y=NULL,**P=NULL,**Z=NULL,**A=NULL,**dX=NULL; //per-thread workspace
+    AllocateContiguousMatrix(N,maxObs,HA);
+    AllocateContiguousMatrix(N,maxObs,R);
+    AllocateContiguousMatrix(N,maxObs,Y);
+    AllocateContiguousMatrix(maxObs,maxObs,P);
+    AllocateContiguousMatrix(N,N,Z);
+    AllocateContiguousMatrix(N,maxStates,A);
+    AllocateContiguousMatrix(N,maxStates,dX);
+    double *work=new double [maxObs];
+
+    #pragma omp for schedule(dynamic,1)
+    for(int d=0;d<_nLocalDomains;d++)
+    {
+      nO    =_aLocNumObs   [d]; obs   =_aLocObs   [d];
+      nS    =_aLocNumStates[d]; states=_aLocStates[d];
+
+      for(i=0;i<N;i++) {
+        for(j=0;j<nO;j++) {
+          HA[i][j]=_HA[i][obs[j]];
+          R [i][j]=_noise_matrix[i][obs[j]];
+          Y [i][j]=_obs_matrix[i][obs[j]]-_output_matrix[i][obs[j]];
+        }
+      }
 
+      //local P=1/(N-1)*HA*(HA)'+1/(N-1)*(eQ*eQ'); Y'=(inv(P)*(O_obs-O_sim))'
+      SYRK(HA,true,nO,N,1.0/(N-1),0.0,P);
+      SYRK(R, true,nO,N,1.0/(N-1),1.0,P);
+      if(CholeskyFactor(P,nO)) {
+        CholeskySolve(P,nO,Y,N);
+      }
+      else {
+        double svd_tol=1e-8;
+        SYRK(HA,true,nO,N,1.0/(N-1),0.0,P);
+        SYRK(R, true,nO,N,1.0/(N-1),1.0,P);
+        for(i=0;i<N;i++) {
+          SVD(P,Y[i],work,nO,svd_tol);
+          for(j=0;j<nO;j++) { Y[i][j]=work[j]; }
+        }
+      }
+      GEMM(HA,false,Y,true,N,nO,N,1.0,0.0,Z);
+
+      //X_delta = 1/(N-1)*A*Z, restricted to domain states
+      for(i=0;i<N;i++) {
+        for(k=0;k<nS;k++) { A[i][k]=_A[i][states[k]]; }
+      }
+      GEMM(Z,true,A,false,N,N,nS,1.0/(N-1),0.0,dX);
+      for(i=0;i<N;i++) {
+        for(k=0;k<nS;k++) { _state_matrix[i][states[k]]+=dX[i][k]; }
+      }
+    }
+
+    DeleteContiguousMatrix(HA);
+    DeleteContiguousMatrix(R);
+    DeleteContiguousMatrix(Y);
+    DeleteContiguousMatrix(P);
+    DeleteContiguousMatrix(Z);
+    DeleteContiguousMatrix(A);
+    DeleteContiguousMatrix(dX);
+    delete [] work;
+  }
 }
 
 //////////////////////////////////////////////////////////////////
@@ -744,42 +1020,72 @@ void CEnKFEnsemble::AddToStateMatrix(CModel* pModel,optStruct& Options,const int
 //
 void CEnKFEnsemble::UpdateModel(CModel *pModel,optStruct &Options,const int e)
 {
-  CEnsemble::UpdateModel(pModel,Options,e);
   string solfile;
 
-  ExitGracefullyIf(e>=_nMembers,"CEnKFEnsemble::UpdateMode: invalid ensemble member index",RUNTIME_ERR);
+  ExitGracefullyIf(e>=GetNumMembers(),"CEnKFEnsemble::UpdateMode: invalid ensemble member index",RUNTIME_ERR);
+
+  int ee=e; //EnKF member index
+  if (IsForecastMember(e)){ee=e-_nEnKFMembers;}
+
+  CEnsemble::UpdateModel(pModel,Options,ee);
 
   //- update output file/ run names ----------------------------
-  Options.output_dir=_aOutputDirs[e];
-  Options.run_name  =_aRunNames  [e]; //typically fixed for EnKF
+  Options.output_dir=_aOutputDirs[ee];
+  Options.run_name  =_aRunNames  [ee]; //typically fixed for EnKF
+
+  if (_EnKF_mode==ENKF_CLOSED_FORECAST)
+  {
+    if (IsForecastMember(e)) {
+      if (Options.run_name==""){Options.run_name="forecast";}
+      else                     {Options.run_name=Options.run_name+"_forecast";}
+      Options.duration=_full_duration;
+    }
+    else {
+      Options.duration=_t_assim; //hindcast ends at time of assimilation
+    }
+  }
 
+  //if forecast following assimilation in same run, applies updated states directly to final hindcast state
   //if closed-loop, re-read initial conditions from state-adjusted solution_EnKF.rvc
   //if open-loop, read initial conditions from unadjusted solution.rvc files
-  // otherwise uses the single base model .rvc file for all members
+  // otherwise uses the single base model .rvc file for all members (read only once)
 
-  if((_EnKF_mode == ENKF_CLOSED_LOOP) || (_EnKF_mode == ENKF_FORECAST)) {
+  if (IsForecastMember(e)) {
+    pModel->RestoreStateSnapshot(_aFinalStates[ee]);
+    UpdateFromStateMatrix(pModel,Options,ee);
+    pModel->ClearCumulativeStorage();
+    pModel->ClearForcingPerturbation(Options); //forecast forcings are not perturbed
+  }
+  else if((_EnKF_mode == ENKF_CLOSED_LOOP) || (_EnKF_mode == ENKF_FORECAST) || (_EnKF_mode == ENKF_CLOSED_FORECAST)) {
     if(_warm_runname=="") { solfile="solution_EnKF.rvc"; }
     else                  { solfile=_warm_runname+"_"+"solution_EnKF.rvc"; }
     Options.rvc_filename=_aOutputDirs[e]+solfile;
     if (_aSolutionFiles[e] != ""){Options.rvc_filename=_aSolutionFiles[e]; } //Allows storage elsewhere -requires user to know whether these are EnKF or not
+    ParseInitialConditions(pModel,Options);
   }
   else if ((_EnKF_mode==ENKF_OPEN_LOOP) || (_EnKF_mode == ENKF_OPEN_FORECAST)) {
     if(_warm_runname=="") { solfile="solution.rvc"; }
     else                  { solfile=_warm_runname+"_"+"solution.rvc"; }
     Options.rvc_filename=_aOutputDirs[e]+solfile;
     if (_aSolutionFiles[e] != ""){Options.rvc_filename=_aSolutionFiles[e]; } //Allows storage elsewhere -requires user to know whether these are EnKF or not
+    ParseInitialConditions(pModel,Options);
   }
   else {//if(_EnKF_mode==ENKF_SPINUP)
-    Options.rvc_filename=_orig_rvc_file;
+    if (e==0) {
+      Options.rvc_filename=_orig_rvc_file;
+      ParseInitialConditions(pModel,Options);
+      pModel->SaveStateSnapshot(_aInitState);
+    }
+    else {
+      pModel->RestoreStateSnapshot(_aInitState);
+    }
   }
-
-  ParseInitialConditions(pModel,Options);
   pModel->CalculateInitialWaterStorage(Options);
 
   // read ensemble-member specific time series (e.g., upstream flows in model cascade), if present
   if (_extra_rvt != "") {
     string rvt_name=_extra_rvt;
-    SubstringReplace(rvt_name,"*",to_string(e+1));//replaces wildcard
+    SubstringReplace(rvt_name,"*",to_string(ee+1));//replaces wildcard
     Options.rvt_filename=rvt_name;
     ParseTimeSeriesFile(pModel,Options);
   }
@@ -798,9 +1104,11 @@ void CEnKFEnsemble::FinishEnsembleRun(CModel *pModel,optStruct &Options,const ti
   if ((_EnKF_mode==ENKF_OPEN_LOOP) || (_EnKF_mode==ENKF_FORECAST) || (_EnKF_mode==ENKF_OPEN_FORECAST)){
     return; //EnKF output file not populated, solution_EnKF.rvc file not generated
   }
+  if (IsForecastMember(e)){return;} //assimilation already complete
 
-  //grabs states and stores them in state matrix
+  //grabs states and stores them in state matrix, retains all other states in memory
   AddToStateMatrix(pModel,Options,e);
+  pModel->SaveStateSnapshot(_aFinalStates[e]);
 
   if(e==_nEnKFMembers-1) //After all ensemble members have run
   {
@@ -862,19 +1170,14 @@ void CEnKFEnsemble::FinishEnsembleRun(CModel *pModel,optStruct &Options,const ti
     _ENKFOUT.close();
 
     //Write EnKF-updated solution files
-    // requires full re-reading of ensemble member solution files
-    string solfile;
+    // restores final state of each ensemble member from memory
     cout<<"ENKF: Writing  Solution Files..."<<endl;
     for(int ee=0;ee<_nEnKFMembers;ee++)
     {
       Options.output_dir=_aOutputDirs[ee];
       Options.run_name  =_aRunNames  [ee];
 
-      if(Options.run_name=="") { solfile="solution.rvc"; }
-      else                     { solfile=Options.run_name+"_"+"solution.rvc"; }
-      Options.rvc_filename=_aOutputDirs[ee]+solfile;
-
-      ParseInitialConditions(pModel,Options);
+      pModel->RestoreStateSnapshot(_aFinalStates[ee]);
 
       //Update state vector in model
       UpdateFromStateMatrix(pModel,Options,ee);
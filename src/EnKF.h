@@ -22,6 +22,7 @@ enum EnKF_mode
   ENKF_OPEN_LOOP,
   ENKF_FORECAST,
   ENKF_OPEN_FORECAST,
+  ENKF_CLOSED_FORECAST, ///< closed-loop hindcast, assimilation, and forecast in a single run
   ENKF_UNSPECIFIED
 };
 ////////////////////////////////////////////////////////////////////
@@ -43,6 +44,13 @@ private:
   double       **_noise_matrix;     ///< matrix of observational noise [size: _nEnKFMembers x _nObsDatapoints]
   int            _nObsDatapoints;   ///< number of valid datapoints available for assimilation
 
+  double       **_HA;               ///< workspace: simulated output anomalies [size: _nEnKFMembers x _nObsDatapoints] (NULL until first assimilation)
+  double       **_A;                ///< workspace: state anomalies [size: _nEnKFMembers x _nStateVars]
+  double       **_P;                ///< workspace: innovation covariance matrix, then its Cholesky factor [size: _nObsDatapoints x _nObsDatapoints]
+  double       **_Y;                ///< workspace: innovations, then inv(P)*innovations [size: _nEnKFMembers x _nObsDatapoints]
+  double       **_Z;                ///< workspace: [size: _nEnKFMembers x _nEnKFMembers]
+  double        *_work;             ///< workspace vector [size: max(_nStateVars,_nObsDatapoints)]
+
   obs_perturb  **_pObsPerturbations;///< array of pointers to observation perturbation data [size _nObsPerturbations]
   int            _nObsPerturbations;///< number of observational perturbations. If observation does not have perturbation, it is assumed "perfect" data
 
@@ -54,6 +62,10 @@ private:
   int            _window_size;      //< number of data points back in time to be used in assimilation (=1 for classic EnKF, more for variational methods)
   int            _nTimeSteps;       //< number of timesteps in hindcast period (prior to t0)
 
+  double         _forecast_horizon; //< duration of forecast following assimilation [d] (ENKF_CLOSED_FORECAST only)
+  double         _t_assim;          //< local model time of assimilation, t0 [d]
+  double         _full_duration;    //< simulation duration of hindcast and forecast, from .rvi file [d]
+
   string         _warm_runname;     //< run name of closed loop or open loop solution files (e.g., run1_solution.rvc)
 
   string         _extra_rvt;        //< name of extra-data .rvt file for ensemble member-specific time series
@@ -62,15 +74,33 @@ private:
   int           *_aObsIndices;      //< indices of CModel::pObsTS array corresponding to assimilation time series [size:_nObs]
   int            _nObs;             //< number of time series to be assimilated
 
+  int            _loc_radius;       //< observation localization radius, in # of subbasin links (DOESNT_EXIST for global update)
+  bool           _loc_upstream_only;//< true if states are only updated from observations at or downstream of their subbasin
+  int           *_aStateSB;         //< subbasin index p of each assimilated state variable [size: _nStateVars] (NULL if no localization)
+  int           *_aObsSB;           //< subbasin index p of each observation datapoint [size: _nObsDatapoints] (NULL if no localization)
+  int            _nLocalDomains;    //< number of independent local analysis domains (one per subbasin with states and local observations)
+  int          **_aLocStates;       //< indices of state variables updated in each local domain [size: _nLocalDomains x _aLocNumStates[d]]
+  int           *_aLocNumStates;    //< number of state variables in each local domain [size: _nLocalDomains]
+  int          **_aLocObs;          //< indices of observation datapoints used in each local domain [size: _nLocalDomains x _aLocNumObs[d]]
+  int           *_aLocNumObs;       //< number of observation datapoints in each local domain [size: _nLocalDomains]
+  int            _nThreads;         //< number of threads used for local analyses (from Options.num_threads)
+
+  double       **_aFinalStates;     ///< in-memory snapshot of model state at end of each member run [size: _nEnKFMembers x pModel::GetStateSnapshotSize()] (NULL if not needed)
+  double        *_aInitState;       ///< in-memory snapshot of initial conditions shared by all members [size: pModel::GetStateSnapshotSize()] (ENKF_SPINUP only)
+
   ofstream      _ENKFOUT;           ///< output file stream
 
   void AssimilationCalcs();         //< determines the final state matrix after assimilation
+  void LocalAssimilationCalcs();    //< localized alternative to global update in AssimilationCalcs
+  void BuildLocalDomains    (const CModel *pModel);
+  bool IsForecastMember     (const int e) const;
   void UpdateFromStateMatrix(CModel *pModel,optStruct& Options,const int e);
   void AddToStateMatrix     (CModel* pModel,optStruct& Options,const int e);
 public:
   CEnKFEnsemble(const int num_members,const optStruct &Options);
   ~CEnKFEnsemble();
 
+  int    GetNumMembers() const;
   double GetStartTime(const int e) const;
   EnKF_mode GetEnKFMode() const;
 
@@ -78,6 +108,8 @@ public:
   void SetWarmRunname        (string runname);
   void SetWindowSize         (const int nTimesteps);
   void SetExtraRVTFile       (string filename);
+  void SetForecastHorizon    (const double horizon);
+  void SetLocalization       (const int radius, const bool upstream_only);
   void AddObsPerturbation    (sv_type      type, disttype distrib, double *distpars, adjustment adj);
   void AddAssimilationState  (sv_type sv, int layer, int assim_groupID);
 
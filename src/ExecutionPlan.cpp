@@ -0,0 +1,116 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2023 the Raven Development Team
+  ----------------------------------------------------------------*/
+#include "ExecutionPlan.h"
+
+//////////////////////////////////////////////////////////////////
+/// \brief Constructor - reserves plan storage; no processes are active until SetApplicability() is called
+///
+/// \param nProcesses [in] number of hydrological processes in model
+/// \param nHRUs [in] number of HRUs in model
+/// \param nBlock [in] number of consecutive HRUs processed together by solver
+/// \param nTotalConnections [in] total number of process connections in model
+//
+CExecutionPlan::CExecutionPlan(const int nProcesses,
+                               const int nHRUs,
+                               const int nBlock,
+                               const int nTotalConnections)
+{
+  ExitGracefullyIf((nBlock<1) || (nBlock>MAX_HRU_BLOCK),"CExecutionPlan::Constructor: invalid block size",RUNTIME_ERR);
+  _nProcesses       =nProcesses;
+  _nHRUs            =nHRUs;
+  _nBlock           =nBlock;
+  _nBlocks          =(_nHRUs+_nBlock-1)/_nBlock;
+  _nTotalConnections=nTotalConnections;
+
+  _aNumConnections =new int [_nProcesses];
+  _aFirstConnection=new int [_nProcesses];
+  _aFrom           =new int [max(_nTotalConnections,1)];
+  _aTo             =new int [max(_nTotalConnections,1)];
+  _aConnType       =new conn_type [max(_nTotalConnections,1)];
+  ExitGracefullyIf(_aConnType==NULL,"CExecutionPlan::Constructor",OUT_OF_MEMORY);
+  for (int j=0;j<_nProcesses;j++){
+    _aNumConnections [j]=0;
+    _aFirstConnection[j]=0;
+  }
+
+  _aNumActive=new int           [_nBlocks];
+  _aActive   =new int          *[_nBlocks];
+  _aMask     =new unsigned int *[_nBlocks];
+  for (int kb=0;kb<_nBlocks;kb++){
+    _aNumActive[kb]=0;
+    _aActive   [kb]=new int          [_nProcesses];
+    _aMask     [kb]=new unsigned int [_nProcesses];
+    ExitGracefullyIf(_aMask[kb]==NULL,"CExecutionPlan::Constructor(2)",OUT_OF_MEMORY);
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Destructor
+//
+CExecutionPlan::~CExecutionPlan()
+{
+  if (DESTRUCTOR_DEBUG){cout<<"  DELETING EXECUTION PLAN"<<endl;}
+  for (int kb=0;kb<_nBlocks;kb++){delete [] _aActive[kb]; delete [] _aMask[kb];}
+  delete [] _aActive;
+  delete [] _aMask;
+  delete [] _aNumActive;
+  delete [] _aNumConnections;
+  delete [] _aFirstConnection;
+  delete [] _aFrom;
+  delete [] _aTo;
+  delete [] _aConnType;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Stores connectivity of process j
+/// \remark must be called for processes in order (j=0,1,2...), as connections are stored in order of global connection index
+///
+/// \param j [in] process index
+/// \param nConnections [in] number of connections of process j
+/// \param *iFrom [in] state variable indices losing mass/energy [size: nConnections]
+/// \param *iTo [in] state variable indices gaining mass/energy [size: nConnections]
+/// \param *ctype [in] connection types [size: nConnections]
+//
+void CExecutionPlan::SetConnections(const int j, const int nConnections, const int *iFrom, const int *iTo, const conn_type *ctype)
+{
+  int qs=0;
+  if (j>0){qs=_aFirstConnection[j-1]+_aNumConnections[j-1];}
+  ExitGracefullyIf(qs+nConnections>_nTotalConnections,"CExecutionPlan::SetConnections: too many connections",RUNTIME_ERR);
+
+  _aNumConnections [j]=nConnections;
+  _aFirstConnection[j]=qs;
+  for (int q=0;q<nConnections;q++){
+    _aFrom    [qs+q]=iFrom[q];
+    _aTo      [qs+q]=iTo  [q];
+    _aConnType[qs+q]=ctype[q];
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Compiles ordered list of processes applied in each HRU block
+///
+/// \param **should_apply [in] flags indicating whether process j applies to HRU k [size: nProcesses x nHRUs]
+//
+void CExecutionPlan::SetApplicability(const bool * const *should_apply)
+{
+  for (int k0=0;k0<_nHRUs;k0+=_nBlock)
+  {
+    int kb=k0/_nBlock;
+    int nb=min(_nBlock,_nHRUs-k0);
+    _aNumActive[kb]=0;
+    for (int j=0;j<_nProcesses;j++)
+    {
+      unsigned int mask=0;
+      for (int b=0;b<nb;b++){
+        if (should_apply[j][k0+b]){mask|=(1u<<b);}
+      }
+      if (mask!=0){
+        _aActive[kb][_aNumActive[kb]]=j;
+        _aMask  [kb][_aNumActive[kb]]=mask;
+        _aNumActive[kb]++;
+      }
+    }
+  }
+}
@@ -0,0 +1,72 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2023 the Raven Development Team
+  ----------------------------------------------------------------
+  class definitions:
+  CExecutionPlan
+  ----------------------------------------------------------------*/
+
+#ifndef EXECUTIONPLAN_H
+#define EXECUTIONPLAN_H
+
+#include "RavenInclude.h"
+
+///////////////////////////////////////////////////////////////////
+/// \brief Types of process connection, which determine how solver applies connection rate to state variables
+//
+enum conn_type
+{
+  CONN_EXCHANGE,      ///< mass/energy moved from one state variable to another (iFrom!=iTo)
+  CONN_TO_ITSELF,     ///< water storage connected to itself (likely from redirect) - no change in storage, rate zeroed
+  CONN_ACCUMULATE     ///< state variable which is not a storage compartment (e.g., cumulative flux) - incremented by rate
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief Data abstraction for precompiled sequence of hydrological processes applied by solver
+/// \details Compiled by CModel::Initialize() (and recompiled upon HRU class changes) so that the solver
+///   need not query process connectivity, state variable types, or process applicability every time step.
+///   Stores a flat list of connections for all processes, indexed by global connection index qs, and,
+///   for each block of nBlock consecutive HRUs, the ordered list of processes which apply to at least one
+///   HRU in the block, with a bitmask indicating to which HRUs in the block each applies
+//
+class CExecutionPlan
+{
+private:/*------------------------------------------------------*/
+  int            _nProcesses;       ///< number of hydrological processes
+  int            _nHRUs;            ///< number of HRUs
+  int            _nBlock;           ///< number of HRUs in each block (1<=_nBlock<=MAX_HRU_BLOCK)
+  int            _nBlocks;          ///< number of HRU blocks
+  int            _nTotalConnections;///< total number of process connections
+
+  int           *_aNumConnections;  ///< number of connections of each process [size: _nProcesses]
+  int           *_aFirstConnection; ///< global index qs of first connection of each process [size: _nProcesses]
+  int           *_aFrom;            ///< state variable index losing mass/energy for each connection [size: _nTotalConnections]
+  int           *_aTo;              ///< state variable index gaining mass/energy for each connection [size: _nTotalConnections]
+  conn_type     *_aConnType;        ///< type of each connection [size: _nTotalConnections]
+
+  int           *_aNumActive;       ///< number of processes applied in each HRU block [size: _nBlocks]
+  int          **_aActive;          ///< ordered indices of processes applied in each HRU block [size: _nBlocks x _nProcesses]
+  unsigned int **_aMask;            ///< bitmask of HRUs in block to which corresponding active process applies [size: _nBlocks x _nProcesses]
+
+public:/*-------------------------------------------------------*/
+  CExecutionPlan(const int nProcesses,
+                 const int nHRUs,
+                 const int nBlock,
+                 const int nTotalConnections);
+  ~CExecutionPlan();
+
+  inline int              GetBlockSize      ()            const { return _nBlock; }
+  inline int              GetNumConnections (const int j) const { return _aNumConnections [j]; }
+  inline int              GetFirstConnection(const int j) const { return _aFirstConnection[j]; }
+  inline const int       *GetFromIndices    (const int j) const { return _aFrom    +_aFirstConnection[j]; }
+  inline const int       *GetToIndices      (const int j) const { return _aTo      +_aFirstConnection[j]; }
+  inline const conn_type *GetConnTypes      (const int j) const { return _aConnType+_aFirstConnection[j]; }
+
+  inline int              GetNumActive      (const int kb) const                { return _aNumActive[kb/_nBlock];    } ///< kb is index of first HRU in block
+  inline int              GetActiveProcess  (const int kb, const int n) const   { return _aActive   [kb/_nBlock][n]; }
+  inline unsigned int     GetActiveMask     (const int kb, const int n) const   { return _aMask     [kb/_nBlock][n]; }
+
+  void                    SetConnections    (const int j, const int nConnections, const int *iFrom, const int *iTo, const conn_type *ctype);
+  void                    SetApplicability  (const bool * const *should_apply);
+};
+#endif
@@ -8,6 +8,29 @@
 #include "Forcings.h"
 #include <string.h>
 
+forcing_chunk **CForcingGrid::_pChunkCache  =NULL;
+int             CForcingGrid::_nCachedChunks=0;
+int             CForcingGrid::_cache_counter=0;
+std::mutex              CForcingGrid::_netcdf_mutex;
+std::condition_variable CForcingGrid::_chunk_read;
+forcing_file   **CForcingGrid::_pOpenFiles  =NULL;
+int              CForcingGrid::_nOpenFiles  =0;
+forcing_var    **CForcingGrid::_pVarInfo    =NULL;
+int              CForcingGrid::_nVarInfo    =0;
+grid_weights   **CForcingGrid::_pSharedWeights=NULL;
+int              CForcingGrid::_nSharedWeights=0;
+
+const double ROW_RUN_MAX_FILL=0.5; ///< window is read row by row if weighted cells' row runs cover less than this fraction of it
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Returns memory used by values of chunk [bytes]
+//
+static double ChunkBytes(const forcing_chunk *pChunk)
+{
+  double size=(pChunk->aValF!=NULL) ? sizeof(float) : sizeof(double);
+  return (double)(pChunk->nRows)*(double)(pChunk->nCells)*size;
+}
+
 /*****************************************************************
    Constructor/Destructor
 ------------------------------------------------------------------
@@ -50,6 +73,7 @@ CForcingGrid::CForcingGrid(string       ForcingType,
   _LinTrans_b		  = 0.0;
   _deaccumulate		= false;
   _period_ending	= false;
+  _nc_cache_mem   = 0.0;
 
   // -------------------------------
   // Additional variables initialized and eventually overwritten by ParseTimeSeries
@@ -69,21 +93,41 @@ CForcingGrid::CForcingGrid(string       ForcingType,
     _aAvePET [i]=NOT_SPECIFIED;
   }
 
-  //initialized in ReallocateArraysInForcingGrid
+  //initialized in ReallocateArraysInForcingGrid, CalculateChunkSize
   _aVal                = NULL;
-
-  // initialized in AllocateWeightArray,SetIdxNonZeroGridCells()
+  _aValF               = NULL;
+  _single_prec         = false;
+  _pChunk              = NULL;
+  _pOwnChunk           = NULL;
+  _pNextChunk          = NULL;
+  _pPrefetchThread     = NULL;
+
+  // initialized in AllocateWeightArray,SetIdxNonZeroGridCells() or UseSharedWeights()
+  _pWeights            = NULL;
   _GridWeight          = NULL;
   _GridWtCellIDs       = NULL;
   _CellIDToIdx         = NULL;
   _nWeights            = NULL;
   _IdxNonZeroGridCells = NULL;
   _nNonZeroWeightedGridCells=0;
+  _RowRunStart         = NULL;
+  _RowRunLength        = NULL;
+
+  //initialized in BuildRemapMatrix(), RemapToHRUs()
+  _RemapPtr            = NULL;
+  _RemapIdx            = NULL;
+  _RemapWt             = NULL;
+  _aHRUVal             = NULL;
+  _aHRUDaily           = NULL;
+  _nRemapRows          = 0;
+  _remap_valid         = false;
+  _daily_valid         = false;
 
   //initialized in CalculateChunkSize()
   _ChunkSize           =0;
   _nChunk              =1;
   _iChunk              = -1; // current chunk read (-1 = no chunk read, 0 = first chunk...)
+  _chunk_expired       = false;
 
   //initialized in SetAttributeVarName
   _aLatitude           = NULL;
@@ -111,6 +155,7 @@ CForcingGrid::CForcingGrid( const CForcingGrid &grid )
   _LinTrans_a                  = grid._LinTrans_a                      ;
   _LinTrans_b                  = grid._LinTrans_b                      ;
   _period_ending               = grid._period_ending                   ;
+  _nc_cache_mem                = grid._nc_cache_mem                    ;
   for (int ii=0; ii<3;  ii++) {_DimNames [ii]= grid._DimNames [ii]; }
   for (int ii=0; ii<3;  ii++) {_GridDims [ii]= grid._GridDims [ii]; }
   for (int ii=0; ii<3;  ii++) {_WinLength[ii]= grid._WinLength[ii]; }
@@ -121,6 +166,7 @@ CForcingGrid::CForcingGrid( const CForcingGrid &grid )
   _ChunkSize                   = grid._ChunkSize                       ;
   _nChunk                      = grid._nChunk                          ;
   _iChunk                      = grid._iChunk                          ;
+  _chunk_expired               = grid._chunk_expired                   ;
   _start_day                   = grid._start_day                       ;
   _start_year                  = grid._start_year                      ;
   _tag                         = grid._tag                             ;
@@ -140,40 +186,24 @@ CForcingGrid::CForcingGrid( const CForcingGrid &grid )
   for (int ii=0; ii<12; ii++) {_aMaxTemp[ii] = grid._aMaxTemp[ii];}
   for (int ii=0; ii<12; ii++) {_aAvePET [ii] = grid._aAvePET [ii];}
 
-  _aVal=NULL;
-  _aVal = new double *[_ChunkSize];
-  ExitGracefullyIf(_aVal==NULL,"CForcingGrid::Copy Constructor(1)",OUT_OF_MEMORY);
-  for (int it=0; it<_ChunkSize; it++) {                       // loop over time points in buffer
-    _aVal[it]=NULL;
-    _aVal[it] = new double [_nNonZeroWeightedGridCells];
-    ExitGracefullyIf(_aVal[it]==NULL,"CForcingGrid::Constructor",OUT_OF_MEMORY);
-    for (int ic=0; ic<_nNonZeroWeightedGridCells;ic++){       // loop over non-zero weighted cells
-      _aVal[it][ic]=grid._aVal[it][ic];                            // copy the value
-    }
-  }
-
-  //cout<<"Creating new GridWeights array (Copy Constructor): "<<ForcingToString(_ForcingType)<<endl;
-
-  AllocateWeightArray(_nHydroUnits,_nCells);
-  for (int k=0; k<_nHydroUnits; k++) {
-    for(int i=0;i<grid._nWeights[k];i++) {
-      SetWeightVal(k,grid._GridWtCellIDs[k][i],grid._GridWeight[k][i]); //dynamically grows sparse matrix
-    }
-  }
-
-  _CellIDToIdx =NULL;
-  _CellIDToIdx = new int [_nCells];
-  ExitGracefullyIf(_CellIDToIdx==NULL,"CForcingGrid::Copy Constructor(8)",OUT_OF_MEMORY);
-  for(int c=0; c<_nCells; c++) {             // loop over non-zero weighted cells
-    _CellIDToIdx[c]=grid._CellIDToIdx[c];
-  }
-
-  _IdxNonZeroGridCells = NULL;
-  _IdxNonZeroGridCells = new int [_nNonZeroWeightedGridCells];
-  ExitGracefullyIf(_IdxNonZeroGridCells==NULL,"CForcingGrid::Copy Constructor(3)",OUT_OF_MEMORY);
-  for (int ic=0; ic<_nNonZeroWeightedGridCells; ic++) {             // loop over non-zero weighted cells
-    _IdxNonZeroGridCells[ic]=grid._IdxNonZeroGridCells[ic];
-  }
+  _pChunk=NULL;
+  _pNextChunk=NULL;
+  _pPrefetchThread=NULL;
+  _single_prec=grid._single_prec;
+  _pOwnChunk=AllocateChunk(_ChunkSize,_nNonZeroWeightedGridCells,_single_prec);
+  _aVal =_pOwnChunk->aVal;
+  _aValF=_pOwnChunk->aValF;
+  int nVals=_ChunkSize*_nNonZeroWeightedGridCells;
+  if(_single_prec) { memcpy(_aValF,grid._aValF,nVals*sizeof(float )); } // copy the values
+  else             { memcpy(_aVal ,grid._aVal ,nVals*sizeof(double)); }
+
+  // grid weights are not copied, but shared with original grid
+  _pWeights=grid._pWeights;
+  _pWeights->nRefs++;
+  SetWeightViews();
+
+  _aHRUVal=NULL;_aHRUDaily=NULL;_nRemapRows=0;
+  _remap_valid=false;_daily_valid=false;
 
   _aLatitude=NULL;_aLongitude=NULL;_aElevation=NULL;_aStationIDs=NULL;
   if(grid._aLatitude!=NULL) {
@@ -205,19 +235,20 @@ CForcingGrid::CForcingGrid( const CForcingGrid &grid )
 CForcingGrid::~CForcingGrid()
 {
   if (DESTRUCTOR_DEBUG){cout<<"    DELETING GRIDDED DATA"<<endl;}
-  if(_aVal!=NULL) {
-    for(int it=0; it<_ChunkSize; it++) { delete[] _aVal[it];      _aVal[it]=NULL; }      delete[] _aVal;_aVal= NULL;
+  FinishPrefetch();
+  if(_pChunk!=NULL) {
+    ReleaseCachedChunk(_pChunk); _pChunk=NULL; //shared chunk is deleted by cache
   }
+  DeleteChunk(_pOwnChunk); _pOwnChunk=NULL;
+  _aVal=NULL; _aValF=NULL;
 
-  for(int k=0; k<_nHydroUnits; k++) {
-    delete[] _GridWeight[k];    _GridWeight   [k]=NULL;
-    delete[] _GridWtCellIDs[k]; _GridWtCellIDs[k]=NULL;
+  ReleaseWeights(_pWeights);        _pWeights            = NULL; //shared weights deleted by last grid using them
+  for(int it=0; it<_nRemapRows; it++) {
+    delete [] _aHRUVal[it];
+    if(_aHRUDaily!=NULL) { delete [] _aHRUDaily[it]; }
   }
-  delete [] _GridWeight;            _GridWeight          = NULL;
-  delete [] _GridWtCellIDs;         _GridWtCellIDs       = NULL;
-  delete [] _CellIDToIdx;           _CellIDToIdx         = NULL;
-  delete [] _nWeights;              _nWeights            = NULL;
-  delete [] _IdxNonZeroGridCells;   _IdxNonZeroGridCells = NULL;
+  delete [] _aHRUVal;               _aHRUVal             = NULL;
+  delete [] _aHRUDaily;             _aHRUDaily           = NULL;
   delete [] _aLatitude;             _aLatitude           = NULL;
   delete [] _aLongitude;            _aLongitude          = NULL;
   delete [] _aElevation;            _aElevation          = NULL;
@@ -292,7 +323,7 @@ void CForcingGrid::ForcingGridInit(const optStruct   &Options)
   if(Options.noisy) { cout<<"Initializing grid file "<<_filename<<endl; }
 
   string filename_e=_filename;
-  SubstringReplace(filename_e,"*",to_string(g_current_e+1)); //replaces wildcard for ensemble runs
+  SubstringReplace(filename_e,"*",to_string(max(g_current_e,0)+1)); //replaces wildcard for ensemble runs (member 1 prior to first ensemble run)
 
   retval = nc_open(filename_e.c_str(),NC_NOWRITE,&ncid);          HandleNetCDFErrors(retval);
 
@@ -333,7 +364,7 @@ void CForcingGrid::ForcingGridInit(const optStruct   &Options)
 
   // Get the id of the data variable based on its name; varid will be set
   string varname_e=_varname;
-  SubstringReplace(varname_e,"*",to_string(g_current_e+1));//replaces wildcard for ensemble runs
+  SubstringReplace(varname_e,"*",to_string(max(g_current_e,0)+1));//replaces wildcard for ensemble runs
 
   retval = nc_inq_varid(ncid,varname_e.c_str(),&varid_f);         HandleNetCDFErrors(retval);
 
@@ -571,16 +602,12 @@ void CForcingGrid::ReallocateArraysInForcingGrid( )
   // -------------------------------
   // Initialize data array and set all entries to NODATA value
   // -------------------------------
-  _aVal = NULL;
-  _aVal =  new double *[ntime];
-  for (int it=0; it<ntime; it++) {                       // loop over time points in buffer
-    _aVal[it]=NULL;
-    _aVal[it] = new double [_nNonZeroWeightedGridCells];
-    ExitGracefullyIf(_aVal[it]==NULL,"CForcingGrid::ReallocateArraysInForcingGrid",OUT_OF_MEMORY);
-    for (int ic=0; ic<_nNonZeroWeightedGridCells;ic++){       // loop over non-zero weighted cells
-      _aVal[it][ic]=NETCDF_BLANK_VALUE;                       // initialize
-    }
-  }
+  if(_pChunk!=NULL) { ReleaseCachedChunk(_pChunk); _pChunk=NULL; }
+  DeleteChunk(_pOwnChunk);
+  _pOwnChunk=AllocateChunk(ntime,_nNonZeroWeightedGridCells,_single_prec);
+  _aVal =_pOwnChunk->aVal;
+  _aValF=_pOwnChunk->aValF;
+  _remap_valid=false;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -603,7 +630,6 @@ bool CForcingGrid::ReadData(const optStruct   &Options,
 
 #ifdef _RVNETCDF_
 
-  int     ir,ic,it;
   int     iChunk_new;    // chunk in which current model time step falls
 
   // check if chunk id is valid
@@ -617,18 +643,7 @@ bool CForcingGrid::ReadData(const optStruct   &Options,
   {
     Initialize(Options);
 
-    // allocate _aVal matrix using maximum chunk size
-    // -------------------------------
-    _aVal = NULL;
-    _aVal = new double *[_ChunkSize];
-    for (it=0; it<_ChunkSize; it++) {                    // loop over time points in buffer
-      _aVal[it]=NULL;
-      _aVal[it] = new double [_nNonZeroWeightedGridCells];
-      ExitGracefullyIf(_aVal[it]==NULL,"CForcingGrid::ReadData",OUT_OF_MEMORY);
-      for (ic=0; ic<_nNonZeroWeightedGridCells;ic++){    // loop over all non-zero weighted grid cells
-        _aVal[it][ic]=NETCDF_BLANK_VALUE;
-      }
-    }
+    // _aVal matrix is not allocated here - it points to a chunk in the forcing cache (see UseCachedChunk())
 
     // set _is_derived_data to False because data are truely read from a file
     // -------------------------------
@@ -643,24 +658,18 @@ bool CForcingGrid::ReadData(const optStruct   &Options,
   iChunk_new = max(int(floor((global_model_time+TIME_CORRECTION) / (_interval * _ChunkSize))),0);
 
   // check if given model time step is covered by current chunk; if yes, do nothing; if no,  read next chunk
-  if(_iChunk != iChunk_new)
+  if((_iChunk != iChunk_new) || (_chunk_expired))
   {
+    // wait for background read of next chunk (if any), which is then found in forcing cache
+    FinishPrefetch();
+
     // local variables
 
     int     ncid;          // file unit
     int     dim1;          // length of 1st dimension in NetCDF data
     int     dim2;          // length of 2nd dimension in NetCDF data
-    int     dim3;          // length of 3rd dimension in NetCDF data
-
-    int     varid_f;       // id of forcing variable read
-    double  missval;       // value of "missing_value" attribute of forcing variable
-    double  fillval;       // value of "_FillValue"    attribute of forcing variable
-    double  add_offset;    // value of "add_offset"    attribute of forcing variable
-    double  scale_factor;  // value of "scale_factor"  attribute of forcing variable
-    size_t  att_len;       // length of the attribute's text
-    nc_type att_type;      // type of attribute
-    int     retval;        // error value for NetCDF routines
     int     iChunkSize;    // size of current chunk; always equal _ChunkSize except for last chunk in file (might be shorter)
+    int     start_point;   // index of first time point of current chunk in NetCDF file
 
 
     if(Options.noisy){
@@ -679,336 +688,43 @@ bool CForcingGrid::ReadData(const optStruct   &Options,
 
     // determine chunk size
     // -------------------------------
-    iChunkSize = min(_ChunkSize,int((Options.duration - global_model_time) / _interval));
+    _chunk_expired=false;
+    GetChunkWindow(_iChunk,start_point,iChunkSize);
 
-    // Open NetCDF file, Get the id of the forcing data, varid_f
+    // Look for chunk in forcing cache (e.g., already read by previous ensemble member), otherwise add it
     // -------------------------------
     string filename_e=_filename;
-    SubstringReplace(filename_e,"*",to_string(g_current_e+1)); //replaces wildcard for ensemble runs
-
-    retval = nc_open(filename_e.c_str(),NC_NOWRITE,&ncid);      HandleNetCDFErrors(retval);
+    SubstringReplace(filename_e,"*",to_string(max(g_current_e,0)+1)); //replaces wildcard for ensemble runs
 
     string varname_e=_varname;
-    SubstringReplace(varname_e,"*",to_string(g_current_e+1)); //replaces wildcard for ensemble runs
-
-    retval = nc_inq_varid(ncid,varname_e.c_str(),&varid_f);     HandleNetCDFErrors(retval);
-
-    // find "_FillValue" of forcing data
-    // -------------------------------
-    fillval = NETCDF_BLANK_VALUE; //Default
-    retval = nc_inq_att(ncid, varid_f, "_FillValue", &att_type, &att_len);
-    if (retval != NC_ENOTATT) {
-      HandleNetCDFErrors(retval);
-      retval = nc_get_att_double(ncid, varid_f, "_FillValue", &fillval);       HandleNetCDFErrors(retval);// read attribute value
-    }
+    SubstringReplace(varname_e,"*",to_string(max(g_current_e,0)+1)); //replaces wildcard for ensemble runs
 
-    // find "missing_value" of forcing data
-    // -------------------------------
-    missval = NETCDF_BLANK_VALUE; //Default
-    retval = nc_inq_att(ncid, varid_f, "missing_value", &att_type, &att_len);
-    if (retval != NC_ENOTATT) {
-      HandleNetCDFErrors(retval);
-      retval = nc_get_att_double(ncid, varid_f, "missing_value", &missval);     HandleNetCDFErrors(retval);// read attribute value
-    }
+    string         key   =GetChunkKey(filename_e,varname_e,start_point,iChunkSize);
+    forcing_chunk *pChunk=FindCachedChunk(key);
+    bool           cached=(pChunk!=NULL);
 
-    // check for attributes "add_offset" of forcing data
-    // -------------------------------
-    add_offset = 0.0;
-    retval = nc_inq_att(ncid, varid_f, "add_offset", &att_type, &att_len);
-    if (retval != NC_ENOTATT) {
-      HandleNetCDFErrors(retval);
-      retval = nc_get_att_double(ncid, varid_f, "add_offset", &add_offset);       HandleNetCDFErrors(retval);// read attribute value
-    }
+    if(!cached) { pChunk=AddCachedChunk(key,_ChunkSize,_nNonZeroWeightedGridCells,_single_prec); }
+    else        { WaitForChunk(pChunk); } //may still be being read by prefetch thread of another grid
+    UseCachedChunk(pChunk);
+    TrimChunkCache(Options.NetCDF_cache_mem);
+    new_chunk_read = true;
 
-    // check for attributes "scale_factor" of forcing data
-    // -------------------------------
-    scale_factor = 1.0;
-    retval = nc_inq_att(ncid, varid_f, "scale_factor", &att_type, &att_len);
-    if (retval != NC_ENOTATT) {
-      HandleNetCDFErrors(retval);
-      retval = nc_get_att_double(ncid, varid_f, "scale_factor", &scale_factor);       HandleNetCDFErrors(retval);// read attribute value
-    }
-    if (Options.noisy){
-      cout << "iChunksize:  = " << iChunkSize   << endl;
-      cout << "add_offset   = " << add_offset   << endl;
-      cout << "scale_factor = " << scale_factor << endl;
-    }
+    if((cached) && (Options.noisy)) { cout<<"  ...chunk found in forcing cache"<<endl; }
 
-    // allocate aTmp matrix
+    // Get NetCDF file (opened once, kept open until end of simulation; only if chunk or attribute grids must be read)
     // -------------------------------
-    dim1 = 1; dim2 = 1; dim3 = 1;
-
-    if ( _is_3D ) {
-      switch(_dim_order)
-      {
-      case(1):
-        dim1 = _WinLength[0]; dim2 = _WinLength[1]; dim3 = iChunkSize;    break; // dimensions are (x,y,t)
-      case(2):
-        dim1 = _WinLength[1]; dim2 = _WinLength[0]; dim3 = iChunkSize;    break; // dimensions are (y,x,t)
-      case(3):
-        dim1 = _WinLength[0]; dim2 = iChunkSize;    dim3 = _WinLength[1]; break; // dimensions are (x,t,y)
-      case(4):
-        dim1 = iChunkSize;    dim2 = _WinLength[0]; dim3 = _WinLength[1]; break; // dimensions are (t,x,y)
-      case(5):
-        dim1 = _WinLength[1]; dim2 = iChunkSize;    dim3 = _WinLength[0]; break; // dimensions are (y,t,x)
-      case(6):
-        dim1 = iChunkSize;    dim2 = _WinLength[1]; dim3 = _WinLength[0]; break; // dimensions are (t,y,x)
-      }
-    }
-    else {
-      switch(_dim_order)
-      {
-      case(1):
-        dim1 = _GridDims[0]; dim2 = iChunkSize;   dim3 = 1; break; // dimensions are (station,t)
-      case(2):
-        dim1 = iChunkSize;   dim2 = _GridDims[0]; dim3 = 1; break; // dimensions are (t, station)
-      }
+    std::unique_lock<std::mutex> nc_lock(_netcdf_mutex);
+    ncid=DOESNT_EXIST;
+    if((!cached) || (iChunk_new==0)) {
+      ncid=GetNetCDFFile(filename_e,_nc_cache_mem);
     }
 
+    // Read chunk of data into cached chunk
     // -------------------------------
-    // emulate VLA 3D array storage - store 3D array as vector using Row Major Order
-    // -------------------------------
-    double *aVec=NULL;
-    aVec=new double[dim1*dim2*dim3];//stores actual data
-    ExitGracefullyIf(aVec==NULL,"CForcingGrid::ReadData : aVec",OUT_OF_MEMORY);
-    for(int i=0; i<dim1*dim2*dim3; i++) {
-      aVec[i]=NETCDF_BLANK_VALUE;
-    }
-
-    double ***aTmp3D=NULL; //stores pointers to rows/columns of 3D data
-    double  **aTmp2D=NULL; //stores pointers to rows/columns of 2D data
-    if ( _is_3D ) {
-      aTmp3D=new double **[dim1];
-      ExitGracefullyIf(aTmp3D==NULL,"CForcingGrid::ReadData : aTmp3D(0)",OUT_OF_MEMORY);
-      for(it=0;it<dim1;it++){
-        aTmp3D[it]=NULL;
-        aTmp3D[it]=new double *[dim2];
-        ExitGracefullyIf(aTmp3D[it]==NULL,"CForcingGrid::ReadData : aTmp3D(1)",OUT_OF_MEMORY);
-        for(ir=0;ir<dim2;ir++){
-          aTmp3D[it][ir]=&aVec[it*dim2*dim3+ir*dim3]; //points to correct location in aVec data storage
-        }
-      }
-    }
-    else {
-      aTmp2D=new double *[dim1];
-      ExitGracefullyIf(aTmp2D==NULL,"CForcingGrid::ReadData : aTmp2D(0)",OUT_OF_MEMORY);
-      for(it=0;it<dim1;it++){
-        aTmp2D[it]=&aVec[it*dim2]; //points to correct location in aVec data storage
-      }
+    if(!cached) {
+      ReadChunkFromNetCDF(ncid,varname_e,start_point,iChunkSize,pChunk,Options);
     }
 
-    // Read chunk of data.
-    // -------------------------------
-    if ( _is_3D )
-    {
-      int       start_point = _ChunkSize * _iChunk+(int)(_t_corr/_interval);;//JRC_TIME_FIX:
-      size_t    nc_start [3];
-      size_t    nc_length[3];
-      ptrdiff_t nc_stride[3];
-
-      nc_length[0] = (size_t)(dim1); nc_stride[0] = 1;
-      nc_length[1] = (size_t)(dim2); nc_stride[1] = 1;
-      nc_length[2] = (size_t)(dim3); nc_stride[2] = 1;
-
-      switch(_dim_order) {
-      case(1): // dimensions are (x,y,t)
-        nc_start[0]  = (size_t)(_WinStart[0]);  nc_start[1]  = (size_t)(_WinStart[1]);  nc_start[2]  = (size_t)(start_point);
-        break;
-      case(2): // dimensions are (y,x,t)
-        nc_start[0]  = (size_t)(_WinStart[1]);  nc_start[1]  = (size_t)(_WinStart[0]);  nc_start[2]  = (size_t)(start_point);
-        break;
-      case(3): // dimensions are (x,t,y)
-        nc_start[0]  = (size_t)(_WinStart[0]);  nc_start[1]  = (size_t)(start_point);   nc_start[2]  = (size_t)(_WinStart[1]);
-        break;
-      case(4): // dimensions are (t,x,y)
-        nc_start[0]  = (size_t)(start_point);   nc_start[1]  = (size_t)(_WinStart[0]);  nc_start[2]  = (size_t)(_WinStart[1]);
-        break;
-      case(5): // dimensions are (y,t,x)
-        nc_start[0]  = (size_t)(_WinStart[1]);  nc_start[1]  = (size_t)(start_point);   nc_start[2]  = (size_t)(_WinStart[0]);
-        break;
-      case(6): // dimensions are (t,y,x)
-        nc_start[0]  = (size_t)(start_point);   nc_start[1]  = (size_t)(_WinStart[1]);  nc_start[2]  = (size_t)(_WinStart[0]);
-        break;
-      }
-
-      //Read giant chunk of data from NetCDF (this is the bottleneck of this code)
-      retval=nc_get_vars_double(ncid,varid_f,nc_start,nc_length,nc_stride,&aTmp3D[0][0][0]);   HandleNetCDFErrors(retval);
-      new_chunk_read = true;
-
-      if (Options.noisy) {
-        cout<<" CForcingGrid::ReadData - is3D"<<endl;
-        cout<<"  Dim of chunk read: dim3 = "<<dim3<<"   dim2 = "<<dim2<<"   dim1 = "<<dim1<<endl;
-        cout<<"  start  chunk: ("<<nc_start[0]<<","<<nc_start[1]<<","<<nc_start[2]<<")"<<endl;
-        cout<<"  length  chunk: ("<<nc_length[0]<<","<<nc_length[1]<<","<<nc_length[2]<<")"<<endl;
-        cout<<"  stride  chunk: ("<<nc_stride[0]<<","<<nc_stride[1]<<","<<nc_stride[2]<<")"<<endl;
-      }
-    }
-    else //2D
-    {
-      int       start_point = _ChunkSize * _iChunk+(int)(_t_corr/_interval);//JRC_TIME_FIX:
-      size_t    nc_start[2];
-      size_t    nc_length[2];
-      ptrdiff_t nc_stride[2];
-
-      nc_length[0] = (size_t)(dim1); nc_stride[0] = 1;
-      nc_length[1] = (size_t)(dim2); nc_stride[1] = 1;
-
-      switch(_dim_order) {
-        case(1): // dimensions are (station,t)
-          nc_start[0]  = 0;
-          nc_start[1]  = (size_t)(start_point);
-          break;
-        case(2): // dimensions are (t,station)
-          nc_start[0]  = (size_t)(start_point);
-          nc_start[1]  = 0;
-          break;
-      }
-
-      //Read from NetCDF (this is the bottleneck of this code)
-      retval=nc_get_vars_double(ncid,varid_f,nc_start,nc_length,nc_stride,&aTmp2D[0][0]);
-      HandleNetCDFErrors(retval);
-      new_chunk_read = true;
-
-      if (Options.noisy) {
-        cout<<" CForcingGrid::ReadData - !is3D"<<endl;
-        cout<<"  Dim of chunk read: dim2 = "<<dim2<<"   dim1 = "<<dim1<<endl;
-        cout<<"  start  chunk: (" <<nc_start [0]<<","<<nc_start [1]<<")"<<endl;
-        cout<<"  length  chunk: ("<<nc_length[0]<<","<<nc_length[1]<<")"<<endl;
-        cout<<"  stride  chunk: ("<<nc_stride[0]<<","<<nc_stride[1]<<")"<<endl;
-      }
-    }
-
-    // Re-scale NetCDF variables based on their internal add-offset and scale_factor
-    // MANDATORY to do before any value of these data are used
-    // -------------------------------
-    if ( _is_3D ) {
-      for (it=0;it<dim1;it++){
-        for (ir=0;ir<dim2;ir++){
-	        for (ic=0;ic<dim3;ic++){
-	          aTmp3D[it][ir][ic] = aTmp3D[it][ir][ic] * scale_factor + add_offset;
-            //if  ((it==0) || (it==dim1-1)) {cout<<setprecision(4)<<setw(9)<<aTmp3D[it][ir][ic]<<" ";}
-	        }
-        //if ((it==0) || (it==dim1-1)) { cout << endl; }
-        }
-       //if  ((it==0) || (it==dim1-1)) {cout<<endl<<endl;}
-      }
-    }
-    else {
-      for (it=0;it<dim1;it++){
-	      for (ir=0;ir<dim2;ir++){
-	        aTmp2D[it][ir] = aTmp2D[it][ir] * scale_factor + add_offset;
-	      }
-      }
-    }
-
-
-    // Copy all data from aTmp array to member array _aVal.
-    // -------------------------------
-    double val;
-    if ( _is_3D )
-    {
-      int irow,icol;
-      if (_dim_order == 1) {
-        for (it=0; it<iChunkSize; it++){                     // loop over time points in buffer
-          for (ic=0; ic<_nNonZeroWeightedGridCells; ic++){   // loop over non-zero weighted grid cells
-            CellIdxToRowCol(_IdxNonZeroGridCells[ic],irow,icol);
-            val=aTmp3D[icol-_WinStart[0]][irow-_WinStart[1]][it];
-            if(val==missval) { CheckValue3D(val,missval,it,irow,icol); }
-            if(val==fillval) { CheckValue3D(val,fillval,it,irow,icol); }
-            _aVal[it][ic]=_LinTrans_a*val+_LinTrans_b;
-
-          }
-        }
-      }
-      else if (_dim_order == 2) {
-        for (it=0; it<iChunkSize; it++){                     // loop over time points in buffer
-          for (ic=0; ic<_nNonZeroWeightedGridCells; ic++){   // loop over non-zero weighted grid cells
-		        CellIdxToRowCol(_IdxNonZeroGridCells[ic],irow,icol);
-		        val=aTmp3D[irow-_WinStart[1]][icol-_WinStart[0]][it];
-            if(val==missval) { CheckValue3D(val,missval,it,irow,icol); }
-            if(val==fillval) { CheckValue3D(val,fillval,it,irow,icol); }
-            _aVal[it][ic]=_LinTrans_a*val+_LinTrans_b;
-		      }
-		    }
-      }
-      else if (_dim_order == 3) {
-        for (it=0; it<iChunkSize; it++){                     // loop over time points in buffer
-          for (ic=0; ic<_nNonZeroWeightedGridCells; ic++){   // loop over non-zero weighted grid cells
-            CellIdxToRowCol(_IdxNonZeroGridCells[ic],irow,icol);
-            val=aTmp3D[icol-_WinStart[0]][it][irow-_WinStart[1]];
-            if(val==missval) { CheckValue3D(val,missval,it,irow,icol); }
-            if(val==fillval) { CheckValue3D(val,fillval,it,irow,icol); }
-            _aVal[it][ic]=_LinTrans_a*val+_LinTrans_b;
-          }
-        }
-      }
-      else if (_dim_order == 4) {
-        for (it=0; it<iChunkSize; it++){                     // loop over time points in buffer
-          for (ic=0; ic<_nNonZeroWeightedGridCells; ic++){   // loop over non-zero weighted grid cells
-            CellIdxToRowCol(_IdxNonZeroGridCells[ic],irow,icol);
-            val=aTmp3D[it][icol-_WinStart[0]][irow-_WinStart[1]];
-            if(!((Options.deltaresFEWS) && (it==0))) {
-              if(val==missval) { CheckValue3D(val,missval,it,irow,icol); }
-              if(val==fillval) { CheckValue3D(val,fillval,it,irow,icol); }
-            }
-            _aVal[it][ic]=_LinTrans_a*val+_LinTrans_b;
-          }
-        }
-      }
-      else if (_dim_order == 5) {
-        for (it=0; it<iChunkSize; it++){                     // loop over time points in buffer
-          for (ic=0; ic<_nNonZeroWeightedGridCells; ic++){   // loop over non-zero weighted grid cells
-            CellIdxToRowCol(_IdxNonZeroGridCells[ic],irow,icol);
-            val=aTmp3D[irow-_WinStart[1]][it][icol-_WinStart[0]];
-            if(val==missval) { CheckValue3D(val,missval,it,irow,icol); }
-            if(val==fillval) { CheckValue3D(val,fillval,it,irow,icol); }
-            _aVal[it][ic]=_LinTrans_a*val+_LinTrans_b;
-          }
-        }
-      }
-      else if (_dim_order == 6) {
-        for (it=0; it<iChunkSize; it++){                      // loop over time points in buffer
-          for (ic=0; ic<_nNonZeroWeightedGridCells; ic++){    // loop over non-zero weighted grid cells
-            CellIdxToRowCol(_IdxNonZeroGridCells[ic],irow,icol);
-            val=aTmp3D[it][irow-_WinStart[1]][icol-_WinStart[0]];
-            if(val==missval) { CheckValue3D(val,missval,it,irow,icol);}
-            if(val==fillval) { CheckValue3D(val,fillval,it,irow,icol); }
-            _aVal[it][ic]=_LinTrans_a*val+_LinTrans_b;
-          }
-        }
-      }
-    }
-    else // 2D
-    {
-      if (_dim_order == 1) {
-        for (it=0; it<iChunkSize; it++){                     // loop over time points in buffer
-          for (ic=0; ic<_nNonZeroWeightedGridCells; ic++){   // loop over non-zero weighted grid cells
-            val=aTmp2D[_IdxNonZeroGridCells[ic]][it];
-            if(val==missval) { CheckValue2D(val,missval,_IdxNonZeroGridCells[ic],it); }   // throw error  if value to read in equals "missing_value"
-            if(val==fillval) { CheckValue2D(val,fillval,_IdxNonZeroGridCells[ic],it); }   // throw error  if value to read in equals "_FillValue"
-            _aVal[it][ic]=_LinTrans_a*val+_LinTrans_b;
-          }
-        }
-      }
-      else if (_dim_order == 2) {
-        for (it=0; it<iChunkSize; it++){                     // loop over time points in buffer
-          for (ic=0; ic<_nNonZeroWeightedGridCells; ic++){   // loop over non-zero weighted grid cells
-            val=aTmp2D[it][_IdxNonZeroGridCells[ic]];
-            if(val==missval)  { CheckValue2D(val,missval,it,_IdxNonZeroGridCells[ic]); }  // throw error if value to read in equals "missing_value"
-            if(val==fillval)  { CheckValue2D(val,fillval,it,_IdxNonZeroGridCells[ic]); }  // throw error if value to read in equals "_FillValue"
-            if(rvn_isnan(val)){ CheckValue2D(val,NAN,    it,_IdxNonZeroGridCells[ic]); }
-            _aVal[it][ic]=_LinTrans_a*val+_LinTrans_b;
-          }
-        }
-      }
-    }
-
-    //delete dynamic arrays
-    // -------------------------------
-    if ( _is_3D ) {for (it=0;it<dim1;it++){delete [] aTmp3D[it];} delete [] aTmp3D;}
-    else          {delete [] aTmp2D;}
-    delete [] aVec;
-
     // read attribute grids - lat, long, elevation of grid cells
     // -------------------------------
     if (iChunk_new==0){
@@ -1044,10 +760,13 @@ bool CForcingGrid::ReadData(const optStruct   &Options,
       }
     }
 
+    nc_lock.unlock();
+
+    // Start reading next chunk in background while this one is simulated
     // -------------------------------
-    // Close NetCDF file
-    // -------------------------------
-    retval = nc_close(ncid);       HandleNetCDFErrors(retval);
+    if(Options.NetCDF_prefetch) {
+      StartPrefetch(_iChunk+1,Options);
+    }
 
   }// end if(_iChunk != iChunk_new)
 
@@ -1057,6 +776,631 @@ bool CForcingGrid::ReadData(const optStruct   &Options,
 
 }
 
+///////////////////////////////////////////////////////////////////
+/// \brief  Reads chunk of data from open NetCDF file, rescales it, and stores values of non-zero weighted grid cells in chunk storage
+///
+/// \param ncid        [in] id of open NetCDF file
+/// \param varname     [in] name of forcing variable in NetCDF file (ensemble wildcard already replaced)
+/// \param start_point [in] index of first time point of chunk in NetCDF file
+/// \param iChunkSize  [in] number of time points in chunk
+/// \param pChunk      [out] chunk storage [size: _ChunkSize x _nNonZeroWeightedGridCells], in double or single precision
+/// \param &Options    [in] Global model options information
+//
+void CForcingGrid::ReadChunkFromNetCDF(const int ncid,const string varname,const int start_point,const int iChunkSize,forcing_chunk *pChunk,const optStruct &Options)
+{
+#ifdef _RVNETCDF_
+  // Get the id and attributes of the forcing data (queried only upon first read from file)
+  // -------------------------------
+  const forcing_var *pVar=GetNetCDFVar(ncid,varname);
+
+  if (Options.noisy){
+    cout << "iChunksize:  = " << iChunkSize         << endl;
+    cout << "add_offset   = " << pVar->add_offset   << endl;
+    cout << "scale_factor = " << pVar->scale_factor << endl;
+  }
+
+  // Read window in precision of chunk storage where conversion to single precision is exact; otherwise read in
+  // double precision, so that missing values are detected (and out-of-range values read) as in double precision mode
+  // -------------------------------
+  if     ((pChunk->aValF!=NULL) && (pVar->float_exact)) { ReadChunkWindow<float >(ncid,pVar,start_point,iChunkSize,pChunk->aValF,Options); }
+  else if (pChunk->aValF!=NULL)                         { ReadChunkWindow<double>(ncid,pVar,start_point,iChunkSize,pChunk->aValF,Options); }
+  else                                                  { ReadChunkWindow<double>(ncid,pVar,start_point,iChunkSize,pChunk->aVal ,Options); }
+#endif   // end #ifdef _RVNETCDF_
+}
+
+#ifdef _RVNETCDF_
+//////////////////////////////////////////////////////////////////
+/// \brief typed wrappers of NetCDF hyperslab reads, so that window may be read directly in precision of chunk storage
+//
+static int GetVarsNC(int ncid,int varid,const size_t *start,const size_t *len,const ptrdiff_t *stride,double *aOut){
+  return nc_get_vars_double(ncid,varid,start,len,stride,aOut);
+}
+static int GetVarsNC(int ncid,int varid,const size_t *start,const size_t *len,const ptrdiff_t *stride,float *aOut){
+  return nc_get_vars_float(ncid,varid,start,len,stride,aOut);
+}
+static int GetVaraNC(int ncid,int varid,const size_t *start,const size_t *len,double *aOut){
+  return nc_get_vara_double(ncid,varid,start,len,aOut);
+}
+static int GetVaraNC(int ncid,int varid,const size_t *start,const size_t *len,float *aOut){
+  return nc_get_vara_float(ncid,varid,start,len,aOut);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Reads window of NetCDF variable for one chunk (as type R) and copies rescaled values of non-zero weighted grid cells into aOut (of type T)
+///
+/// \param ncid        [in] id of open NetCDF file
+/// \param pVar        [in] cached id and attributes of forcing variable
+/// \param start_point [in] index of first time point of chunk in NetCDF file
+/// \param iChunkSize  [in] number of time points in chunk
+/// \param aOut        [out] flat chunk storage, aOut[it*_nNonZeroWeightedGridCells+ic]
+/// \param &Options    [in] Global model options information
+//
+template <class R,class T>
+void CForcingGrid::ReadChunkWindow(const int ncid,const forcing_var *pVar,const int start_point,const int iChunkSize,T *aOut,const optStruct &Options)
+{
+#ifdef _RVNETCDF_
+  int     ic,it;
+  int     retval;        // error value for NetCDF routines
+  int     ix,iy,itm;     // positions of x (or station), y, and t dimensions in NetCDF variable
+
+  double  missval      =pVar->missval;      // value of "missing_value" attribute of forcing variable
+  double  fillval      =pVar->fillval;      // value of "_FillValue"    attribute of forcing variable
+  double  add_offset   =pVar->add_offset;   // value of "add_offset"    attribute of forcing variable
+  double  scale_factor =pVar->scale_factor; // value of "scale_factor"  attribute of forcing variable
+
+  if ( _is_3D ) {
+    switch(_dim_order) {
+      case(1): ix=0; iy=1; itm=2; break; // dimensions are (x,y,t)
+      case(2): iy=0; ix=1; itm=2; break; // dimensions are (y,x,t)
+      case(3): ix=0; itm=1; iy=2; break; // dimensions are (x,t,y)
+      case(4): itm=0; ix=1; iy=2; break; // dimensions are (t,x,y)
+      case(5): iy=0; itm=1; ix=2; break; // dimensions are (y,t,x)
+      default: itm=0; iy=1; ix=2; break; // dimensions are (t,y,x)
+    }
+  }
+  else {
+    iy=DOESNT_EXIST;
+    if (_dim_order == 1) { ix=0; itm=1; } // dimensions are (station,t)
+    else                 { itm=0; ix=1; } // dimensions are (t,station)
+  }
+
+  // window dimensions and strides (window stored as vector using Row Major Order)
+  // -------------------------------
+  int       dims[3]={1,1,1};
+  size_t    nc_start [3];
+  size_t    nc_length[3];
+  ptrdiff_t nc_stride[3]={1,1,1};
+
+  dims[ix] =_WinLength[0]; nc_start[ix] =(size_t)(_WinStart[0]);
+  dims[itm]=iChunkSize;    nc_start[itm]=(size_t)(start_point);
+  if (_is_3D) { dims[iy]=_WinLength[1]; nc_start[iy]=(size_t)(_WinStart[1]); }
+  for (int d=0; d<3; d++) { nc_length[d]=(size_t)(dims[d]); }
+
+  int strides[3];
+  strides[2]=1; strides[1]=dims[2]; strides[0]=dims[1]*dims[2];
+
+  R *aVec=NULL;
+  aVec=new R[dims[0]*dims[1]*dims[2]];//stores actual data
+  ExitGracefullyIf(aVec==NULL,"CForcingGrid::ReadData : aVec",OUT_OF_MEMORY);
+  for(int i=0; i<dims[0]*dims[1]*dims[2]; i++) {
+    aVec[i]=(R)(NETCDF_BLANK_VALUE);
+  }
+
+  // Read chunk of data.
+  // -------------------------------
+  if ((!_is_3D) || (_RowRunStart==NULL))
+  {
+    //Read giant chunk of data from NetCDF (this is the bottleneck of this code)
+    retval=GetVarsNC(ncid,pVar->varid,nc_start,nc_length,nc_stride,aVec);   HandleNetCDFErrors(retval);
+  }
+  else
+  {
+    //Read only run of weighted columns in each row of window, then copy into window storage
+    int maxlen=0;
+    for(int r=0; r<_WinLength[1]; r++) { maxlen=max(maxlen,_RowRunLength[r]); }
+    R *aRun=new R [maxlen*iChunkSize];
+    ExitGracefullyIf(aRun==NULL,"CForcingGrid::ReadData : aRun",OUT_OF_MEMORY);
+
+    size_t run_start[3],run_length[3];
+    int    off[3];
+    for(int r=0; r<_WinLength[1]; r++)
+    {
+      if(_RowRunStart[r]==DOESNT_EXIST) { continue; }
+      run_start[ix] =(size_t)(_RowRunStart[r]); run_length[ix] =(size_t)(_RowRunLength[r]); off[ix] =_RowRunStart[r]-_WinStart[0];
+      run_start[iy] =(size_t)(_WinStart[1]+r);  run_length[iy] =1;                          off[iy] =r;
+      run_start[itm]=(size_t)(start_point);     run_length[itm]=(size_t)(iChunkSize);       off[itm]=0;
+
+      retval=GetVaraNC(ncid,pVar->varid,run_start,run_length,aRun);   HandleNetCDFErrors(retval);
+
+      int n=0;
+      for(int i0=0; i0<(int)(run_length[0]); i0++) {
+        for(int i1=0; i1<(int)(run_length[1]); i1++) {
+          R *row=&aVec[(off[0]+i0)*strides[0]+(off[1]+i1)*strides[1]+off[2]];
+          for(int i2=0; i2<(int)(run_length[2]); i2++,n++) { row[i2]=aRun[n]; }
+        }
+      }
+    }
+    delete [] aRun;
+  }
+
+  if (Options.noisy) {
+    if (_is_3D) { cout<<" CForcingGrid::ReadData - is3D"<<endl; }
+    else        { cout<<" CForcingGrid::ReadData - !is3D"<<endl; }
+    cout<<"  Dim of chunk read: ("<<dims[0]<<","<<dims[1]<<","<<dims[2]<<")"<<endl;
+    cout<<"  start  chunk: (" <<nc_start [0]<<","<<nc_start [1]; if (_is_3D) { cout<<","<<nc_start [2]; } cout<<")"<<endl;
+    cout<<"  length  chunk: ("<<nc_length[0]<<","<<nc_length[1]; if (_is_3D) { cout<<","<<nc_length[2]; } cout<<")"<<endl;
+  }
+
+  // Offset of each non-zero weighted grid cell in window at first time point
+  // -------------------------------
+  int *aCellOff=new int [_nNonZeroWeightedGridCells];
+  ExitGracefullyIf(aCellOff==NULL,"CForcingGrid::ReadData : aCellOff",OUT_OF_MEMORY);
+  int irow,icol;
+  for (ic=0; ic<_nNonZeroWeightedGridCells; ic++){
+    if (_is_3D) {
+      CellIdxToRowCol(_IdxNonZeroGridCells[ic],irow,icol);
+      aCellOff[ic]=(icol-_WinStart[0])*strides[ix]+(irow-_WinStart[1])*strides[iy];
+    }
+    else {
+      aCellOff[ic]=(_IdxNonZeroGridCells[ic]-_WinStart[0])*strides[ix];
+    }
+  }
+
+  // Re-scale NetCDF variables based on their internal add-offset and scale_factor,
+  // check for missing values, and copy to chunk storage aOut
+  // -------------------------------
+  double val;
+  bool   skip_first=(_is_3D && (_dim_order==4) && (Options.deltaresFEWS)); //first time step of Deltares FEWS files may be blank
+  for (it=0; it<iChunkSize; it++){                     // loop over time points in buffer
+    const R *aWin=aVec+it*strides[itm];
+    T       *aRow=aOut+it*_nNonZeroWeightedGridCells;
+    for (ic=0; ic<_nNonZeroWeightedGridCells; ic++){   // loop over non-zero weighted grid cells
+      val=(double)(aWin[aCellOff[ic]])*scale_factor+add_offset;
+      if (_is_3D) {
+        if (((val==missval) || (val==fillval)) && (!(skip_first && (it==0)))) {
+          CellIdxToRowCol(_IdxNonZeroGridCells[ic],irow,icol);
+          if(val==missval) { CheckValue3D(val,missval,it,irow,icol); }
+          if(val==fillval) { CheckValue3D(val,fillval,it,irow,icol); }
+        }
+      }
+      else if (_dim_order == 1) {
+        if(val==missval) { CheckValue2D(val,missval,_IdxNonZeroGridCells[ic],it); }   // throw error  if value to read in equals "missing_value"
+        if(val==fillval) { CheckValue2D(val,fillval,_IdxNonZeroGridCells[ic],it); }   // throw error  if value to read in equals "_FillValue"
+      }
+      else {
+        if(val==missval)  { CheckValue2D(val,missval,it,_IdxNonZeroGridCells[ic]); }  // throw error if value to read in equals "missing_value"
+        if(val==fillval)  { CheckValue2D(val,fillval,it,_IdxNonZeroGridCells[ic]); }  // throw error if value to read in equals "_FillValue"
+        if(rvn_isnan(val)){ CheckValue2D(val,NAN,    it,_IdxNonZeroGridCells[ic]); }
+      }
+      aRow[ic]=(T)(_LinTrans_a*val+_LinTrans_b);
+    }
+  }
+
+  //delete dynamic arrays
+  // -------------------------------
+  delete [] aCellOff;
+  delete [] aVec;
+
+#endif   // end #ifdef _RVNETCDF_
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Returns location of chunk in NetCDF file
+/// \param iChunk       [in] chunk index
+/// \param start_point [out] index of first time point of chunk in NetCDF file
+/// \param iChunkSize  [out] number of time points in chunk; always equal _ChunkSize except for last chunk in file (might be shorter)
+/// \remark the last chunk of the simulation is read to the end of the file (where available) rather than to the end of the
+///   simulation, since the timestep averages of the final timestep (see GetTimeIndex()) may extend past the simulation end
+//
+void CForcingGrid::GetChunkWindow(const int iChunk,int &start_point,int &iChunkSize) const
+{
+  start_point = _ChunkSize * iChunk+(int)(_t_corr/_interval);//JRC_TIME_FIX:
+  iChunkSize  = min(_ChunkSize,_nPulses-start_point);
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Returns key uniquely identifying a decoded chunk in the forcing cache
+/// \details Besides the file, variable and time window, the key includes everything used to decode
+///          the chunk (data window, selection and order of cells, linear transform), so that
+///          grids only share chunks with identical contents
+//
+string CForcingGrid::GetChunkKey(const string &filename_e,const string &varname_e,const int start_point,const int iChunkSize) const
+{
+  ostringstream key;
+  key<<setprecision(17);
+  key<<filename_e<<"|"<<varname_e<<"|"<<start_point<<"|"<<iChunkSize<<"|"<<_ChunkSize<<"|"<<_is_3D<<"|"<<_dim_order<<"|";
+  key<<_WinStart[0]<<","<<_WinStart[1]<<"|"<<_LinTrans_a<<","<<_LinTrans_b<<"|"<<_single_prec<<"|"<<_nNonZeroWeightedGridCells;
+  for(int ic=0; ic<_nNonZeroWeightedGridCells; ic++) {
+    key<<","<<_IdxNonZeroGridCells[ic];
+  }
+  return key.str();
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Returns chunk with given key from forcing cache, or NULL if it has not yet been read
+//
+forcing_chunk *CForcingGrid::FindCachedChunk(const string &key)
+{
+  for(int i=0; i<_nCachedChunks; i++) {
+    if(_pChunkCache[i]->key==key) {
+      _pChunkCache[i]->last_use=++_cache_counter;
+      return _pChunkCache[i];
+    }
+  }
+  return NULL;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Allocates (blank) chunk storage as one contiguous block aligned to FORCING_ALIGN_BYTES
+/// \param  nRows       [in] number of time points
+/// \param  nCells      [in] number of non-zero weighted grid cells
+/// \param  single_prec [in] true if values are stored in single precision
+/// \return pointer to new chunk, to be deleted using DeleteChunk()
+//
+forcing_chunk *CForcingGrid::AllocateChunk(const int nRows,const int nCells,const bool single_prec)
+{
+  forcing_chunk *pChunk=new forcing_chunk;
+  ExitGracefullyIf(pChunk==NULL,"CForcingGrid::AllocateChunk",OUT_OF_MEMORY);
+  pChunk->key     ="";
+  pChunk->nRows   =nRows;
+  pChunk->nCells  =nCells;
+  pChunk->nRefs   =0;
+  pChunk->last_use=0;
+  pChunk->pending =false;
+
+  size_t nVals=(size_t)(nRows)*(size_t)(nCells);
+  size_t size =single_prec ? sizeof(float) : sizeof(double);
+  pChunk->aRaw=new char [max(nVals,(size_t)(1))*size+FORCING_ALIGN_BYTES];
+  ExitGracefullyIf(pChunk->aRaw==NULL,"CForcingGrid::AllocateChunk(2)",OUT_OF_MEMORY);
+  size_t offset=(size_t)(pChunk->aRaw)%FORCING_ALIGN_BYTES;
+  char  *aligned=pChunk->aRaw+((offset==0) ? 0 : FORCING_ALIGN_BYTES-offset);
+
+  pChunk->aVal =NULL;
+  pChunk->aValF=NULL;
+  if(single_prec) {
+    pChunk->aValF=(float *)(aligned);
+    for(size_t i=0; i<nVals; i++) { pChunk->aValF[i]=(float)(NETCDF_BLANK_VALUE); }
+  }
+  else {
+    pChunk->aVal =(double *)(aligned);
+    for(size_t i=0; i<nVals; i++) { pChunk->aVal [i]=NETCDF_BLANK_VALUE; }
+  }
+  return pChunk;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Deletes chunk storage allocated by AllocateChunk()
+//
+void CForcingGrid::DeleteChunk(forcing_chunk *pChunk)
+{
+  if(pChunk==NULL) { return; }
+  delete [] pChunk->aRaw;
+  delete pChunk;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Adds new (blank) chunk to forcing cache
+/// \return pointer to new chunk, to be populated by caller
+//
+forcing_chunk *CForcingGrid::AddCachedChunk(const string &key,const int nRows,const int nCells,const bool single_prec)
+{
+  forcing_chunk *pChunk=AllocateChunk(nRows,nCells,single_prec);
+  pChunk->key     =key;
+  pChunk->last_use=++_cache_counter;
+  if(!DynArrayAppend((void**&)(_pChunkCache),(void*)(pChunk),_nCachedChunks)) {
+    ExitGracefully("CForcingGrid::AddCachedChunk: adding NULL chunk",BAD_DATA);
+  }
+  return pChunk;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Releases grid's reference to cached chunk
+/// \note   unused chunks are retained for re-use (e.g., by next ensemble member) until removed by TrimChunkCache()
+//
+void CForcingGrid::ReleaseCachedChunk(forcing_chunk *pChunk)
+{
+  pChunk->nRefs--;
+  ExitGracefullyIf(pChunk->nRefs<0,"CForcingGrid::ReleaseCachedChunk: chunk released too many times",RUNTIME_ERR);
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Deletes least recently used, unreferenced chunks from forcing cache until cache is smaller than max_mem
+/// \param  max_mem [in] maximum size of cache [MB] (chunks in use by forcing grids are never deleted)
+//
+void CForcingGrid::TrimChunkCache(const int max_mem)
+{
+  double mem=0.0;
+  for(int i=0; i<_nCachedChunks; i++) {
+    mem+=ChunkBytes(_pChunkCache[i]);
+  }
+  while(mem>(double)(max_mem)*1024*1024)
+  {
+    int iOldest=DOESNT_EXIST;
+    for(int i=0; i<_nCachedChunks; i++) {
+      if((_pChunkCache[i]->nRefs==0) && ((iOldest==DOESNT_EXIST) || (_pChunkCache[i]->last_use<_pChunkCache[iOldest]->last_use))) {
+        iOldest=i;
+      }
+    }
+    if(iOldest==DOESNT_EXIST) { break; } //all remaining chunks are in use
+
+    forcing_chunk *pChunk=_pChunkCache[iOldest];
+    mem-=ChunkBytes(pChunk);
+    DeleteChunk(pChunk);
+    _pChunkCache[iOldest]=_pChunkCache[_nCachedChunks-1];
+    _nCachedChunks--;
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Replaces contents of _aVal with rows of (read-only) cached chunk
+/// \param  pChunk [in] chunk from forcing cache
+//
+void CForcingGrid::UseCachedChunk(forcing_chunk *pChunk)
+{
+  pChunk->nRefs++;
+  if(_pChunk!=NULL) {
+    ReleaseCachedChunk(_pChunk);
+  }
+  DeleteChunk(_pOwnChunk); _pOwnChunk=NULL;
+  _pChunk=pChunk;
+  _aVal  =pChunk->aVal;
+  _aValF =pChunk->aValF;
+  _remap_valid=false;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Replaces shared cached chunk (or view of another grid's values) in _aVal with private copy, so that it may be modified
+/// \note   called from SetValue(), e.g., when deaccumulating precipitation
+//
+void CForcingGrid::PrivatizeChunk()
+{
+  int nRows=(_pChunk!=NULL) ? _pChunk->nRows : _ChunkSize;
+  forcing_chunk *pOwnChunk=AllocateChunk(nRows,_nNonZeroWeightedGridCells,_single_prec);
+  size_t nVals=(size_t)(nRows)*(size_t)(_nNonZeroWeightedGridCells);
+  if     (_aValF!=NULL) { memcpy(pOwnChunk->aValF,_aValF,nVals*sizeof(float )); }
+  else if(_aVal !=NULL) { memcpy(pOwnChunk->aVal ,_aVal ,nVals*sizeof(double)); } //otherwise, no values yet
+  if(_pChunk!=NULL) {
+    ReleaseCachedChunk(_pChunk); _pChunk=NULL;
+  }
+  _pOwnChunk=pOwnChunk;
+  _aVal  =_pOwnChunk->aVal;
+  _aValF =_pOwnChunk->aValF;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Makes values of grid a read-only view of current values of source grid, rather than a copy
+/// \details used by derived grids which are identical to their source (e.g., rainfall generated from precipitation).
+///          Cached chunks are shared by reference; values owned by pSource are viewed directly, so this must be
+///          called again whenever pSource reads a new chunk. Values are copied by SetValue() before any modification
+/// \param  pSource [in] grid with same cells, chunk size and precision
+//
+void CForcingGrid::ViewValuesOf(const CForcingGrid *pSource)
+{
+  ExitGracefullyIf((pSource->_ChunkSize!=_ChunkSize) || (pSource->_nNonZeroWeightedGridCells!=_nNonZeroWeightedGridCells) || (pSource->_single_prec!=_single_prec),
+                   "CForcingGrid::ViewValuesOf: source grid has different layout",RUNTIME_ERR);
+  if(pSource==this) { return; }
+  if(pSource->_pChunk!=NULL) {
+    UseCachedChunk(pSource->_pChunk);
+    return;
+  }
+  if(_pChunk!=NULL) {
+    ReleaseCachedChunk(_pChunk); _pChunk=NULL;
+  }
+  DeleteChunk(_pOwnChunk); _pOwnChunk=NULL;
+  _aVal =pSource->_aVal;
+  _aValF=pSource->_aValF;
+  _remap_valid=false;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Forces current chunk to be re-read upon next call to ReadData()
+/// \details used when the forcing file referred to by a '*' wildcard changes to that of another ensemble member
+///          but the model time (and therefore chunk index) does not, e.g., at the start of each forecast member
+//
+void CForcingGrid::ExpireChunk()
+{
+  if(_iChunk!=-1) { _chunk_expired=true; }
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Waits until cached chunk is no longer being read by the prefetch thread of any grid
+/// \param  pChunk [in] chunk from forcing cache
+//
+void CForcingGrid::WaitForChunk(forcing_chunk *pChunk)
+{
+  std::unique_lock<std::mutex> lock(_netcdf_mutex);
+  while(pChunk->pending) { _chunk_read.wait(lock); }
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Starts background thread reading chunk iChunk into the forcing cache (double buffering)
+/// \details The chunk is added to the cache immediately, marked as pending, and referenced by this grid
+///          so that it cannot be trimmed; when the model reaches the chunk, ReadData() waits for the thread
+///          to finish and then finds the chunk in the cache. Nothing is done if the chunk is beyond the end of the
+///          simulation or already cached.
+/// \param iChunk    [in] index of chunk to be read
+/// \param &Options  [in] Global model options information
+//
+void CForcingGrid::StartPrefetch(const int iChunk,const optStruct &Options)
+{
+  if((iChunk>=_nChunk) || (_pPrefetchThread!=NULL)) { return; }
+
+  int start_point,iChunkSize;
+  GetChunkWindow(iChunk,start_point,iChunkSize);
+  if(iChunkSize<=0) { return; }
+
+  string filename_e=_filename;
+  SubstringReplace(filename_e,"*",to_string(max(g_current_e,0)+1)); //replaces wildcard for ensemble runs
+
+  string varname_e=_varname;
+  SubstringReplace(varname_e,"*",to_string(max(g_current_e,0)+1)); //replaces wildcard for ensemble runs
+
+  string key=GetChunkKey(filename_e,varname_e,start_point,iChunkSize);
+  if(FindCachedChunk(key)!=NULL) { return; }
+
+  _pNextChunk=AddCachedChunk(key,_ChunkSize,_nNonZeroWeightedGridCells,_single_prec);
+  _pNextChunk->nRefs++;
+  _pNextChunk->pending=true;
+
+  _pPrefetchThread=new std::thread(&CForcingGrid::PrefetchChunk,this,filename_e,varname_e,start_point,iChunkSize,&Options);
+  ExitGracefullyIf(_pPrefetchThread==NULL,"CForcingGrid::StartPrefetch",OUT_OF_MEMORY);
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Reads chunk into _pNextChunk - body of background prefetch thread
+/// \note   NetCDF calls are serialized with those of other grids using _netcdf_mutex
+//
+void CForcingGrid::PrefetchChunk(const string filename_e,const string varname_e,const int start_point,const int iChunkSize,const optStruct *pOptions)
+{
+#ifdef _RVNETCDF_
+  std::lock_guard<std::mutex> lock(_netcdf_mutex);
+
+  int ncid=GetNetCDFFile(filename_e,_nc_cache_mem);
+  ReadChunkFromNetCDF(ncid,varname_e,start_point,iChunkSize,_pNextChunk,*pOptions);
+
+  _pNextChunk->pending=false;
+  _chunk_read.notify_all();
+#endif
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Returns id of NetCDF forcing file, opening it (with requested HDF5 chunk cache size) if not already open
+/// \details Files stay open until CloseNetCDFFiles() is called at the end of the simulation, so that chunk reads
+///          do not repeatedly re-open the file and re-read its metadata
+/// \param  filename_e [in] resolved filename (ensemble wildcard replaced)
+/// \param  cache_mem  [in] size of HDF5 chunk cache for this file [MB] (0 = NetCDF library default)
+/// \note   caller must hold _netcdf_mutex
+//
+int CForcingGrid::GetNetCDFFile(const string &filename_e,const double cache_mem)
+{
+  int ncid=DOESNT_EXIST;
+#ifdef _RVNETCDF_
+  for(int i=0; i<_nOpenFiles; i++) {
+    if(_pOpenFiles[i]->filename==filename_e) { return _pOpenFiles[i]->ncid; }
+  }
+  int    retval;
+  size_t size,nelems;
+  float  preemption;
+  if(cache_mem>0.0) { //chunk cache settings apply to subsequently opened files
+    retval = nc_get_chunk_cache(&size,&nelems,&preemption);                                 HandleNetCDFErrors(retval);
+    retval = nc_set_chunk_cache((size_t)(cache_mem*1024*1024),nelems,preemption);           HandleNetCDFErrors(retval);
+  }
+  retval = nc_open(filename_e.c_str(),NC_NOWRITE,&ncid);                                    HandleNetCDFErrors(retval);
+  if(cache_mem>0.0) {
+    retval = nc_set_chunk_cache(size,nelems,preemption);                                    HandleNetCDFErrors(retval);
+  }
+
+  forcing_file *pFile=new forcing_file;
+  ExitGracefullyIf(pFile==NULL,"CForcingGrid::GetNetCDFFile",OUT_OF_MEMORY);
+  pFile->filename=filename_e;
+  pFile->ncid    =ncid;
+  if(!DynArrayAppend((void**&)(_pOpenFiles),(void*)(pFile),_nOpenFiles)) {
+    ExitGracefully("CForcingGrid::GetNetCDFFile: adding NULL file",BAD_DATA);
+  }
+#endif
+  return ncid;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Returns id and packing/missing value attributes of variable in open NetCDF file, querying them upon first use
+/// \param  ncid      [in] id of open NetCDF file (from GetNetCDFFile())
+/// \param  varname_e [in] variable name (ensemble wildcard replaced)
+/// \note   caller must hold _netcdf_mutex
+//
+const forcing_var *CForcingGrid::GetNetCDFVar(const int ncid,const string &varname_e)
+{
+  for(int i=0; i<_nVarInfo; i++) {
+    if((_pVarInfo[i]->ncid==ncid) && (_pVarInfo[i]->varname==varname_e)) { return _pVarInfo[i]; }
+  }
+  forcing_var *pVar=new forcing_var;
+  ExitGracefullyIf(pVar==NULL,"CForcingGrid::GetNetCDFVar",OUT_OF_MEMORY);
+  pVar->ncid        =ncid;
+  pVar->varname     =varname_e;
+  pVar->varid       =DOESNT_EXIST;
+  pVar->fillval     =NETCDF_BLANK_VALUE; //Default
+  pVar->missval     =NETCDF_BLANK_VALUE; //Default
+  pVar->add_offset  =0.0;
+  pVar->scale_factor=1.0;
+  pVar->float_exact =false;
+#ifdef _RVNETCDF_
+  size_t  att_len;       // length of the attribute's text
+  nc_type att_type;      // type of attribute
+  int     retval;        // error value for NetCDF routines
+
+  retval = nc_inq_varid(ncid,varname_e.c_str(),&(pVar->varid));     HandleNetCDFErrors(retval);
+
+  // single precision reads are exact (and never out of range) only for float and 8/16-bit integer variables
+  nc_type var_type;
+  retval = nc_inq_vartype(ncid,pVar->varid,&var_type);              HandleNetCDFErrors(retval);
+  pVar->float_exact=((var_type==NC_FLOAT) || (var_type==NC_SHORT) || (var_type==NC_USHORT) || (var_type==NC_BYTE) || (var_type==NC_UBYTE));
+
+  // find "_FillValue" of forcing data
+  retval = nc_inq_att(ncid, pVar->varid, "_FillValue", &att_type, &att_len);
+  if (retval != NC_ENOTATT) {
+    HandleNetCDFErrors(retval);
+    retval = nc_get_att_double(ncid, pVar->varid, "_FillValue", &(pVar->fillval));         HandleNetCDFErrors(retval);
+  }
+  // find "missing_value" of forcing data
+  retval = nc_inq_att(ncid, pVar->varid, "missing_value", &att_type, &att_len);
+  if (retval != NC_ENOTATT) {
+    HandleNetCDFErrors(retval);
+    retval = nc_get_att_double(ncid, pVar->varid, "missing_value", &(pVar->missval));      HandleNetCDFErrors(retval);
+  }
+  // check for attributes "add_offset" of forcing data
+  retval = nc_inq_att(ncid, pVar->varid, "add_offset", &att_type, &att_len);
+  if (retval != NC_ENOTATT) {
+    HandleNetCDFErrors(retval);
+    retval = nc_get_att_double(ncid, pVar->varid, "add_offset", &(pVar->add_offset));      HandleNetCDFErrors(retval);
+  }
+  // check for attributes "scale_factor" of forcing data
+  retval = nc_inq_att(ncid, pVar->varid, "scale_factor", &att_type, &att_len);
+  if (retval != NC_ENOTATT) {
+    HandleNetCDFErrors(retval);
+    retval = nc_get_att_double(ncid, pVar->varid, "scale_factor", &(pVar->scale_factor));  HandleNetCDFErrors(retval);
+  }
+#endif
+  if(!DynArrayAppend((void**&)(_pVarInfo),(void*)(pVar),_nVarInfo)) {
+    ExitGracefully("CForcingGrid::GetNetCDFVar: adding NULL variable",BAD_DATA);
+  }
+  return pVar;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Closes all NetCDF forcing files kept open by ReadData() and clears variable information
+/// \note   called at end of each simulation, after all prefetch threads are finished, so that
+///         no file handles are carried over to the next (possibly forked) ensemble member
+//
+void CForcingGrid::CloseNetCDFFiles()
+{
+  std::lock_guard<std::mutex> lock(_netcdf_mutex);
+#ifdef _RVNETCDF_
+  int retval;
+  for(int i=0; i<_nOpenFiles; i++) {
+    retval = nc_close(_pOpenFiles[i]->ncid);       HandleNetCDFErrors(retval);
+  }
+#endif
+  for(int i=0; i<_nOpenFiles; i++) { delete _pOpenFiles[i]; }
+  delete [] _pOpenFiles; _pOpenFiles=NULL; _nOpenFiles=0;
+  for(int i=0; i<_nVarInfo;   i++) { delete _pVarInfo[i]; }
+  delete [] _pVarInfo;   _pVarInfo  =NULL; _nVarInfo  =0;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Waits for background read of next chunk (if any) to complete and releases grid's reference to it
+/// \note   called when the model reaches the next chunk, at the end of each simulation, and upon destruction
+//
+void CForcingGrid::FinishPrefetch()
+{
+  if(_pPrefetchThread==NULL) { return; }
+  _pPrefetchThread->join();
+  delete _pPrefetchThread;
+  _pPrefetchThread=NULL;
+
+  ReleaseCachedChunk(_pNextChunk);
+  _pNextChunk=NULL;
+}
+
 ///////////////////////////////////////////////////////////////////
 /// \brief   Enables queries of time series values using model time
 /// \details Calculates _t_corr, correction to global model time, checks for overlap
@@ -1240,75 +1584,108 @@ void CForcingGrid::SetIdxNonZeroGridCells(const int nHydroUnits, const int nGrid
   int mincol=_GridDims[0];
   int maxcol=0;
 
+  if (_pWeights == NULL){
+    ExitGracefully(
+      "CForcingGrid: SetIdxNonZeroGridCells: _GridWeight is not allocated yet. Call AllocateWeightArray(nHRUs) first.", RUNTIME_ERR);
+  }
+  ExitGracefullyIf(_pWeights->nRefs>1,"CForcingGrid: SetIdxNonZeroGridCells: cannot modify shared grid weights",RUNTIME_ERR);
+  grid_weights *pW=_pWeights;
+
   bool *nonzero= NULL;
   nonzero =  new bool [nGridCells];
   for (int il=0; il<nGridCells; il++) { // loop over all cells of NetCDF
     nonzero[il] = false;
   }
 
-  if (_GridWeight != NULL){
-    for(int k=0; k<nHydroUnits; k++) {  // loop over HRUs
-      for(int i=0; i<_nWeights[k]; i++) { // loop over all cells of NetCDF
-        if(_GridWeight[k][i] > 0.00001) {
-          nonzero[_GridWtCellIDs[k][i]] = true;
-          CellIdxToRowCol(_GridWtCellIDs[k][i],row,col);
-          if(row>maxrow) { maxrow=row; }
-          if(col>maxcol) { maxcol=col; }
-          if(row<minrow) { minrow=row; }
-          if(col<mincol) { mincol=col; }
-        }
+  for(int k=0; k<nHydroUnits; k++) {  // loop over HRUs
+    for(int i=0; i<pW->nWeights[k]; i++) { // loop over all cells of NetCDF
+      if(pW->GridWeight[k][i] > 0.00001) {
+        nonzero[pW->GridWtCellIDs[k][i]] = true;
+        CellIdxToRowCol(pW->GridWtCellIDs[k][i],row,col);
+        if(row>maxrow) { maxrow=row; }
+        if(col>maxcol) { maxcol=col; }
+        if(row<minrow) { minrow=row; }
+        if(col<mincol) { mincol=col; }
       }
     }
   }
-  else{
-    ExitGracefully(
-      "CForcingGrid: SetIdxNonZeroGridCells: _GridWeight is not allocated yet. Call AllocateWeightArray(nHRUs) first.", RUNTIME_ERR);
-  }
 
-  _WinLength[0]=maxcol-mincol+1;
-  _WinLength[1]=maxrow-minrow+1;
+  pW->WinLength[0]=maxcol-mincol+1;
+  pW->WinLength[1]=maxrow-minrow+1;
+  pW->WinStart [0]=mincol;
+  pW->WinStart [1]=minrow;
   _WinLength[2]=_GridDims[2];
-  _WinStart [0]=mincol;
-  _WinStart [1]=minrow;
   _WinStart [2]=0; //temporary - this shifts over course of simualtion
 
   //To remove support for local window:
-  //_WinLength[0]=_GridDims[0];_WinStart[0]=0;
-  //_WinLength[1]=_GridDims[1];_WinStart[1]=0;
+  //pW->WinLength[0]=_GridDims[0];pW->WinStart[0]=0;
+  //pW->WinLength[1]=_GridDims[1];pW->WinStart[1]=0;
 
   /*cout<<"INITIALIZING GRID WINDOW"<<endl;
-  cout<<" start   (col, row): ("<<_WinStart[0]              <<", "<<_WinStart[1]              <<")"<<endl;
+  cout<<" start   (col, row): ("<<pW->WinStart[0]           <<", "<<pW->WinStart[1]           <<")"<<endl;
   cout<<" end     (col, row): ("<<maxcol                    <<", "<<maxrow<<")"<<endl;
-  cout<<" lengths (col, row): ("<<_WinLength[0]             <<", "<<_WinLength[1]             <<")"<<endl;
+  cout<<" lengths (col, row): ("<<pW->WinLength[0]          <<", "<<pW->WinLength[1]          <<")"<<endl;
   cout<<"-----------------------------"<<endl;*/
 
+  // determine run of columns to read in each row of window; if runs are much smaller than window
+  // (e.g., narrow diagonal watershed), chunks are read row by row rather than as one window
+  delete [] pW->RowRunStart;  pW->RowRunStart =NULL;
+  delete [] pW->RowRunLength; pW->RowRunLength=NULL;
+  if((_is_3D) && (pW->WinLength[1]>1)) {
+    pW->RowRunStart =new int [pW->WinLength[1]];
+    pW->RowRunLength=new int [pW->WinLength[1]];
+    ExitGracefullyIf(pW->RowRunLength==NULL,"CForcingGrid::SetIdxNonZeroGridCells",OUT_OF_MEMORY);
+    int nRunCells=0;
+    for(int r=0; r<pW->WinLength[1]; r++) {
+      pW->RowRunStart [r]=DOESNT_EXIST;
+      pW->RowRunLength[r]=0;
+      for(col=mincol; col<=maxcol; col++) {
+        if(nonzero[(pW->WinStart[1]+r)*_GridDims[0]+col]) {
+          if(pW->RowRunStart[r]==DOESNT_EXIST) { pW->RowRunStart[r]=col; }
+          pW->RowRunLength[r]=col-pW->RowRunStart[r]+1;
+        }
+      }
+      nRunCells+=pW->RowRunLength[r];
+    }
+    if(nRunCells>=ROW_RUN_MAX_FILL*pW->WinLength[0]*pW->WinLength[1]) { //single window read is more efficient
+      delete [] pW->RowRunStart;  pW->RowRunStart =NULL;
+      delete [] pW->RowRunLength; pW->RowRunLength=NULL;
+    }
+    else if(Options.noisy) {
+      cout<<"  forcing grid read row by row: "<<nRunCells<<" of "<<pW->WinLength[0]*pW->WinLength[1]<<" window cells read"<<endl;
+    }
+  }
+
   // count number of non-zero weighted grid cells
-  _nNonZeroWeightedGridCells=0;
+  pW->nNonZeroWeightedGridCells=0;
   for (int il=0; il<nGridCells; il++) { // loop over all cells of NetCDF
-    if ( nonzero[il] ) { _nNonZeroWeightedGridCells++; }
+    if ( nonzero[il] ) { pW->nNonZeroWeightedGridCells++; }
   }
 
-  _IdxNonZeroGridCells = NULL;
-  _IdxNonZeroGridCells = new int [_nNonZeroWeightedGridCells];
-  for (int il=0; il<_nNonZeroWeightedGridCells; il++) { // loop over all cells non-zero weighted grid cells
-    _IdxNonZeroGridCells[il] = -1;
+  delete [] pW->IdxNonZeroGridCells;
+  pW->IdxNonZeroGridCells = new int [pW->nNonZeroWeightedGridCells];
+  for (int il=0; il<pW->nNonZeroWeightedGridCells; il++) { // loop over all cells non-zero weighted grid cells
+    pW->IdxNonZeroGridCells[il] = -1;
   }
-  _CellIDToIdx = NULL;
-  _CellIDToIdx = new int[nGridCells];
+  delete [] pW->CellIDToIdx;
+  pW->CellIDToIdx = new int[nGridCells];
   for(int c=0; c<nGridCells; c++) { // loop over all cells non-zero weighted grid cells
-    _CellIDToIdx[c] = DOESNT_EXIST;
+    pW->CellIDToIdx[c] = DOESNT_EXIST;
   }
 
   int ic = 0;
   for (int il=0; il<nGridCells; il++) { // loop over all cells of NetCDF
     if ( nonzero[il] ) {
-      _IdxNonZeroGridCells[ic] = il;
-      _CellIDToIdx[il]=ic;
+      pW->IdxNonZeroGridCells[ic] = il;
+      pW->CellIDToIdx[il]=ic;
       ic++;
     }
   }
   delete[] nonzero;
 
+  BuildRemapMatrix();
+  SetWeightViews();
+
   if (Options.noisy){
     cout<<"Finished SetIdxNonZeroGridCells routine, # of non-zero weighted cells: "<<_nNonZeroWeightedGridCells<<endl;
   }
@@ -1332,9 +1709,12 @@ void CForcingGrid::CalculateChunkSize(const optStruct& Options)
   if(_is_3D) { ntime = _GridDims[2]; }
   else       { ntime = _GridDims[1]; }
 
+  _single_prec=Options.NetCDF_single_prec;
+  int    nBytes=(_single_prec) ? (int)(sizeof(float)) : (int)(sizeof(double)); // bytes per stored value
+
   int    BytesPerTimestep;      // Memory requirement for one timestep of gridded forcing file [Bytes]
-  if(_is_3D) { BytesPerTimestep = 8 * _WinLength[0] * _WinLength[1]; }
-  else       { BytesPerTimestep = 8 * _WinLength[0]; }
+  if(_is_3D) { BytesPerTimestep = nBytes * _WinLength[0] * _WinLength[1]; }
+  else       { BytesPerTimestep = nBytes * _WinLength[0]; }
 
   //BytesPerTimestep = 8 * _nNonZeroWeightedGridCells; //?? amount actually stored in memory?
 
@@ -1495,7 +1875,7 @@ void CForcingGrid::SetaAvePET(const double aAvePET [12]){
 /// \brief sets the _aVal in class CForcingGrid
 ///
 /// \param ic    [in] Index of grid cell with non-zero weighting (value between 0 and _nNonZeroWeightedGridCells)
-/// \param it    [in] time   index of _aVal[t][idx]
+/// \param it    [in] time   index of value
 /// \param aVal  [in] value to be set
 //
 void CForcingGrid::SetValue( const int ic, const int it, const double aVal) {
@@ -1505,7 +1885,10 @@ void CForcingGrid::SetValue( const int ic, const int it, const double aVal) {
   if(ic>=_nNonZeroWeightedGridCells) {
     ExitGracefully("CForcingGrid::SetValue:invalid index",RUNTIME_ERR);}
 #endif
-  _aVal[it][ic] = aVal;
+  if(_pOwnChunk==NULL) { PrivatizeChunk(); } //cached chunk or viewed values are shared with other grids
+  if(_single_prec) { _aValF[it*_nNonZeroWeightedGridCells+ic]=(float)(aVal); }
+  else             { _aVal [it*_nNonZeroWeightedGridCells+ic]=aVal; }
+  _remap_valid=false;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1543,6 +1926,16 @@ void CForcingGrid::SetAsPeriodEnding()
   _period_ending=true;
 }
 
+///////////////////////////////////////////////////////////////////
+/// \brief sets size of HDF5 chunk cache used when NetCDF file is opened for reading forcings
+/// \param cache_mem [in] cache size [MB]; 0 uses NetCDF library default
+/// \note  if several grids read the same file, the setting of the first grid to open it is used
+//
+void CForcingGrid::SetChunkCacheSize(const double cache_mem)
+{
+  _nc_cache_mem=cache_mem;
+}
+
 ///////////////////////////////////////////////////////////////////
 /// \brief sets NetCDF variable names for lat, long, or elevation
 /// \param var [in] one of "Latitude","Longitude", or "Elevation"
@@ -1586,22 +1979,40 @@ void   CForcingGrid::AllocateWeightArray(const int nHydroUnits, const int nGridC
   // -------------------------------
   //cout<<"Creating new GridWeights array (Base Constructor): "<<ForcingToString(_ForcingType)<<endl;
 
-  _GridWeight = NULL;
-  _GridWeight = new double *[nHydroUnits];
-  ExitGracefullyIf(_GridWeight==NULL   ,"AllocateWeightArray(1)",OUT_OF_MEMORY);
-  _GridWtCellIDs=NULL;
-  _GridWtCellIDs = new int *[nHydroUnits];
-  ExitGracefullyIf(_GridWtCellIDs==NULL,"AllocateWeightArray(2)",OUT_OF_MEMORY);
-  _nWeights=NULL;
-  _nWeights = new int [nHydroUnits];
-  ExitGracefullyIf(_nWeights==NULL     ,"AllocateWeightArray(3)",OUT_OF_MEMORY);
+  ReleaseWeights(_pWeights);
+  grid_weights *pW=new grid_weights;
+  ExitGracefullyIf(pW==NULL,"AllocateWeightArray(0)",OUT_OF_MEMORY);
+  pW->key        ="";
+  pW->nHydroUnits=nHydroUnits;
+  pW->nCells     =nGridCells;
+  pW->nRefs      =1;
+
+  pW->GridWeight = new double *[nHydroUnits];
+  ExitGracefullyIf(pW->GridWeight==NULL   ,"AllocateWeightArray(1)",OUT_OF_MEMORY);
+  pW->GridWtCellIDs = new int *[nHydroUnits];
+  ExitGracefullyIf(pW->GridWtCellIDs==NULL,"AllocateWeightArray(2)",OUT_OF_MEMORY);
+  pW->nWeights = new int [nHydroUnits];
+  ExitGracefullyIf(pW->nWeights==NULL     ,"AllocateWeightArray(3)",OUT_OF_MEMORY);
   for(int k=0; k<nHydroUnits; k++) {
-    _GridWeight   [k] =NULL;
-    _GridWtCellIDs[k] =NULL;
-    _nWeights     [k] =0;
-  }
-
-
+    pW->GridWeight   [k] =NULL;
+    pW->GridWtCellIDs[k] =NULL;
+    pW->nWeights     [k] =0;
+  }
+
+  //populated in SetIdxNonZeroGridCells()
+  pW->CellIDToIdx        =NULL;
+  pW->nNonZeroWeightedGridCells=0;
+  pW->IdxNonZeroGridCells=NULL;
+  pW->WinStart [0]=0; pW->WinStart [1]=0;
+  pW->WinLength[0]=0; pW->WinLength[1]=0;
+  pW->RowRunStart        =NULL;
+  pW->RowRunLength       =NULL;
+  pW->RemapPtr           =NULL;
+  pW->RemapIdx           =NULL;
+  pW->RemapWt            =NULL;
+
+  _pWeights=pW;
+  SetWeightViews();
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1629,6 +2040,9 @@ void   CForcingGrid::SetWeightVal(const int HRUID,
     ExitGracefully(
       "CForcingGrid: SetWeightVal: _GridWeight is not allocated yet. Call AllocateWeightArray(nHRUs) first.",RUNTIME_ERR);
   }
+  if (_pWeights->nRefs>1){
+    ExitGracefully("CForcingGrid: SetWeightVal: cannot modify shared grid weights",RUNTIME_ERR);
+  }
 #endif
 
   if((HRUID<0) || (HRUID>=_nHydroUnits)) {
@@ -1696,6 +2110,7 @@ bool   CForcingGrid::CheckWeightArray(const int nHydroUnits, const int nGridCell
   bool   check = true;
 
   if (_GridWeight != NULL){
+     ExitGracefullyIf(_pWeights->nRefs>1,"CForcingGrid: CheckWeightArray: cannot modify shared grid weights",RUNTIME_ERR);
      for(int k=0; k<_nHydroUnits; k++) {  // loop over HRUs
       sum_HRU = 0.0;
       for(int i=0; i<_nWeights[k]; i++) { // loop over all cells
@@ -1838,16 +2253,238 @@ int CForcingGrid::GetTimeIndex(const double &t, const double &tstep) const
 //
 double CForcingGrid::GetWeightedValue(const int k,const double &t,const double &tstep) const
 {
+  if(!_remap_valid) { RemapToHRUs(); }
+
   int idx_new = GetTimeIndex(t,tstep);
   int nSteps = max(1,(int)(rvn_round(tstep/_interval)));//# of intervals in time step
-  double wt,sum=0.0;
-  for(int i = 0;i <_nWeights[k]; i++)
+  int it_start=max(idx_new,0);
+  int lim=min(nSteps,_ChunkSize-it_start);
+  if(lim==1) { return _aHRUVal[it_start][k]; }
+
+  double sum=0.0;
+  for(int it=it_start; it<it_start+lim; it++) {
+    sum += _aHRUVal[it][k];
+  }
+  return sum/(double)(lim);
+}
+///////////////////////////////////////////////////////////////////
+/// \brief builds compressed sparse row (CSR) form of grid weight matrix in _pWeights, indexed by local cell index
+/// \details called once grid weights and non-zero weighted cells are known. Weights of cells which were
+///          dropped as negligible in SetIdxNonZeroGridCells() are ignored
+//
+void CForcingGrid::BuildRemapMatrix()
+{
+  grid_weights *pW=_pWeights;
+  delete [] pW->RemapPtr; pW->RemapPtr=NULL;
+  delete [] pW->RemapIdx; pW->RemapIdx=NULL;
+  delete [] pW->RemapWt;  pW->RemapWt =NULL;
+  if((pW->nWeights==NULL) || (pW->CellIDToIdx==NULL)) { return; }
+
+  int nnz=0;
+  for(int k=0; k<pW->nHydroUnits; k++) { nnz+=pW->nWeights[k]; }
+
+  pW->RemapPtr=new int    [pW->nHydroUnits+1];
+  pW->RemapIdx=new int    [max(nnz,1)];
+  pW->RemapWt =new double [max(nnz,1)];
+  ExitGracefullyIf(pW->RemapWt==NULL,"CForcingGrid::BuildRemapMatrix",OUT_OF_MEMORY);
+
+  int j=0;
+  for(int k=0; k<pW->nHydroUnits; k++) {
+    pW->RemapPtr[k]=j;
+    for(int i=0; i<pW->nWeights[k]; i++) {
+      int ic=pW->CellIDToIdx[pW->GridWtCellIDs[k][i]];
+      if(ic==DOESNT_EXIST) { continue; }
+      pW->RemapIdx[j]=ic;
+      pW->RemapWt [j]=pW->GridWeight[k][i];
+      j++;
+    }
+  }
+  pW->RemapPtr[pW->nHydroUnits]=j;
+  _remap_valid=false;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief points weight and cell index arrays, number of non-zero weighted cells, and data window at contents of _pWeights
+//
+void CForcingGrid::SetWeightViews()
+{
+  grid_weights *pW=_pWeights;
+  _GridWeight               =pW->GridWeight;
+  _GridWtCellIDs            =pW->GridWtCellIDs;
+  _nWeights                 =pW->nWeights;
+  _CellIDToIdx              =pW->CellIDToIdx;
+  _nNonZeroWeightedGridCells=pW->nNonZeroWeightedGridCells;
+  _IdxNonZeroGridCells      =pW->IdxNonZeroGridCells;
+  _RowRunStart              =pW->RowRunStart;
+  _RowRunLength             =pW->RowRunLength;
+  _RemapPtr                 =pW->RemapPtr;
+  _RemapIdx                 =pW->RemapIdx;
+  _RemapWt                  =pW->RemapWt;
+  for(int ii=0; ii<2; ii++) {
+    _WinStart [ii]=pW->WinStart [ii];
+    _WinLength[ii]=pW->WinLength[ii];
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Returns key identifying grid weights read from source on this grid
+/// \param  source [in] location of :GridWeights command (file and line number)
+//
+string CForcingGrid::GetWeightsKey(const string &source) const
+{
+  ostringstream key;
+  key<<source<<"|"<<_is_3D<<"|"<<_GridDims[0]<<"|"<<_GridDims[1];
+  return key.str();
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Replaces weights of grid with those already read from source by another grid on the same grid, if any
+/// \param  source [in] location of :GridWeights command (file and line number)
+/// \return true if shared weights are used (and :GridWeights block need not be parsed)
+//
+bool CForcingGrid::UseSharedWeights(const string &source)
+{
+  string key=GetWeightsKey(source);
+  for(int i=0; i<_nSharedWeights; i++) {
+    if(_pSharedWeights[i]->key==key) {
+      ReleaseWeights(_pWeights);
+      _pWeights=_pSharedWeights[i];
+      _pWeights->nRefs++;
+      _nHydroUnits=_pWeights->nHydroUnits;
+      SetWeightViews();
+      return true;
+    }
+  }
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Makes (complete) weights of grid available to other grids reading the same :GridWeights block
+/// \param  source [in] location of :GridWeights command (file and line number)
+//
+void CForcingGrid::ShareWeights(const string &source)
+{
+  ExitGracefullyIf(_pWeights==NULL,"CForcingGrid::ShareWeights: weights not allocated",RUNTIME_ERR);
+  if(_pWeights->key!="") { return; } //already shared
+  _pWeights->key=GetWeightsKey(source);
+  if(!DynArrayAppend((void**&)(_pSharedWeights),(void*)(_pWeights),_nSharedWeights)) {
+    ExitGracefully("CForcingGrid::ShareWeights: adding NULL weights",BAD_DATA);
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief  Releases grid's reference to weights; weights are deleted once no grid uses them
+//
+void CForcingGrid::ReleaseWeights(grid_weights *pW)
+{
+  if(pW==NULL) { return; }
+  pW->nRefs--;
+  if(pW->nRefs>0) { return; }
+
+  for(int i=0; i<_nSharedWeights; i++) {
+    if(_pSharedWeights[i]==pW) {
+      _pSharedWeights[i]=_pSharedWeights[_nSharedWeights-1];
+      _nSharedWeights--;
+      break;
+    }
+  }
+  if(_nSharedWeights==0) { delete [] _pSharedWeights; _pSharedWeights=NULL; }
+
+  for(int k=0; k<pW->nHydroUnits; k++) {
+    delete [] pW->GridWeight   [k];
+    delete [] pW->GridWtCellIDs[k];
+  }
+  delete [] pW->GridWeight;
+  delete [] pW->GridWtCellIDs;
+  delete [] pW->nWeights;
+  delete [] pW->CellIDToIdx;
+  delete [] pW->IdxNonZeroGridCells;
+  delete [] pW->RowRunStart;
+  delete [] pW->RowRunLength;
+  delete [] pW->RemapPtr;
+  delete [] pW->RemapIdx;
+  delete [] pW->RemapWt;
+  delete pW;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief multiplies CSR weight matrix (HRU x cell) with each row of contiguous chunk storage (time x cell)
+/// \param aVal  [in] chunk values, aVal[it*nCells+ic] (double or single precision)
+/// \param aOut  [out] weighted values, aOut[it][k]
+//
+template <class T>
+static void RemapChunkRows(const T *aVal,const int nRows,const int nCells,const int nHRUs,
+                           const int *ptr,const int *idx,const double *wt,double **aOut)
+{
+  for(int it=0; it<nRows; it++)
   {
-    wt   = _GridWeight[k][i];
-    sum += wt * GetValue_avg(_CellIDToIdx[_GridWtCellIDs[k][i]],idx_new,nSteps);
+    const T *row=aVal+(size_t)(it)*nCells;
+    double  *out=aOut[it];
+    for(int k=0; k<nHRUs; k++) {
+      double sum=0.0;
+      for(int j=ptr[k]; j<ptr[k+1]; j++) {
+        sum+=wt[j]*row[idx[j]];
+      }
+      out[k]=sum;
+    }
   }
-  return sum;
 }
+
+///////////////////////////////////////////////////////////////////
+/// \brief populates _aHRUVal with weighted values of each HRU at each time index of current chunk
+/// \details sparse (HRU x cell) by dense (cell x time) product, performed once per chunk rather than
+///          gathering the weighted cells of each HRU at each time step
+//
+void CForcingGrid::RemapToHRUs() const
+{
+  ExitGracefullyIf(_RemapPtr==NULL,"CForcingGrid::RemapToHRUs: grid weights not initialized",RUNTIME_ERR);
+  if(_nRemapRows!=_ChunkSize) {
+    for(int it=0; it<_nRemapRows; it++) {
+      delete [] _aHRUVal[it];
+      if(_aHRUDaily!=NULL) { delete [] _aHRUDaily[it]; }
+    }
+    delete [] _aHRUVal;   _aHRUVal  =NULL;
+    delete [] _aHRUDaily; _aHRUDaily=NULL;
+    _aHRUVal=new double *[_ChunkSize];
+    ExitGracefullyIf(_aHRUVal==NULL,"CForcingGrid::RemapToHRUs",OUT_OF_MEMORY);
+    for(int it=0; it<_ChunkSize; it++) {
+      _aHRUVal[it]=new double [_nHydroUnits];
+      ExitGracefullyIf(_aHRUVal[it]==NULL,"CForcingGrid::RemapToHRUs(2)",OUT_OF_MEMORY);
+    }
+    _nRemapRows=_ChunkSize;
+  }
+
+  if(_aValF!=NULL) { RemapChunkRows(_aValF,_ChunkSize,_nNonZeroWeightedGridCells,_nHydroUnits,_RemapPtr,_RemapIdx,_RemapWt,_aHRUVal); }
+  else             { RemapChunkRows(_aVal ,_ChunkSize,_nNonZeroWeightedGridCells,_nHydroUnits,_RemapPtr,_RemapIdx,_RemapWt,_aHRUVal); }
+  _remap_valid=true;
+  _daily_valid=false;
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief populates _aHRUDaily with average of _aHRUVal over the day (_steps_per_day time indices) starting at each time index
+//
+void CForcingGrid::AggregateDailyHRUVals() const
+{
+  if(_aHRUDaily==NULL) {
+    _aHRUDaily=new double *[_nRemapRows];
+    ExitGracefullyIf(_aHRUDaily==NULL,"CForcingGrid::AggregateDailyHRUVals",OUT_OF_MEMORY);
+    for(int it=0; it<_nRemapRows; it++) {
+      _aHRUDaily[it]=new double [_nHydroUnits];
+      ExitGracefullyIf(_aHRUDaily[it]==NULL,"CForcingGrid::AggregateDailyHRUVals(2)",OUT_OF_MEMORY);
+    }
+  }
+  for(int it=0; it<_ChunkSize; it++)
+  {
+    int lim=min(_steps_per_day,_ChunkSize-it);
+    for(int k=0; k<_nHydroUnits; k++) {
+      double sum=0.0;
+      for(int n=it; n<it+lim; n++) { sum+=_aHRUVal[n][k]; }
+      _aHRUDaily[it][k]=sum/(double)(lim);
+    }
+  }
+  _daily_valid=true;
+}
+
 ///////////////////////////////////////////////////////////////////
 /// \brief returns daily weighted value of gridded forcing in HRU k
 /// \param k     [in] HRU index
@@ -1859,13 +2496,11 @@ double CForcingGrid::GetDailyWeightedValue(const int k,const double &t,const dou
 {
   double time_shift=Options.julian_start_day-floor(Options.julian_start_day+TIME_CORRECTION);
   int it_new_day = GetTimeIndex(t-time_shift,tstep);//index corresponding to start of day
-  double wt,sum=0;
-  for(int i = 0;i <_nWeights[k]; i++)
-  {
-    wt   = _GridWeight[k][i];
-    sum += wt * GetValue_avg(_CellIDToIdx[_GridWtCellIDs[k][i]],it_new_day,_steps_per_day);
-  }
-  return sum;
+
+  if(!_remap_valid) { RemapToHRUs(); }
+  if(_steps_per_day==1) { return _aHRUVal[max(it_new_day,0)][k]; }
+  if(!_daily_valid) { AggregateDailyHRUVals(); }
+  return _aHRUDaily[max(it_new_day,0)][k];
 }
 ///////////////////////////////////////////////////////////////////
 /// \brief returns daily weighted snowfrac value if this is a gridded snow dataset and pRain is provided
@@ -1942,7 +2577,7 @@ double CForcingGrid::GetCellLongitude(const int l) const
 //
 double CForcingGrid::GetValue(const int ic, const int it) const
 {
-  return _aVal[it][ic];
+  return ChunkValue(it,ic);
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1958,7 +2593,7 @@ double CForcingGrid::GetValue_avg(const int ic, const double &t, const int nstep
   int lim=min(nsteps,_ChunkSize-it_start);
   double sum = 0.0;
   for (int it=it_start; it<it_start+lim;it++){
-    sum += _aVal[it][ic];
+    sum += ChunkValue(it,ic);
   }
   sum /= (double)(lim);
 
@@ -1978,7 +2613,7 @@ double CForcingGrid::GetValue_min(const int ic, const double &t, const int nstep
   int it_start=max((int)(t),0);
   int lim=min(nsteps,_ChunkSize-it_start);
   for (int it=it_start; it<it_start+lim;it++){
-    if(_aVal[it][ic] < min_val){min_val=_aVal[it][ic];}
+    if(ChunkValue(it,ic) < min_val){min_val=ChunkValue(it,ic);}
   }
   return min_val;
 }
@@ -1996,11 +2631,37 @@ double CForcingGrid::GetValue_max(const int ic, const double &t, const int nstep
   int it_start=max((int)(t),0);
   int lim=min(nsteps,_ChunkSize-it_start);
   for (int it=it_start; it<it_start+lim;it++){
-    if(_aVal[it][ic] > max_val){max_val=_aVal[it][ic];}
+    if(ChunkValue(it,ic) > max_val){max_val=ChunkValue(it,ic);}
   }
   return max_val;
 }
 
+///////////////////////////////////////////////////////////////////
+/// \brief Returns minimum, maximum, and average of n timesteps of time series data in one pass
+/// \param ic      [in] Index of grid cell with non-zero weighting (value between 0 and _nNonZeroWeightedGridCells)
+/// \param t       [in] Time index
+/// \param n       [in] Number of time steps
+/// \param min_val [out] minimum, as returned by GetValue_min()
+/// \param max_val [out] maximum, as returned by GetValue_max()
+/// \param avg_val [out] average, as returned by GetValue_avg()
+//
+void CForcingGrid::GetValue_stats(const int ic, const double &t, const int nsteps,
+                                  double &min_val, double &max_val, double &avg_val) const
+{
+  min_val = ALMOST_INF;
+  max_val =-ALMOST_INF;
+  int it_start=max((int)(t),0);
+  int lim=min(nsteps,_ChunkSize-it_start);
+  double sum = 0.0,val;
+  for (int it=it_start; it<it_start+lim;it++){
+    val=ChunkValue(it,ic);
+    if(val < min_val){min_val=val;}
+    if(val > max_val){max_val=val;}
+    sum += val;
+  }
+  avg_val=sum/(double)(lim);
+}
+
 ///////////////////////////////////////////////////////////////////
 /// \brief Returns grid filename
 //
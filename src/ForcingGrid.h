@@ -13,6 +13,84 @@
 #ifdef _RVNETCDF_
 #include <netcdf.h>
 #endif
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+const int FORCING_ALIGN_BYTES=64; ///< alignment (in bytes) of forcing chunk storage
+
+///////////////////////////////////////////////////////////////////
+/// \brief   Decoded chunk of gridded forcing data, shared read-only by all forcing grids reading the same data
+/// \details Chunks are stored in a process-wide cache, so that ensemble members which read the same
+///          NetCDF file decode each chunk only once. A grid which modifies its data (e.g., deaccumulation)
+///          first takes a private copy of the chunk (see CForcingGrid::SetValue()). Values are stored in one
+///          contiguous, aligned block, either in double or (if :SinglePrecisionForcings is used) single precision
+//
+struct forcing_chunk
+{
+  string   key;                                ///< unique identifier (resolved filename, variable, chunk start and size, cell layout)
+  double  *aVal;                               ///< decoded values, aVal[it*nCells+ic] [size: nRows*nCells] (NULL if single precision)
+  float   *aValF;                              ///< decoded values in single precision, laid out as aVal (NULL if double precision)
+  char    *aRaw;                               ///< unaligned memory containing aVal or aValF (as allocated)
+  int      nRows;                              ///< number of time points allocated (=_ChunkSize of reading grid)
+  int      nCells;                             ///< number of non-zero weighted grid cells
+  int      nRefs;                              ///< number of forcing grids currently using chunk
+  int      last_use;                           ///< value of cache access counter at most recent use (for least-recently-used eviction)
+  bool     pending;                            ///< true while chunk is being read by a background prefetch thread
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief   NetCDF forcing file kept open for the duration of a simulation
+/// \details Shared by all forcing grids (and prefetch threads) reading the same file, so that
+///          each chunk read does not re-open the file and rebuild the HDF5 metadata
+//
+struct forcing_file
+{
+  string   filename;                           ///< resolved filename (ensemble wildcard replaced)
+  int      ncid;                               ///< id of open NetCDF file
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief   Cached id and packing/missing value attributes of a forcing variable in an open NetCDF file
+//
+struct forcing_var
+{
+  int      ncid;                               ///< id of open NetCDF file
+  string   varname;                            ///< variable name (ensemble wildcard replaced)
+  int      varid;                              ///< id of variable in file
+  double   fillval;                            ///< value of "_FillValue"    attribute (NETCDF_BLANK_VALUE if absent)
+  double   missval;                            ///< value of "missing_value" attribute (NETCDF_BLANK_VALUE if absent)
+  double   add_offset;                         ///< value of "add_offset"    attribute (0.0 if absent)
+  double   scale_factor;                       ///< value of "scale_factor"  attribute (1.0 if absent)
+  bool     float_exact;                        ///< true if values of variable are exactly representable in single precision (float or 8/16-bit integer type)
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief   Grid weights of a forcing grid and the cell structures derived from them
+/// \details Shared (read-only) by all forcing grids on the same grid, i.e., by grids derived from a forcing
+///          grid (see CModel::ForcingCopyCreate()) and by grids reading the same :GridWeights block.
+///          Contents may only be modified while the weights are used by a single grid (during parsing)
+//
+struct grid_weights
+{
+  string   key;                                ///< source of weights (file and line of :GridWeights command, grid dimensions); empty if not shareable by source
+  int      nHydroUnits;                        ///< number of HRUs
+  int      nCells;                             ///< number of grid cells (or stations)
+  double **GridWeight;                         ///< non-zero weights of HRU k [size: nHydroUnits][nWeights[k]]
+  int    **GridWtCellIDs;                      ///< cell IDs of weights of HRU k [size: nHydroUnits][nWeights[k]]
+  int     *nWeights;                           ///< number of weights of HRU k [size: nHydroUnits]
+  int     *CellIDToIdx;                        ///< local cell index ic corresponding to cell ID (DOESNT_EXIST if unused) [size: nCells]
+  int      nNonZeroWeightedGridCells;          ///< number of non-zero weighted grid cells
+  int     *IdxNonZeroGridCells;                ///< cell IDs of non-zero weighted grid cells [size: nNonZeroWeightedGridCells]
+  int      WinStart [2];                       ///< data grid window starting point (x,y)
+  int      WinLength[2];                       ///< length of data grid window (x,y)
+  int     *RowRunStart;                        ///< first column read in each row of window [size: WinLength[1]] (NULL if window read at once)
+  int     *RowRunLength;                       ///< number of columns read in each row of window [size: WinLength[1]]
+  int     *RemapPtr;                           ///< CSR form of weights: first entry of HRU k in RemapIdx/RemapWt [size: nHydroUnits+1]
+  int     *RemapIdx;                           ///< CSR form of weights: local cell index ic of each weight
+  double  *RemapWt;                            ///< CSR form of weights: weight of each entry
+  int      nRefs;                              ///< number of forcing grids using weights
+};
 
 ///////////////////////////////////////////////////////////////////
 /// \brief   Data abstraction for gridded, 3D forcings
@@ -47,6 +125,7 @@ private:/*------------------------------------------------------*/
   int          _ChunkSize;                   ///< number of time points read before upper limit of allowed storage is reached
   int          _nChunk;                      ///< number of chunks (blocks) which can be read
   int          _iChunk;                      ///< current chunk read and stored in _aVal
+  bool         _chunk_expired;               ///< true if current chunk must be re-read upon next call to ReadData() (e.g., new ensemble member forcing file)
 
   double       _start_day;                   ///< Day corresponding to local TS time 0.0 (beginning of time series)
   int          _start_year;                  ///< Year corresponding to local TS time 0.0 (beginning of time series)
@@ -56,11 +135,20 @@ private:/*------------------------------------------------------*/
   bool         _is_derived;                  ///< true if forcing grid is derived from input forcings (e.g. t_ave from t_min and t_max)
   ///                                        ///< false if forcing grid is directly read from NetCDF file (e.g. t_min or t_max)
 
-  double     **_aVal;                        ///< Array of magnitudes of pulses (variable units)
-  ///                                        ///< [size _ChunkSize, _nNonZeroWeightedGridCells]
+  double      *_aVal;                        ///< Array of magnitudes of pulses (variable units), _aVal[it*_nNonZeroWeightedGridCells+ic]
+  ///                                        ///< [size _ChunkSize x _nNonZeroWeightedGridCells] - view of storage in _pChunk or _pOwnChunk
   ///                                        ///< time steps are in model resolution (means original input data are
-  ///                                        ///< already aggregated to match model resolution)
-
+  ///                                        ///< already aggregated to match model resolution); NULL if _single_prec
+  float       *_aValF;                       ///< single precision magnitudes of pulses, laid out as _aVal (NULL unless _single_prec)
+  bool         _single_prec;                 ///< true if chunk values are stored in single precision
+  forcing_chunk *_pChunk;                    ///< cached chunk viewed by _aVal (NULL if _aVal is owned by this grid)
+  forcing_chunk *_pOwnChunk;                 ///< chunk storage owned by this grid, e.g., for derived or modified data
+  ///                                        ///< (NULL if _pChunk used, or if _aVal is a view of another grid's values - see ViewValuesOf())
+  forcing_chunk *_pNextChunk;                ///< cached chunk being read in background by _pPrefetchThread (NULL if none)
+  std::thread   *_pPrefetchThread;           ///< background thread reading next chunk while current chunk is simulated (NULL if none)
+
+  grid_weights *_pWeights;                   ///< grid weights, possibly shared with other forcing grids; the weight and cell index
+  ///                                        ///< arrays below (_GridWeight to _RemapWt) are views of its contents
   double     **_GridWeight;                  ///< Sparse array of weights for each HRU for a list of cells
   //                                         ///< Dimensions : [_nHydroUnits][_nWeights[k]] (variable)
   //                                         ///< _GridWeight[k][i] is fraction of forcing for HRU k is from grid cell _GridWtCellIDs[k][i]
@@ -77,6 +165,18 @@ private:/*------------------------------------------------------*/
   int         *_IdxNonZeroGridCells;         ///< indexes of non-zero weighted grid cells [size = _nNonZeroWeightedGridCells]
   int          _WinLength[3];                ///< length of data grid window in each dimension (x,y,t - defaults to _GridDims)
   int          _WinStart [3];                ///< data grid window starting point (x,y,t - defaults to 0, 0, chunksize)
+  int         *_RowRunStart;                 ///< first column read in each row of window (DOESNT_EXIST if row has no non-zero weighted cells) [size: _WinLength[1]]
+  ///                                        ///< NULL if whole window is read at once (3D grids in which weighted cells fill most of window, and 2D grids)
+  int         *_RowRunLength;                ///< number of columns read in each row of window [size: _WinLength[1]]
+
+  int         *_RemapPtr;                    ///< CSR form of grid weights: first entry of HRU k in _RemapIdx/_RemapWt [size: _nHydroUnits+1]
+  int         *_RemapIdx;                    ///< CSR form of grid weights: local cell index ic of each weight [size: _RemapPtr[_nHydroUnits]]
+  double      *_RemapWt;                     ///< CSR form of grid weights: weight of each entry [size: _RemapPtr[_nHydroUnits]]
+  mutable double **_aHRUVal;                 ///< weighted values of current chunk in each HRU [size: _nRemapRows x _nHydroUnits] (populated by RemapToHRUs())
+  mutable double **_aHRUDaily;               ///< average of _aHRUVal over day starting at each time index [size: _nRemapRows x _nHydroUnits] (NULL until needed)
+  mutable int      _nRemapRows;              ///< number of time indices allocated in _aHRUVal and _aHRUDaily
+  mutable bool     _remap_valid;             ///< false if _aVal has changed since _aHRUVal was populated
+  mutable bool     _daily_valid;             ///< false if _aHRUVal has changed since _aHRUDaily was populated
 
   int          _nPulses;                     ///< number of pulses (total duration=(nPulses-1)*_interval)
   bool         _pulse;                       ///< flag determining whether this is a pulse-based or
@@ -89,6 +189,7 @@ private:/*------------------------------------------------------*/
   double       _LinTrans_b;                  ///< linear transformation of read data: new = a*data + b
   bool         _period_ending;               ///< true if data is period ending - subtracts additional interval *on top of _TimeShift*
   bool         _is_3D;                       ///< true if forcings are 3D (lat, lon, time); false if 2D (stations, time)
+  double       _nc_cache_mem;                ///< HDF5 chunk cache size [MB] used when opening NetCDF file (0 = library default)
 
   double       _rainfall_corr;               ///< correction factor for rainfall (stored with gauge, used elsewhere)
   double       _snowfall_corr;               ///< correction factor for snowfall (stored with gauge, used elsewhere)
@@ -110,8 +211,58 @@ private:/*------------------------------------------------------*/
                          int              &row,
                          int              &column) const;             ///< returns row and column index of cell ID
 
+  void   BuildRemapMatrix();                                         ///< builds CSR grid weight matrix from _GridWeight and _CellIDToIdx
+  void   SetWeightViews();                                           ///< points weight arrays and window at contents of _pWeights
+  void   RemapToHRUs         () const;                               ///< populates _aHRUVal from current chunk
+  void   AggregateDailyHRUVals() const;                              ///< populates _aHRUDaily from _aHRUVal
+
   void   ReadAttGridFromNetCDF (const int ncid,const string varname,const int nrows,const int ncols,double *&values);
   void   ReadAttGridFromNetCDF2(const int ncid,const string varname,const int nrows,const int ncols,string *values);
+  void   ReadChunkFromNetCDF   (const int ncid,const string varname,const int start_point,const int iChunkSize,forcing_chunk *pChunk,const optStruct &Options);
+  template <class R,class T>
+  void   ReadChunkWindow       (const int ncid,const forcing_var *pVar,const int start_point,const int iChunkSize,T *aOut,const optStruct &Options);
+
+  inline double ChunkValue(const int it,const int ic) const { ///< value of non-zero weighted cell ic at time index it of current chunk
+    if(_aValF!=NULL) { return (double)(_aValF[it*_nNonZeroWeightedGridCells+ic]); }
+    return _aVal[it*_nNonZeroWeightedGridCells+ic];
+  }
+
+  static forcing_chunk **_pChunkCache;       ///< process-wide cache of decoded chunks [size: _nCachedChunks]
+  static int             _nCachedChunks;     ///< number of chunks in cache
+  static int             _cache_counter;     ///< number of cache accesses (used to find least recently used chunks)
+
+  static std::mutex              _netcdf_mutex; ///< serializes NetCDF library calls of main and prefetch threads (NetCDF library is not thread-safe)
+  static std::condition_variable _chunk_read;   ///< signalled whenever a prefetch thread finishes reading a chunk
+
+  static forcing_file  **_pOpenFiles;        ///< NetCDF forcing files kept open during simulation [size: _nOpenFiles]
+  static int             _nOpenFiles;        ///< number of open forcing files
+  static forcing_var   **_pVarInfo;          ///< cached variable ids and attributes of open forcing files [size: _nVarInfo]
+  static int             _nVarInfo;          ///< number of cached variables
+
+  static int                GetNetCDFFile(const string &filename_e,const double cache_mem); ///< returns id of (opened or cached) file; _netcdf_mutex must be held
+  static const forcing_var *GetNetCDFVar (const int ncid,const string &varname_e);          ///< returns cached variable info; _netcdf_mutex must be held
+
+  void   GetChunkWindow (const int iChunk,int &start_point,int &iChunkSize) const;
+  string GetChunkKey    (const string &filename_e,const string &varname_e,const int start_point,const int iChunkSize) const;
+  void   UseCachedChunk (forcing_chunk *pChunk);                   ///< replaces contents of _aVal with shared cached chunk
+  void   PrivatizeChunk ();                                        ///< replaces shared cached chunk with a private copy prior to modification
+
+  static grid_weights **_pSharedWeights;     ///< grid weights available for re-use by source [size: _nSharedWeights]
+  static int             _nSharedWeights;    ///< number of shareable grid weights
+
+  string GetWeightsKey  (const string &source) const;
+  static void           ReleaseWeights    (grid_weights *pWeights); ///< releases grid's reference to weights; deletes weights if unused
+
+  static forcing_chunk *AllocateChunk     (const int nRows,const int nCells,const bool single_prec);
+  static void           DeleteChunk       (forcing_chunk *pChunk);
+  static forcing_chunk *FindCachedChunk   (const string &key);
+  static forcing_chunk *AddCachedChunk    (const string &key,const int nRows,const int nCells,const bool single_prec);
+  static void           ReleaseCachedChunk(forcing_chunk *pChunk);
+  static void           TrimChunkCache    (const int max_mem);     ///< deletes unused chunks until cache is smaller than max_mem [MB]
+  static void           WaitForChunk      (forcing_chunk *pChunk);  ///< waits until chunk is no longer being read by a prefetch thread
+
+  void   StartPrefetch  (const int iChunk,const optStruct &Options);  ///< starts background read of chunk iChunk
+  void   PrefetchChunk  (const string filename_e,const string varname_e,const int start_point,const int iChunkSize,const optStruct *pOptions);
 
 public:/*------------------------------------------------------*/
   //Constructors:
@@ -146,11 +297,22 @@ public:/*------------------------------------------------------*/
   bool   ReadData(const optStruct   &Options,
                   const double global_model_time);
 
+  // ExpireChunk forces ReadData to re-read current chunk (e.g., if wildcard in filename now refers to another ensemble member)
+  void   ExpireChunk();
+
+  // FinishPrefetch waits for background read of next chunk (if any) to complete
+  void   FinishPrefetch();
+
+  // CloseNetCDFFiles closes all forcing files kept open by ReadData (called at end of simulation, once prefetches are finished)
+  static void CloseNetCDFFiles();
+
   // accessors
   double GetValue                   (const int ic, const int it) const;
   double GetValue_avg               (const int ic, const double &t, const int n) const;
   double GetValue_min               (const int ic, const double &t, const int n) const;
   double GetValue_max               (const int ic, const double &t, const int n) const;
+  void   GetValue_stats             (const int ic, const double &t, const int n,
+                                     double &min_val, double &max_val, double &avg_val) const;
 
   // Weighting matrix associated routines
   void   AllocateWeightArray(              const int        nHydroUnits,
@@ -163,6 +325,8 @@ public:/*------------------------------------------------------*/
                                            const CModel    *pModel);                    ///< checks if sum(_GridWeight[HRUID, :]) = 1.0 for all HRUIDs
   double GetGridWeight(                    const int        k,
                                            const int        CellID) const;              ///< returns weighting of HRU and CellID pair \todo[clean]: function not used
+  bool   UseSharedWeights(                 const string    &source);                    ///< shares weights read from source by another grid, if any
+  void   ShareWeights(                     const string    &source);                    ///< makes weights of this grid (read from source) available to other grids
 
   // Routines for checking content
   void   CheckValue3D(                     const double value,
@@ -186,6 +350,7 @@ public:/*------------------------------------------------------*/
                                            const double LinTrans_b);
   void         SetTimeShift(               const double TimeShift);                 ///< set _TimeShift                 of class
   void         SetAsPeriodEnding           ();                                      ///< set _period_ending
+  void         SetChunkCacheSize(          const double cache_mem);                 ///< set _nc_cache_mem              of class
   void         SetIs3D(                    const bool   is3D);                      ///< set _is3D                      of class
   void         SetIdxNonZeroGridCells(     const int    nHydroUnits,
                                            const int    nGridCells, const optStruct &Options);
@@ -207,6 +372,7 @@ public:/*------------------------------------------------------*/
   void         SetValue(                   const int idx,
                                            const int t,
                                            const double aVal);                      ///< set _aVal              of class
+  void         ViewValuesOf(               const CForcingGrid *pSource);            ///< make _aVal a read-only view of values of pSource
   void         SetAttributeVarName(        const string var, const string varname); ///< set elevation, lat, or long var name
   void         SetStationElevation(        const int idx, const double &elev);      ///< set elevation of station idx
   void         SetIsDerived               (const bool is_derived);
@@ -130,6 +130,7 @@ public:/*-------------------------------------------------------*/
                         const optStruct   &Options,
                         const time_struct &tt,
                         double      *rates) const;
+  bool IsThreadSafe() const { return (type!=GINFIL_UBCWM); } //UBCWM RFS cheat reads b2 from previous HRU via g_debug_vars
 
   void        GetParticipatingParamList   (string  *aP, class_type *aPC, int &nP) const;
   static void GetParticipatingStateVarList(glacial_infil_type   mtype,
@@ -54,6 +54,7 @@ public:/*-------------------------------------------------------*/
                         const optStruct   &Options,
                         const time_struct &tt,
                         double      *rates) const;
+  bool IsThreadSafe() const { return false; } //uses static work arrays
 
   void GetParticipatingParamList(string  *aP,class_type *aPC,int &nP) const;
   void GetParticipatingStateVarList(sv_type *aSV,int *aLev,int &nSV);
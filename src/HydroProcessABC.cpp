@@ -243,6 +243,52 @@ void CHydroProcessABC::ApplyConstraints(const double *state_vars,
   return;
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief Returns rates of change for a block of HRUs
+/// \details Default implementation calls GetRatesOfChange() for each HRU in block
+///
+/// \param **state_vars [in] Array of pointers to state variable arrays of each HRU in block (size: nHRUs)
+/// \param **pHRUs [in] Array of pointers to HRUs in block (size: nHRUs)
+/// \param nHRUs [in] number of HRUs in block
+/// \param &Options [in] Global model option information
+/// \param &tt [in] Current model time
+/// \param **rates [out] Rates of change for each HRU in block (size: nHRUs x _nConnections)
+//
+void CHydroProcessABC::GetRatesOfChangeBlock(const double      *const *state_vars,
+                                             const CHydroUnit  *const *pHRUs,
+                                             const int                 nHRUs,
+                                             const optStruct          &Options,
+                                             const time_struct        &tt,
+                                                   double      *const *rates) const
+{
+  for (int b=0;b<nHRUs;b++){
+    GetRatesOfChange(state_vars[b],pHRUs[b],Options,tt,rates[b]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Corrects rates of change for a block of HRUs
+/// \details Default implementation calls ApplyConstraints() for each HRU in block
+///
+/// \param **state_vars [in] Array of pointers to state variable arrays of each HRU in block (size: nHRUs)
+/// \param **pHRUs [in] Array of pointers to HRUs in block (size: nHRUs)
+/// \param nHRUs [in] number of HRUs in block
+/// \param &Options [in] Global model option information
+/// \param &tt [in] Current model time
+/// \param **rates [in/out] Rates of change for each HRU in block (size: nHRUs x _nConnections)
+//
+void CHydroProcessABC::ApplyConstraintsBlock(const double      *const *state_vars,
+                                             const CHydroUnit  *const *pHRUs,
+                                             const int                 nHRUs,
+                                             const optStruct          &Options,
+                                             const time_struct        &tt,
+                                                   double      *const *rates) const
+{
+  for (int b=0;b<nHRUs;b++){
+    ApplyConstraints(state_vars[b],pHRUs[b],Options,tt,rates[b]);
+  }
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Adds conditional statement required for hydrological process to be applied
 ///
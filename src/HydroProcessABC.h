@@ -80,6 +80,7 @@ public:/*-------------------------------------------------------*/
   process_type         GetProcessType()       const;
 
   virtual int          GetNumLatConnections() const { return 0; }
+  virtual bool         IsThreadSafe()         const { return true; } ///< false if GetRatesOfChange() relies upon shared/static data, forcing serial HRU processing
 
   bool                 ShouldApply(const CHydroUnit*pHRU) const;
   //functions
@@ -109,6 +110,23 @@ public:/*-------------------------------------------------------*/
                                 const optStruct   &Options,
                                 const time_struct &tt,
                                       double      *rates) const=0;
+
+  //batched versions of the above for a block of HRUs (state_vars[b], pHRUs[b] and rates[b] for b=0..nHRUs-1)
+  //default implementations call scalar routines for each HRU; overridden by processes which benefit
+  //from hoisting method selection/index lookup out of the HRU loop
+  virtual void GetRatesOfChangeBlock(const double      *const *state_vars,
+                                     const CHydroUnit  *const *pHRUs,
+                                     const int                 nHRUs,
+                                     const optStruct          &Options,
+                                     const time_struct        &tt,
+                                           double      *const *rates) const;
+
+  virtual void ApplyConstraintsBlock(const double      *const *state_vars,
+                                     const CHydroUnit  *const *pHRUs,
+                                     const int                 nHRUs,
+                                     const optStruct          &Options,
+                                     const time_struct        &tt,
+                                           double      *const *rates) const;
 };
 
 ///////////////////////////////////////////////////////////////////
@@ -86,6 +86,9 @@ CHydroUnit::CHydroUnit(const CModelABC        *pMod,
   for (i=0;i<_pModel->GetNumStateVars();i++){
     _aStateVar[i]=0.0;
   }
+  _ppStateVar  =&_aStateVar; //replaced by view of model state matrix in BindStateStorage
+  _stateOffset =0;
+  _stateStride =1;
 
   ZeroOutForcings(_Forcings);
 
@@ -122,12 +125,13 @@ CHydroUnit::~CHydroUnit()
 *****************************************************************/
 //////////////////////////////////////////////////////////////////
 /// \brief Returns a pointer to the state variable array
+/// \remark array is only contiguous if the model uses HRU-major state storage; use GetStateVarValue() otherwise
 ///
 /// \return Double*pointer to the state variable array
 //
 double*    CHydroUnit::GetStateVarArray                 () const
 {
-  return _aStateVar;
+  return (*_ppStateVar)+_stateOffset;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -343,7 +347,26 @@ void    CHydroUnit::SetStateVarValue      (const int i, const double &val)
   ExitGracefullyIf((i<0) || (i>=_pModel->GetNumStateVars()),
                    "CHydroUnit SetStateVarValue::improper index",BAD_DATA);
 #endif
-  _aStateVar[i]=val;
+  (*_ppStateVar)[_stateOffset+i*_stateStride]=val;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Replaces HRU-owned state storage with view into model-wide state matrix
+/// \remark called once from CModel::Initialize; current state variable values are copied into new storage
+///
+/// \param ppStorage [in] address of pointer to current state storage block (pointer may change between time steps)
+/// \param offset [in] offset of this HRU's state variables within storage block
+/// \param stride [in] distance between consecutive state variables within storage block
+//
+void    CHydroUnit::BindStateStorage      (double *const *ppStorage, const int offset, const int stride)
+{
+  for (int i=0;i<_pModel->GetNumStateVars();i++){
+    (*ppStorage)[offset+i*stride]=GetStateVarValue(i);
+  }
+  delete [] _aStateVar; _aStateVar=NULL;
+  _ppStateVar =ppStorage;
+  _stateOffset=offset;
+  _stateStride=stride;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -719,7 +742,7 @@ double  CHydroUnit::GetTotalAlbedo(const bool subcanopy) const
   {
     if (_HRUType==HRU_STANDARD){
       int iTopSoil=_pModel->GetStateVarIndex(SOIL,0);
-      double soil_sat=max(min(_aStateVar[iTopSoil]/GetSoilCapacity(0),1.0),0.0);
+      double soil_sat=max(min(GetStateVarValue(iTopSoil)/GetSoilCapacity(0),1.0),0.0);
       land_albedo =(soil_sat    )*_pSoil[0]->albedo_wet    +(1.0-soil_sat    )*_pSoil[0]->albedo_dry;
     }
     else if (_HRUType==HRU_GLACIER){
@@ -34,7 +34,10 @@ private:/*------------------------------------------------------*/
   bool                    _res_linked;  ///> true if HRU is linked to Reservoir
 
   //Model State variables:
-  double                  *_aStateVar;  ///< Array of *current value* of state variable i with size CModel::nStateVars [mm] for water storage, permafrost depth, snow depth, [MJ/m^2] for energy storage
+  double                  *_aStateVar;  ///< Array of *current value* of state variable i with size CModel::nStateVars [mm] for water storage, permafrost depth, snow depth, [MJ/m^2] for energy storage (NULL once bound to model state matrix)
+  double *const          *_ppStateVar;  ///< address of state storage viewed by HRU (&_aStateVar, or current block of model state matrix)
+  int                    _stateOffset;  ///< offset of this HRU's state variables within viewed storage
+  int                    _stateStride;  ///< distance between consecutive state variables within viewed storage
 
   //Model Forcing functions:
   force_struct              _Forcings;  ///< *current values* of forcing functions for time step (precip, temp, etc.)
@@ -97,7 +100,7 @@ public:/*-------------------------------------------------------*/
   inline bool            IsLake          () const { return (_HRUType==HRU_LAKE);}
   bool                   IsLinkedToReservoir() const;
 
-  inline double          GetStateVarValue(const int i) const { return _aStateVar[i]; }
+  inline double          GetStateVarValue(const int i) const { return (*_ppStateVar)[_stateOffset+i*_stateStride]; }
   inline double          GetConcentration(const int i) const { return _pModel->GetConcentration(_global_k,i); }
   double*                GetStateVarArray() const;
 
@@ -150,6 +153,9 @@ public:/*-------------------------------------------------------*/
 
   //Manipulator functions (used in initialization)
   void          Initialize              (const int UTM_zone);
+  void          BindStateStorage        (double *const *ppStorage,
+                                         const int      offset,
+                                         const int      stride);
 
   //Manipulator functions (used in solution method)
   void          SetStateVarValue        (const int           i,
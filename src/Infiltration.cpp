@@ -626,6 +626,109 @@ void   CmvInfiltration::ApplyConstraints( const double     *storage,
   rates[0]=inf;
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief Returns rates of infiltration and runoff for a block of HRUs [mm/day]
+/// \details Method and state variable indices are resolved once per block; the HBV, rational,
+/// VIC/ARNO and 'all infiltrates' methods are evaluated in a tight HRU loop. Other methods
+/// (and non-standard HRUs) use GetRatesOfChange()
+///
+/// \param **state_vars [in] state variable arrays of HRUs in block
+/// \param **pHRUs [in] HRUs in block
+/// \param nHRUs [in] number of HRUs in block
+/// \param &Options [in] Global model options information
+/// \param &tt [in] Current model time
+/// \param **rates [out] infiltration (rates[b][0]) and runoff (rates[b][1]) for each HRU [mm/day]
+//
+void CmvInfiltration::GetRatesOfChangeBlock(const double      *const *state_vars,
+                                            const CHydroUnit  *const *pHRUs,
+                                            const int                 nHRUs,
+                                            const optStruct          &Options,
+                                            const time_struct        &tt,
+                                                  double      *const *rates) const
+{
+  if ((type!=INF_HBV) && (type!=INF_RATIONAL) && (type!=INF_VIC_ARNO) && (type!=INF_ALL_INFILTRATES))
+  {
+    CHydroProcessABC::GetRatesOfChangeBlock(state_vars,pHRUs,nHRUs,Options,tt,rates);
+    return;
+  }
+
+  const int iPond   =pModel->GetStateVarIndex(PONDED_WATER);
+  const int iTopSoil=pModel->GetStateVarIndex(SOIL,0);
+  double    rainthru,runoff,Fimp,sat;
+  const CHydroUnit *pHRU;
+
+  for (int b=0;b<nHRUs;b++)
+  {
+    pHRU=pHRUs[b];
+    if (pHRU->GetHRUType()!=HRU_STANDARD){
+      GetRatesOfChange(state_vars[b],pHRU,Options,tt,rates[b]); //Lakes, glaciers & rock
+      continue;
+    }
+    Fimp    =pHRU->GetSurfaceProps()->impermeable_frac;
+    rainthru=max(state_vars[b][iPond],0.0)/Options.timestep;//potential infiltration rate, mm/d
+
+    if      (type==INF_RATIONAL)
+    {
+      runoff=pHRU->GetSurfaceProps()->partition_coeff*rainthru;
+    }
+    else if (type==INF_ALL_INFILTRATES)
+    {
+      runoff=(Fimp)*rainthru+(1-Fimp)*0.0;
+    }
+    else if (type==INF_HBV)
+    {
+      sat   =max(min(state_vars[b][iTopSoil]/pHRU->GetSoilCapacity(0),1.0),0.0);
+      runoff=pow(sat,pHRU->GetSoilProps(0)->HBV_beta)*rainthru;
+      runoff=(Fimp)*rainthru+(1-Fimp)*runoff; //correct for impermeable surfaces
+    }
+    else //INF_VIC_ARNO
+    {
+      sat   =min(state_vars[b][iTopSoil]/pHRU->GetSoilCapacity(0),1.0);
+      runoff=(1.0 - pow(1.0-sat,pHRU->GetSoilProps(0)->VIC_b_exp))*rainthru;
+      runoff=(Fimp)*rainthru+(1-Fimp)*runoff; //correct for impermeable surfaces
+    }
+    rates[b][0]=rainthru-runoff;
+    rates[b][1]=runoff;
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Corrects rates of infiltration and runoff for a block of HRUs
+/// \details identical to ApplyConstraints(), applied to each HRU in block
+///
+/// \param **storage [in] state variable arrays of HRUs in block
+/// \param **pHRUs [in] HRUs in block
+/// \param nHRUs [in] number of HRUs in block
+/// \param &Options [in] Global model options information
+/// \param &tt [in] Current model time (unused)
+/// \param **rates [out] Corrected rates of infiltration and runoff for each HRU [mm/day]
+//
+void CmvInfiltration::ApplyConstraintsBlock(const double      *const *storage,
+                                            const CHydroUnit  *const *pHRUs,
+                                            const int                 nHRUs,
+                                            const optStruct          &Options,
+                                            const time_struct        & /*tt*/,
+                                                  double      *const *rates) const
+{
+  const int i0=iFrom[0];
+  const int i1=iTo  [0];
+  double max_stor,inf;
+  for (int b=0;b<nHRUs;b++)
+  {
+    if (pHRUs[b]->GetHRUType()!=HRU_STANDARD){continue;}//Lakes & glaciers
+
+    //cant remove more than is there (should never be an option)
+    rates[b][0]=threshMin(rates[b][0],storage[b][i0]/Options.timestep,0.0);
+
+    //reaching soil saturation level
+    max_stor=pHRUs[b]->GetStateVarMax(i1,storage[b],Options);
+    inf     =threshMin(rates[b][0],max(max_stor-storage[b][i1],0.0)/Options.timestep,0.0);
+
+    rates[b][1]+=(rates[b][0]-inf);
+    rates[b][0]=inf;
+  }
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Calculates runoff [mm/d] from rainfall using SCS curve number method
 /// \note totalrain5days is total rainfall in the last five days [mm]
@@ -98,6 +98,19 @@ public:/*-------------------------------------------------------*/
                         const optStruct   &Options,
                         const time_struct &tt,
                         double      *rates) const;
+  void GetRatesOfChangeBlock(const double      *const *state_vars,
+                             const CHydroUnit  *const *pHRUs,
+                             const int                 nHRUs,
+                             const optStruct          &Options,
+                             const time_struct        &tt,
+                                   double      *const *rates) const;
+  void ApplyConstraintsBlock(const double      *const *state_vars,
+                             const CHydroUnit  *const *pHRUs,
+                             const int                 nHRUs,
+                             const optStruct          &Options,
+                             const time_struct        &tt,
+                                   double      *const *rates) const;
+  bool IsThreadSafe() const { return (type!=INF_UBC); } //UBCWM RFS cheat passes b2 between HRUs via g_debug_vars
   void        GetParticipatingParamList   (string  *aP , class_type *aPC , int &nP) const;
   static void GetParticipatingStateVarList(infil_type btype,sv_type *aSV, int *aLev, int &nSV);
 };
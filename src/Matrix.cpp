@@ -3,6 +3,20 @@
 	Copyright (c) 2008-2022 the Raven Development Team
 	----------------------------------------------------------------*/
 #include "Matrix.h"
+
+#ifdef _RVLAPACK_
+// Fortran BLAS/LAPACK routines (column-major storage)
+extern "C" {
+	void dgemm_ (const char *transa,const char *transb,const int *m,const int *n,const int *k,const double *alpha,
+	             const double *a,const int *lda,const double *b,const int *ldb,const double *beta,double *c,const int *ldc);
+	void dsyrk_ (const char *uplo,const char *trans,const int *n,const int *k,const double *alpha,
+	             const double *a,const int *lda,const double *beta,double *c,const int *ldc);
+	void dpotrf_(const char *uplo,const int *n,double *a,const int *lda,int *info);
+	void dpotrs_(const char *uplo,const int *n,const int *nrhs,const double *a,const int *lda,double *b,const int *ldb,int *info);
+}
+#endif
+
+const int MAT_BLOCK_SIZE=64; ///< row/column block size of cache-blocked matrix kernels
 /************************************************************************
  MatMult:
 	Multiplies NxN square matrix and Nx1 vector A*x. Returns b
@@ -124,6 +138,239 @@ void DeleteMatrix(const int N,const int M,double** A) {
 	}
 	delete [] A; A=NULL;
 }
+/************************************************************************
+ AllocateContiguousMatrix:
+	allocates memory to NxM matrix A as a single row-major block (as
+	required by BLAS/LAPACK), initializes to all zeroes
+	must be deleted using DeleteContiguousMatrix
+-----------------------------------------------------------------------*/
+void AllocateContiguousMatrix(const int N,const int M,double**&A) {
+	A=NULL;
+	A=new double *[max(N,1)];
+	ExitGracefullyIf(A==NULL,"Matrix allocation (1)",OUT_OF_MEMORY);
+	A[0]=new double [max(N*M,1)];
+	ExitGracefullyIf(A[0]==NULL,"Matrix allocation",OUT_OF_MEMORY);
+	for(int i=0;i<N;i++) {
+		A[i]=A[0]+i*M;
+	}
+	for(int ij=0;ij<N*M;ij++) {
+		A[0][ij]=0.0;
+	}
+}
+/************************************************************************
+ DeleteContiguousMatrix:
+	deletes 2D matrix A created using AllocateContiguousMatrix
+-----------------------------------------------------------------------*/
+void DeleteContiguousMatrix(double** A) {
+	if(A==NULL) { return; }
+	delete [] A[0];
+	delete [] A;
+}
+#ifdef _RVLAPACK_
+/************************************************************************
+ GetLeadingDimension:
+	returns row stride of NxM matrix A if it is stored as a single
+	row-major block, or DOESNT_EXIST otherwise
+-----------------------------------------------------------------------*/
+static int GetLeadingDimension(Ironclad2DArray A,const int N,const int M)
+{
+	int ld=M;
+	if(N>1) { ld=(int)(A[1]-A[0]); }
+	if(ld<max(M,1)) { return DOESNT_EXIST; }
+	for(int i=2;i<N;i++) {
+		if(A[i]!=A[0]+i*ld) { return DOESNT_EXIST; }
+	}
+	return ld;
+}
+#endif
+/************************************************************************
+ GEMM:
+	General matrix multiply C=alpha*op(A)*op(B)+beta*C, where op(A) is
+	NxM, op(B) is MxP, and op(X) is X or its transpose
+	uses BLAS dgemm if available and all matrices are contiguous
+-----------------------------------------------------------------------*/
+void GEMM(Ironclad2DArray A,const bool transA,Ironclad2DArray B,const bool transB,
+					const int N,const int M,const int P,const double alpha,const double beta,Writeable2DArray C)
+{
+	if((N==0) || (P==0)) { return; }
+#ifdef _RVLAPACK_
+	int lda=GetLeadingDimension(A,(transA ? M : N),(transA ? N : M));
+	int ldb=GetLeadingDimension(B,(transB ? P : M),(transB ? M : P));
+	int ldc=GetLeadingDimension(C,N,P);
+	if((M>0) && (lda!=DOESNT_EXIST) && (ldb!=DOESNT_EXIST) && (ldc!=DOESNT_EXIST)) {
+		//row-major C=op(A)*op(B) is column-major C'=op(B)'*op(A)'
+		char ta=(transA ? 'T' : 'N');
+		char tb=(transB ? 'T' : 'N');
+		dgemm_(&tb,&ta,&P,&N,&M,&alpha,B[0],&ldb,A[0],&lda,&beta,C[0],&ldc);
+		return;
+	}
+#endif
+	int i,j,k,ii,jj,kk;
+	double a,sum;
+	for(i=0;i<N;i++) {
+		for(j=0;j<P;j++) {
+			if(beta==0.0) { C[i][j]=0.0; } else { C[i][j]*=beta; }
+		}
+	}
+	for(ii=0;ii<N;ii+=MAT_BLOCK_SIZE) {
+		int iend=min(ii+MAT_BLOCK_SIZE,N);
+		for(kk=0;kk<M;kk+=MAT_BLOCK_SIZE) {
+			int kend=min(kk+MAT_BLOCK_SIZE,M);
+			for(jj=0;jj<P;jj+=MAT_BLOCK_SIZE) {
+				int jend=min(jj+MAT_BLOCK_SIZE,P);
+				if(!transB) { //rows of B and C traversed contiguously
+					for(i=ii;i<iend;i++) {
+						for(k=kk;k<kend;k++) {
+							a=alpha*(transA ? A[k][i] : A[i][k]);
+							for(j=jj;j<jend;j++) { C[i][j]+=a*B[k][j]; }
+						}
+					}
+				}
+				else { //dot products of rows of op(A) and B
+					for(i=ii;i<iend;i++) {
+						for(j=jj;j<jend;j++) {
+							sum=0.0;
+							if(!transA) { for(k=kk;k<kend;k++) { sum+=A[i][k]*B[j][k]; } }
+							else        { for(k=kk;k<kend;k++) { sum+=A[k][i]*B[j][k]; } }
+							C[i][j]+=alpha*sum;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+/************************************************************************
+ SYRK:
+	Symmetric rank-k update C=alpha*op(A)*op(A)'+beta*C, where op(A) is
+	NxK (A if transA is false, otherwise A' with A stored as KxN)
+	both triangles of NxN matrix C are filled
+	uses BLAS dsyrk if available and all matrices are contiguous
+-----------------------------------------------------------------------*/
+void SYRK(Ironclad2DArray A,const bool transA,const int N,const int K,const double alpha,const double beta,Writeable2DArray C)
+{
+	int i,j,k,ii,jj,kk;
+	if(N==0) { return; }
+	bool done=false;
+#ifdef _RVLAPACK_
+	int lda=GetLeadingDimension(A,(transA ? K : N),(transA ? N : K));
+	int ldc=GetLeadingDimension(C,N,N);
+	if((K>0) && (lda!=DOESNT_EXIST) && (ldc!=DOESNT_EXIST)) {
+		//column-major view of A is A'; upper triangle of column-major C is lower triangle of row-major C
+		char uplo='U';
+		char ta=(transA ? 'N' : 'T');
+		dsyrk_(&uplo,&ta,&N,&K,&alpha,A[0],&lda,&beta,C[0],&ldc);
+		done=true;
+	}
+#endif
+	if(!done) {
+		for(i=0;i<N;i++) {
+			for(j=0;j<=i;j++) {
+				if(beta==0.0) { C[i][j]=0.0; } else { C[i][j]*=beta; }
+			}
+		}
+		double a,sum;
+		for(kk=0;kk<K;kk+=MAT_BLOCK_SIZE) {
+			int kend=min(kk+MAT_BLOCK_SIZE,K);
+			for(ii=0;ii<N;ii+=MAT_BLOCK_SIZE) {
+				int iend=min(ii+MAT_BLOCK_SIZE,N);
+				for(jj=0;jj<iend;jj+=MAT_BLOCK_SIZE) { //lower triangle only
+					int jend=min(jj+MAT_BLOCK_SIZE,N);
+					for(i=ii;i<iend;i++) {
+						int jmax=min(jend,i+1);
+						if(!transA) { //dot products of rows of A
+							for(j=jj;j<jmax;j++) {
+								sum=0.0;
+								for(k=kk;k<kend;k++) { sum+=A[i][k]*A[j][k]; }
+								C[i][j]+=alpha*sum;
+							}
+						}
+						else { //rank-1 updates from rows of A
+							for(k=kk;k<kend;k++) {
+								a=alpha*A[k][i];
+								for(j=jj;j<jmax;j++) { C[i][j]+=a*A[k][j]; }
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	for(i=0;i<N;i++) {
+		for(j=0;j<i;j++) { C[j][i]=C[i][j]; }
+	}
+}
+/************************************************************************
+ CholeskyFactor:
+	Factors symmetric positive definite NxN matrix A=L*L' in place;
+	L is stored in the lower triangle of A (upper triangle is unchanged)
+	Returns false if A is not positive definite (contents of A are then undefined)
+	uses LAPACK dpotrf if available and A is contiguous
+-----------------------------------------------------------------------*/
+bool CholeskyFactor(Writeable2DArray A,const int N)
+{
+	if(N==0) { return true; }
+#ifdef _RVLAPACK_
+	int lda=GetLeadingDimension(A,N,N);
+	if(lda!=DOESNT_EXIST) {
+		//upper triangle of column-major A is U=L', i.e., lower triangle of row-major A
+		char uplo='U';
+		int info;
+		dpotrf_(&uplo,&N,A[0],&lda,&info);
+		return (info==0);
+	}
+#endif
+	int i,j,k;
+	double sum;
+	for(j=0;j<N;j++) {
+		sum=A[j][j];
+		for(k=0;k<j;k++) { sum-=A[j][k]*A[j][k]; }
+		if(sum<=0.0) { return false; }
+		A[j][j]=sqrt(sum);
+		for(i=j+1;i<N;i++) {
+			sum=A[i][j];
+			for(k=0;k<j;k++) { sum-=A[i][k]*A[j][k]; }
+			A[i][j]=sum/A[j][j];
+		}
+	}
+	return true;
+}
+/************************************************************************
+ CholeskySolve:
+	Solves A*x=b for each of nRHS right hand sides, stored as the rows
+	of B [size: nRHS x N], given the Cholesky factor L of A from
+	CholeskyFactor(). Returns solutions x in place of the rows of B
+	uses LAPACK dpotrs if available and all matrices are contiguous
+-----------------------------------------------------------------------*/
+void CholeskySolve(Ironclad2DArray L,const int N,Writeable2DArray B,const int nRHS)
+{
+	if((N==0) || (nRHS==0)) { return; }
+#ifdef _RVLAPACK_
+	int lda=GetLeadingDimension(L,N,N);
+	int ldb=GetLeadingDimension(B,nRHS,N);
+	if((lda!=DOESNT_EXIST) && (ldb!=DOESNT_EXIST)) {
+		//rows of row-major B are columns of column-major B
+		char uplo='U';
+		int info;
+		dpotrs_(&uplo,&N,&nRHS,L[0],&lda,B[0],&ldb,&info);
+		return;
+	}
+#endif
+	int i,k;
+	double sum;
+	for(int r=0;r<nRHS;r++) {
+		double *x=B[r];
+		for(i=0;i<N;i++) { //forward substitution, L*y=b
+			sum=x[i];
+			for(k=0;k<i;k++) { sum-=L[i][k]*x[k]; }
+			x[i]=sum/L[i][i];
+		}
+		for(i=N-1;i>=0;i--) { //back substitution, L'*x=y
+			x[i]/=L[i][i];
+			for(k=0;k<i;k++) { x[k]-=L[i][k]*x[i]; }
+		}
+	}
+}
 inline double SIGN(const double& a,const double& b) {
 	return b>=0.0 ? (a>=0.0 ? a : -a): (a>=0.0 ? -a : a);
 }
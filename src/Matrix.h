@@ -51,6 +51,31 @@ void TransposeMat     (Ironclad2DArray  A,
 											 Writeable2DArray AT);
 void AllocateMatrix(const int N, const int M, double ** &A);
 void DeleteMatrix  (const int N, const int M, double ** A);
+void AllocateContiguousMatrix(const int N, const int M, double ** &A);
+void DeleteContiguousMatrix  (double ** A);
+void GEMM            (Ironclad2DArray  A,
+                      const bool       transA,
+                      Ironclad2DArray  B,
+                      const bool       transB,
+                      const int        N,
+                      const int        M,
+                      const int        P,
+                      const double     alpha,
+                      const double     beta,
+                      Writeable2DArray C);
+void SYRK            (Ironclad2DArray  A,
+                      const bool       transA,
+                      const int        N,
+                      const int        K,
+                      const double     alpha,
+                      const double     beta,
+                      Writeable2DArray C);
+bool CholeskyFactor  (Writeable2DArray A,
+                      const int        N);
+void CholeskySolve   (Ironclad2DArray  L,
+                      const int        N,
+                      Writeable2DArray B,
+                      const int        nRHS);
 bool						  SVD(Ironclad2DArray A,
 	                    Ironclad1DArray b,
 											Writeable1DArray x,
@@ -53,6 +53,7 @@ CModel::CModel(const int        nsoillayers,
 
   _aSubBasinOrder =NULL; _maxSubBasinOrder=0;
   _aOrderedSBind  =NULL;
+  _aRoutingLevelStart=NULL;
   _aDownstreamInds=NULL;
 
   _aDAscale       =NULL; //Initialized in InitializeDataAssimilation
@@ -140,6 +141,14 @@ CModel::CModel(const int        nsoillayers,
 
   _pEnsemble = NULL;
   _pStateVar = NULL;
+
+  _nThreads  = 1; //Initialized in Initialize
+  _nHRUBlock = 1;
+  _nRoutingThreads = 1;
+  _pSolverWS = NULL;
+  _pStateMatrix = NULL;
+  _pExecPlan = NULL;
+  _pTaskGraph = NULL;
 }
 
 /////////////////////////////////////////////////////////////////
@@ -204,6 +213,7 @@ CModel::~CModel()
   delete [] _aStateVarLayer; _aStateVarLayer=NULL;
   delete [] _aSubBasinOrder; _aSubBasinOrder=NULL;
   delete [] _aOrderedSBind;  _aOrderedSBind=NULL;
+  delete [] _aRoutingLevelStart; _aRoutingLevelStart=NULL;
   delete [] _aDownstreamInds;_aDownstreamInds=NULL;
   delete [] _aOutputTimes;   _aOutputTimes=NULL;
   delete [] _aObsIndex;      _aObsIndex=NULL;
@@ -227,6 +237,10 @@ CModel::~CModel()
   delete _pGWModel;
   delete _pStateVar;
   delete _pDO;
+  delete _pSolverWS;
+  delete _pStateMatrix;
+  delete _pExecPlan;
+  delete _pTaskGraph;
 
   delete [] _PETBlends_type;
   delete [] _PETBlends_wts;
@@ -410,7 +424,7 @@ CHydroUnit *CModel::GetHydroUnit(const int k) const
 //
 CHydroUnit *CModel::GetHRUByID(const long long int HRUID) const
 {
-  static int last_k=0;
+  static thread_local int last_k=0;   //per-thread search hint
   //smart find
   int k;
   for (int i=0;i<_nHydroUnits;i++){
@@ -506,7 +520,7 @@ int         CModel::GetDownstreamBasin(const int p) const
 //
 CSubBasin  *CModel::GetSubBasinByID(const long SBID) const
 {
-  static int last_p=0;
+  static thread_local int last_p=0;   //per-thread search hint
   int p;
   if (SBID < 0) { return NULL; }
   //smart find
@@ -525,7 +539,7 @@ CSubBasin  *CModel::GetSubBasinByID(const long SBID) const
 //
 int         CModel::GetSubBasinIndex(const long SBID) const
 {
-  static int last_p = 0;
+  static thread_local int last_p = 0; //per-thread search hint
   int p;
   if (SBID<0){return DOESNT_EXIST;}
   //smart find
@@ -685,6 +699,46 @@ int         CModel::GetNumConnections (const int j) const
 /// \brief Returns number of forcing perturbations in model
 //
 int         CModel::GetNumForcingPerturbations() const {return _nPerturbations;}
+//////////////////////////////////////////////////////////////////
+/// \brief Returns number of threads used to process HRUs in parallel within the solver
+/// \return number of threads (1 if HRUs are processed serially)
+//
+int         CModel::GetNumThreads() const {return _nThreads;}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns number of HRUs passed together to batched process calculations within the solver
+/// \return block size (1 if HRUs must be processed individually, e.g., with local parameter overrides)
+//
+int         CModel::GetHRUBlockSize() const {return _nHRUBlock;}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns number of threads used to route independent subbasins in parallel within the solver
+/// \return number of threads (1 if subbasins are routed serially)
+//
+int         CModel::GetNumRoutingThreads() const {return _nRoutingThreads;}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns number of routing levels
+/// \details subbasins within a routing level (i.e., of the same order) do not drain into one another, and may be routed simultaneously
+/// \return number of routing levels (maximum subbasin order+1)
+//
+int         CModel::GetNumRoutingLevels() const {return _maxSubBasinOrder+1;}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns ordered subbasin index of first subbasin in routing level lev
+/// \details level lev includes ordered subbasins pp=GetRoutingLevelStart(lev) to GetRoutingLevelStart(lev+1)-1;
+/// levels are ordered upstream (lev=0, furthest leaves) to downstream (trunk)
+///
+/// \param lev [in] routing level index (>=0, <=number of routing levels)
+/// \return ordered subbasin index (pp) of first subbasin in level
+//
+int         CModel::GetRoutingLevelStart(const int lev) const
+{
+#ifdef _STRICTCHECK_
+  ExitGracefullyIf((lev<0) || (lev>_maxSubBasinOrder+1),"CModel::GetRoutingLevelStart: invalid level",RUNTIME_ERR);
+#endif
+  return _aRoutingLevelStart[lev];
+}
 
 //////////////////////////////////////////////////////////////////
 /// \brief Returns state variable type corresponding to passed state variable array index
@@ -978,6 +1032,30 @@ CEnsemble  *CModel::GetEnsemble() const { return _pEnsemble; }
 //
 CDemandOptimizer  *CModel::GetDemandOptimizer() const { return _pDO; }
 
+//////////////////////////////////////////////////////////////////
+/// \brief Returns solver working memory
+/// \return pointer to solver workspace (NULL if model not yet initialized)
+//
+CSolverWorkspace *CModel::GetSolverWorkspace() const { return _pSolverWS; }
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns model-wide state variable storage
+/// \return pointer to state matrix (NULL if model not yet initialized)
+//
+CStateMatrix     *CModel::GetStateMatrix() const { return _pStateMatrix; }
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns precompiled sequence of processes applied by solver
+/// \return pointer to execution plan (NULL if model not yet initialized)
+//
+const CExecutionPlan *CModel::GetExecutionPlan() const { return _pExecPlan; }
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns dependency graph of solver tasks
+/// \return pointer to task graph (NULL unless task graph scheduling is used)
+//
+CTaskGraph       *CModel::GetTaskGraph() const { return _pTaskGraph; }
+
 /*****************************************************************
    Watershed Diagnostic Functions
     -aggregate data from subbasins and HRUs
@@ -1028,7 +1106,7 @@ double CModel::GetAverageSnowfall() const
 //
 force_struct CModel::GetAverageForcings() const
 {
-  static force_struct Fave;
+  static thread_local force_struct Fave;
   const force_struct *pF_hru;
   double area_wt;
   ZeroOutForcings(Fave);
@@ -1626,6 +1704,17 @@ void CModel::SetEnsembleMode(CEnsemble *pEnsemble) {
   _pEnsemble=pEnsemble;
 }
 //////////////////////////////////////////////////////////////////
+/// \brief Sets number of threads used to process HRUs and route subbasins in solver
+/// \remark Used to temporarily simulate serially; values should not exceed those determined in Initialize()
+///
+/// \param nThreads [in] number of threads used to process HRUs
+/// \param nRoutingThreads [in] number of threads used to route subbasins of the same routing level
+//
+void CModel::SetNumThreads(const int nThreads, const int nRoutingThreads) {
+  _nThreads       =max(nThreads,1);
+  _nRoutingThreads=max(nRoutingThreads,1);
+}
+//////////////////////////////////////////////////////////////////
 /// \brief Sets demand optimizer
 ///
 /// \param *pDO [in] (assumed valid) pointer to optimizer instance
@@ -2342,6 +2431,98 @@ void CModel::CountOneMoreLatFlowProcess() {
   this->_nLatFlowProcesses++;
 }
 
+/*****************************************************************
+   In-memory state snapshots
+------------------------------------------------------------------
+   binary (double array) equivalent of the solution file: HRU state
+   variables, subbasin routing histories (plus the local, irrigation
+   and diversion flows of the previous time step, which the solution
+   file omits), reservoir states and constituent routing masses, in
+   that order. The first entry stores
+   the snapshot size, used to check that a snapshot belongs to a model
+   with the same structure
+*****************************************************************/
+
+//////////////////////////////////////////////////////////////////
+/// \brief returns number of values in an in-memory model state snapshot
+/// \return required size of snapshot array passed to SaveStateSnapshot()
+//
+int CModel::GetStateSnapshotSize() const
+{
+  int size=1;
+  size+=_nHydroUnits*_nStateVars;
+  for (int p=0;p<_nSubBasins;p++){
+    size+=_pSubBasins[p]->GetSnapshotSize();
+  }
+  size+=_pTransModel->GetSnapshotSize();
+  return size;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief copies all model state variables (as would be written to solution file) to in-memory snapshot
+/// \details faster, lossless alternative to WriteMajorOutput() followed by ParseInitialConditions()
+/// \param *aSnapshot [out] snapshot array [size: GetStateSnapshotSize()]
+//
+void CModel::SaveStateSnapshot(double *aSnapshot) const
+{
+  int ii=0;
+  aSnapshot[ii++]=(double)(GetStateSnapshotSize());
+  for (int k=0;k<_nHydroUnits;k++){
+    for (int i=0;i<_nStateVars;i++){
+      aSnapshot[ii++]=_pHydroUnits[k]->GetStateVarValue(i);
+    }
+  }
+  for (int p=0;p<_nSubBasins;p++){
+    _pSubBasins[p]->SaveToSnapshot(aSnapshot,ii);
+  }
+  _pTransModel->SaveToSnapshot(aSnapshot,ii);
+}
+//////////////////////////////////////////////////////////////////
+/// \brief restores all model state variables from in-memory snapshot written by SaveStateSnapshot()
+/// \note as with ParseInitialConditions(), CalculateInitialWaterStorage() should be called afterward if this is the start of a simulation
+/// \param *aSnapshot [in] snapshot array [size: GetStateSnapshotSize()]
+//
+void CModel::RestoreStateSnapshot(const double *aSnapshot)
+{
+  int ii=0;
+  ExitGracefullyIf((int)(aSnapshot[ii++])!=GetStateSnapshotSize(),
+                   "CModel::RestoreStateSnapshot: snapshot is inconsistent with model structure",RUNTIME_ERR);
+  for (int k=0;k<_nHydroUnits;k++){
+    for (int i=0;i<_nStateVars;i++){
+      _pHydroUnits[k]->SetStateVarValue(i,aSnapshot[ii++]);
+    }
+  }
+  for (int p=0;p<_nSubBasins;p++){
+    _pSubBasins[p]->RestoreFromSnapshot(aSnapshot,ii);
+  }
+  _pTransModel->RestoreFromSnapshot(aSnapshot,ii);
+}
+//////////////////////////////////////////////////////////////////
+/// \brief zeroes cumulative precipitation, evaporation, and glacier loss storage (and associated constituent masses)
+/// and the cumulative watershed inputs and outputs used in mass balance reporting
+/// \details equivalent to the treatment of these state variables in ParseInitialConditions(), in which their
+/// initial conditions are ignored; used when a restored snapshot is the start of a new simulation period
+//
+void CModel::ClearCumulativeStorage()
+{
+  sv_type typ;
+  _CumulInput =0.0;
+  _CumulOutput=0.0;
+  for (int i=0;i<_nStateVars;i++)
+  {
+    typ=_aStateVarType[i];
+    if (typ==CONSTITUENT){
+      int iw=_pTransModel->GetWaterStorIndexFromLayer(_aStateVarLayer[i]);
+      if (iw==DOESNT_EXIST){continue;}
+      typ=_aStateVarType[iw];
+    }
+    if ((typ==ATMOS_PRECIP) || (typ==ATMOSPHERE) || (typ==GLACIER_ICE)){
+      for (int k=0;k<_nHydroUnits;k++){
+        _pHydroUnits[k]->SetStateVarValue(i,0.0);
+      }
+    }
+  }
+}
+
 /*****************************************************************
    Routines called repeatedly during model simulation
 ------------------------------------------------------------------
@@ -2492,6 +2673,7 @@ void CModel::UpdateTransientParams(const optStruct   &Options,
 
   //--update land use and HRU types-----------------------------------------------
   int k;
+  bool changed=false;
   for (int j = 0; j<_nClassChanges; j++)
   {
     if( ((_pClassChanges[j]->modeltime > tt.model_time - TIME_CORRECTION) &&
@@ -2525,10 +2707,11 @@ void CModel::UpdateTransientParams(const optStruct   &Options,
         {
           _aShouldApplyProcess[jj][k] = _pProcesses[jj]->ShouldApply(_pHydroUnits[k]);
         }
+        changed=true;
       }
     }
   }
-
+  if (changed){RefreshExecutionPlan();}
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Determines parameter class (e.g., CLASS_GLOBAL or CLASS_SOIL) from parameter name and class name through slow search
@@ -2741,9 +2924,28 @@ void CModel::PrepareForcingPerturbation(const optStruct &Options, const time_str
     bool   start_of_day = ((nn==0) || tt.day_changed); //nn==0 corresponds to midnight
 
     if (start_of_day)  { //get all random perturbation samples for the day
-      for (int n=0;n<nStepsPerDay;n++){
-        _pPerturbations[i]->eps[n]=SampleFromDistribution(_pPerturbations[i]->distribution,_pPerturbations[i]->distpar);
-      }
+      rand_key key;
+      key.seed  =_pEnsemble->GetRandomSeed();
+      key.stream=RAND_FORCING_PERTURB;
+      key.member=max(g_current_e,0);
+      key.index =i;
+      key.step  =(int)(rvn_round(tt.model_time/Options.timestep));
+      SampleFromDistribution(_pPerturbations[i]->distribution,_pPerturbations[i]->distpar,key,_pPerturbations[i]->eps,nStepsPerDay);
+    }
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief resets all forcing perturbations to no adjustment (e.g., for unperturbed forecasts)
+/// \param &Options [in] Global model options information
+//
+void CModel::ClearForcingPerturbation(const optStruct &Options)
+{
+  int nStepsPerDay = (int)(rvn_round(1.0/Options.timestep));
+  for(int i=0;i<_nPerturbations;i++)
+  {
+    for (int n=0;n<nStepsPerDay;n++){
+      if (_pPerturbations[i]->adj_type==ADJ_MULTIPLICATIVE){_pPerturbations[i]->eps[n]=1.0;}
+      else                                                 {_pPerturbations[i]->eps[n]=0.0;}
     }
   }
 }
@@ -2973,6 +3175,61 @@ bool CModel::ApplyProcess ( const int          j,                    //process i
 
   return true;
 }
+
+//////////////////////////////////////////////////////////////////
+/// \brief Apply hydrological process j to a contiguous block of HRUs
+/// \details Equivalent to calling ApplyProcess() for those HRUs k0 to k0+nBlock-1 flagged in mask, but rates are
+/// calculated (through a batched virtual call) once per block rather than once per HRU. Process connectivity and
+/// applicability are obtained from the execution plan (see CModel::CompileExecutionPlan)
+///
+/// \param j        [in] Integer process indentifier
+/// \param k0       [in] global index of first HRU in block
+/// \param nBlock   [in] number of HRUs in block (<=MAX_HRU_BLOCK)
+/// \param mask     [in] bitmask of HRUs in block to which process applies (bit b set for HRU k0+b)
+/// \param **state_vars [in] Array of state variable arrays for HRUs in block (size: [nBlock][nStateVars])
+/// \param &Options [in] Global model options information
+/// \param &tt      [in] Time structure
+/// \param **rates_of_change [out] rates for each HRU in block (size: [nBlock][nConnections]) (only calculated for HRUs in mask)
+//
+void CModel::ApplyProcessBlock ( const int          j,
+                                 const int          k0,
+                                 const int          nBlock,
+                                 const unsigned int mask,
+                                 const double* const* state_vars,
+                                 const optStruct   &Options,
+                                 const time_struct &tt,
+                                       double* const* rates_of_change) const
+{
+#ifdef _STRICTCHECK_
+  ExitGracefullyIf((j<0) && (j>=_nProcesses),"CModel ApplyProcessBlock::improper index",BAD_DATA);
+  ExitGracefullyIf(nBlock>MAX_HRU_BLOCK,"CModel ApplyProcessBlock::block too large",RUNTIME_ERR);
+#endif
+  const double     *aSV  [MAX_HRU_BLOCK]; //subset of block to which process applies
+  const CHydroUnit *aHRU [MAX_HRU_BLOCK];
+  double           *aRate[MAX_HRU_BLOCK];
+  int               nApply=0;
+
+  CHydroProcessABC *pProc=_pProcesses[j];
+
+  int nConnections=_pExecPlan->GetNumConnections(j);
+  for (int b=0;b<nBlock;b++)
+  {
+    if (mask & (1u<<b)){
+      for (int q=0;q<nConnections;q++){rates_of_change[b][q]=0.0;}
+      aSV  [nApply]=state_vars[b];
+      aHRU [nApply]=_pHydroUnits[k0+b];
+      aRate[nApply]=rates_of_change[b];
+      nApply++;
+    }
+  }
+  if (nApply==0){return;}
+
+  pProc->GetRatesOfChangeBlock(aSV,aHRU,nApply,Options,tt,aRate);
+
+  //Apply constraints
+  //------------------------------------------------------------------------
+  pProc->ApplyConstraintsBlock(aSV,aHRU,nApply,Options,tt,aRate);
+}
 //////////////////////////////////////////////////////////////////
 /// \brief Apply lateral exchange hydrological process to model
 /// \details Method returns rate of mass/energy transfers rates_of_change [mm/d, mg/m2/d, or MJ/m2/d] from a set
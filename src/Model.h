@@ -31,6 +31,10 @@
 #include "ChannelXSect.h"
 #include "Convolution.h"
 #include "DemandOptimization.h"
+#include "SolverWorkspace.h"
+#include "StateMatrix.h"
+#include "ExecutionPlan.h"
+#include "TaskGraph.h"
 
 class CHydroProcessABC;
 class CGauge;
@@ -73,6 +77,7 @@ private:/*------------------------------------------------------*/
   int          *_aSubBasinOrder;  ///< stores order of subbasin for routing [size:_nSubBasins] (may be relegated to local variable in InitializeRoutingNetwork)
   int         _maxSubBasinOrder;  ///< stores maximum subasin order for routing (may be relegated to local variable in InitializeRoutingNetwork)
   int           *_aOrderedSBind;  ///< stores list of subbasin indices ordered upstream to downstream [size:_nSubBasins]
+  int      *_aRoutingLevelStart;  ///< index in _aOrderedSBind of first subbasin in each routing level (subbasins of same order) [size:_maxSubBasinOrder+2]
   int         *_aDownstreamInds;  ///< stores list of downstream indices of basins (for speed) [size:_nSubBasins]
 
   int               _nStateVars;  ///< number of state variables: water and energy storage units, snow density, etc.
@@ -201,6 +206,14 @@ private:/*------------------------------------------------------*/
   CStateVariable    *_pStateVar;           ///< pointer to state variable information object
   int                _nLatFlowProcesses;   ///< number of lateral flow processes
 
+  int                _nThreads;            ///< number of threads used to process HRUs in solver (1 if serial)
+  int                _nHRUBlock;           ///< number of HRUs passed together to batched process calculations in solver (1 if HRUs must be processed individually)
+  int                _nRoutingThreads;     ///< number of threads used to route subbasins of the same routing level in solver (1 if serial)
+  CSolverWorkspace  *_pSolverWS;           ///< pointer to solver working memory (NULL prior to initialization)
+  CStateMatrix      *_pStateMatrix;        ///< pointer to contiguous storage of all HRU state variables (NULL prior to initialization)
+  CExecutionPlan    *_pExecPlan;           ///< pointer to precompiled sequence of processes applied by solver (NULL prior to initialization)
+  CTaskGraph        *_pTaskGraph;          ///< pointer to dependency graph of solver tasks (NULL unless task graph scheduling is used)
+
   //initialization subroutines:
   void           GenerateGaugeWeights (double **&aWts, const forcing_type forcing, const optStruct 	 &Options);
   void       InitializeRoutingNetwork ();
@@ -214,6 +227,12 @@ private:/*------------------------------------------------------*/
   void         WriteNetcdfMinorOutput (const optStruct   &Options,
                                        const time_struct &tt);
   void    InitializeParameterOverrides();
+  void           CompileExecutionPlan (const optStruct   &Options);
+  void           RefreshExecutionPlan ();
+  void           BuildTaskGraph       (const optStruct   &Options);
+  void           GetObjFuncTarget     (long calib_SBID, diag_type calib_Obj, const string calib_period,
+                                       int &ii, int &jj, double &starttime, double &endtime,
+                                       comparison &compare, double &thresh) const;
 
   //private routines used during simulation:
   force_struct      GetAverageForcings() const;
@@ -412,6 +431,11 @@ public:/*-------------------------------------------------------*/
   process_type      GetProcessType                    (const int j ) const;
   int               GetNumConnections                 (const int j ) const;
   int               GetNumForcingPerturbations        () const;
+  int               GetNumThreads                     () const;
+  int               GetHRUBlockSize                   () const;
+  int               GetNumRoutingThreads              () const;
+  int               GetNumRoutingLevels               () const;
+  int               GetRoutingLevelStart              (const int lev) const;
   double            GetAveragePrecip                  () const;
   double            GetAverageSnowfall                () const;
   int               GetOrderedSubBasinIndex           (const int pp) const;
@@ -433,12 +457,17 @@ public:/*-------------------------------------------------------*/
   const CTimeSeriesABC* GetSimulatedTS                (const int i) const;
 
   double               GetObjFuncVal                  (long calib_SBID,diag_type calib_Obj, const string calib_period) const;
+  CDiagAccumulator    *CreateObjFuncAccumulator       (long calib_SBID,diag_type calib_Obj, const string calib_period) const;
 
   const optStruct     *GetOptStruct                   () const;
   CTransportModel     *GetTransportModel              () const;
   CGroundwaterModel   *GetGroundwaterModel            () const;
   CEnsemble           *GetEnsemble                    () const;
   CDemandOptimizer    *GetDemandOptimizer             () const;
+  CSolverWorkspace    *GetSolverWorkspace             () const;
+  CStateMatrix        *GetStateMatrix                 () const;
+  const CExecutionPlan *GetExecutionPlan              () const;
+  CTaskGraph          *GetTaskGraph                   () const;
 
   void              GetParticipatingParamList         (string *aP,
                                                        class_type *aPC,
@@ -480,6 +509,8 @@ public:/*-------------------------------------------------------*/
                                      const int                lev               );//TMP?
   void    SetOutputGroup            (const CHRUGroup         *pOut              );
   void    SetNumSnowLayers          (const int                nLayers           );
+  void    SetNumThreads             (const int                nThreads,
+                                     const int                nRoutingThreads   );
 
   void    OverrideStreamflow        (const long SBID);
   void    SetEnsembleMode           (CEnsemble *pEnsemble);
@@ -527,6 +558,14 @@ public:/*-------------------------------------------------------*/
                                                 int         *iTo,
                                                 int         &nConnections,
                                                 double      *rates_of_change) const;
+  void        ApplyProcessBlock          (const int          j,
+                                          const int          k0,
+                                          const int          nBlock,
+                                          const unsigned int mask,
+                                          const double* const* state_vars,
+                                          const optStruct   &Options,
+                                          const time_struct &tt,
+                                                double* const* rates_of_change) const;
   bool        ApplyLateralProcess        (const int          j,
                                           const double* const* state_vars,
                                           const optStruct   &Options,
@@ -541,6 +580,9 @@ public:/*-------------------------------------------------------*/
                                           const optStruct &Options, const time_struct &tt);
   void         PrepareAssimilation       (const optStruct &Options, const time_struct &tt);
   void         PrepareForcingPerturbation(const optStruct &Options, const time_struct &tt);
+  void         ClearForcingPerturbation  (const optStruct &Options);
+  void         ExpireForcingGridChunks   ();
+  void         FinishForcingGridReads    ();
   void         ApplyForcingPerturbation  (const forcing_type f, force_struct &F, const int k, const optStruct& Options, const time_struct& tt);
 
   //water/energy/mass balance routines
@@ -553,6 +595,12 @@ public:/*-------------------------------------------------------*/
   void        IncrementCumulInput     (const optStruct &Options, const time_struct &tt);
   void        IncrementCumOutflow     (const optStruct &Options, const time_struct &tt);
 
+  //in-memory state snapshots
+  int         GetStateSnapshotSize    () const;
+  void        SaveStateSnapshot       (double *aSnapshot) const;
+  void        RestoreStateSnapshot    (const double *aSnapshot);
+  void        ClearCumulativeStorage  ();
+
   //output routines
   void        WriteMinorOutput        (const optStruct &Options, const time_struct &tt);
   void        WriteSimpleOutput       (const optStruct &Options, const time_struct &tt);
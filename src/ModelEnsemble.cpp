@@ -7,25 +7,88 @@ Copyright (c) 2008-2023 the Raven Development Team
 //see http://anadoxin.org/blog/c-shooting-yourself-in-the-foot-4.html
 
 bool ParseInitialConditions(CModel *&pModel,const optStruct &Options);
+bool ParseTimeSeriesFile   (CModel *&pModel,const optStruct &Options);
 
+/*****************************************************************
+ Philox4x32-10 counter-based random number generator
+------------------------------------------------------------------
+ Salmon, J.K., M.A. Moraes, R.O. Dror, and D.E. Shaw, Parallel random
+ numbers: as easy as 1, 2, 3, Proc. Int. Conf. for High Performance
+ Computing, Networking, Storage and Analysis (SC11), 2011.
+ Encrypts 128-bit counter ctr with 64-bit key in place; each distinct
+ (counter,key) pair gives an independent 128-bit random block.
+*****************************************************************/
+static inline void Philox4x32(unsigned int ctr[4],unsigned int k0,unsigned int k1)
+{
+  const unsigned long long M0=0xD2511F53ULL;
+  const unsigned long long M1=0xCD9E8D57ULL;
+  unsigned long long p0,p1;
+  unsigned int c0,c2;
+  for(int r=0;r<10;r++)
+  {
+    p0=M0*ctr[0];
+    p1=M1*ctr[2];
+    c0=(unsigned int)(p1>>32)^ctr[1]^k0;
+    c2=(unsigned int)(p0>>32)^ctr[3]^k1;
+    ctr[1]=(unsigned int)(p1);
+    ctr[3]=(unsigned int)(p0);
+    ctr[0]=c0;
+    ctr[2]=c2;
+    k0+=0x9E3779B9U;
+    k1+=0xBB67AE85U;
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief returns two independent uniform random variables on (0,1) for sample j of random sequence
+/// \param &key [in] identifies random sequence
+/// \param j [in] sample index
+/// \param attempt [in] rejection sampling attempt (0 unless sampler requires more than 2 uniform variates per sample)
+/// \param &u1 [out] first uniform variate, 0<u1<1
+/// \param &u2 [out] second uniform variate, 0<u2<1
+//
+static inline void UniformPair(const rand_key &key,const int j,const int attempt,double &u1,double &u2)
+{
+  const double TWO_POW_M53=1.0/9007199254740992.0;
+  unsigned int ctr[4];
+  ctr[0]=(unsigned int)(j);
+  ctr[1]=(unsigned int)(key.index);
+  ctr[2]=(unsigned int)(key.step);
+  ctr[3]=(unsigned int)(key.member);
+  Philox4x32(ctr,key.seed,(unsigned int)(key.stream)+((unsigned int)(attempt)<<8));
+
+  //53 random bits per variate, offset by half a bit so that 0 and 1 are excluded
+  unsigned long long a=((((unsigned long long)(ctr[0]))<<32)|ctr[1])>>11;
+  unsigned long long b=((((unsigned long long)(ctr[2]))<<32)|ctr[3])>>11;
+  u1=((double)(a)+0.5)*TWO_POW_M53;
+  u2=((double)(b)+0.5)*TWO_POW_M53;
+}
 //////////////////////////////////////////////////////////////////
-/// \brief returns uniformly distributed random variable between 0 and 1
-/// \return uniformly distributed random variable between 0 and 1
+/// \brief generates samples 0 to n-1 of uniformly distributed random sequence between 0 and 1
+/// \param &key [in] identifies random sequence
+/// \param *u [out] array of uniform random variates [size: n]
+/// \param n [in] number of samples
 //
-double UniformRandom()
+void RandomUniform(const rand_key &key,double *u,const int n)
 {
-  return (double)(rand())/RAND_MAX;
+  double u2;
+  for(int j=0;j<n;j++) {
+    UniformPair(key,j,0,u[j],u2);
+  }
 }
 //////////////////////////////////////////////////////////////////
-/// \brief returns normally distributed random variable with mean of 0, variance=1
+/// \brief generates samples 0 to n-1 of normally distributed random sequence with mean of 0, variance=1
 /// \notes uses Box-Muller transform
-/// \return normally distributed random variable with mean of 0, variance=1
+/// \param &key [in] identifies random sequence
+/// \param *z [out] array of standard normal random variates [size: n]
+/// \param n [in] number of samples
 //
-double GaussRandom()
+static void RandomGauss(const rand_key &key,double *z,const int n)
 {
-  double u1=(double)(rand())/RAND_MAX;
-  double u2=(double)(rand())/RAND_MAX;
-  return sqrt(-2.0*log(u1))*cos(2.0*PI*u2);
+  double u1,u2;
+  for(int j=0;j<n;j++) {
+    UniformPair(key,j,0,u1,u2);
+    z[j]=sqrt(-2.0*log(u1))*cos(2.0*PI*u2);
+  }
 }
 
 //////////////////////////////////////////////////////////////////
@@ -59,6 +122,8 @@ CEnsemble::CEnsemble(const int num_members,const optStruct &Options)
   }
 
   _disable_output=false;
+  _nParallel=1;
+  _rand_seed=0;
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Ensemble Default Destructor
@@ -91,12 +156,38 @@ double CEnsemble::GetStartTime(const int e) const {
   return 0.0;
 }
 //////////////////////////////////////////////////////////////////
+/// \brief Accessor - gets random seed used to key all random sequences (see rand_key)
+/// \return random seed
+//
+unsigned int CEnsemble::GetRandomSeed() const {
+  return _rand_seed;
+}
+//////////////////////////////////////////////////////////////////
 /// \brief returns true if output is to be disabled (for a subset of time or ensemble members, usually)
 /// \return true if output is to be disabled
 //
 bool   CEnsemble::DontWriteOutput() const {
   return _disable_output;
 }
+//////////////////////////////////////////////////////////////////
+/// \brief returns maximum number of members to be run simultaneously in separate worker processes
+/// \return number of parallel members (1 if members are run one at a time)
+//
+int    CEnsemble::GetNumParallelMembers() const {
+  return _nParallel;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief returns true if no two members write output to the same files
+/// \return true if each member has a unique combination of output directory and run name
+//
+bool   CEnsemble::HasDistinctMemberOutput() const {
+  for(int e=0;e<_nMembers;e++){
+    for(int ee=0;ee<e;ee++){
+      if((_aOutputDirs[e]==_aOutputDirs[ee]) && (_aRunNames[e]==_aRunNames[ee])){return false;}
+    }
+  }
+  return true;
+}
 
 
 //Manipulator Functions
@@ -106,7 +197,7 @@ bool   CEnsemble::DontWriteOutput() const {
 //
 void CEnsemble::SetRandomSeed(const unsigned int seed)
 {
-  srand(seed);
+  _rand_seed=seed;
 }
 //////////////////////////////////////////////////////////////////
 /// \brief sets output directory for ensemble member output
@@ -146,6 +237,24 @@ void CEnsemble::SetSolutionFiles(const string SolFilesString)
   }
 }
 //////////////////////////////////////////////////////////////////
+/// \brief sets maximum number of members to be run simultaneously in separate worker processes
+/// \param nParallel [in] number of parallel members (>=1)
+//
+void CEnsemble::SetNumParallelMembers(const int nParallel)
+{
+  _nParallel=max(nParallel,1);
+}
+//////////////////////////////////////////////////////////////////
+/// \brief sets output directory and run name of ensemble member e
+/// \param &Options [out] Global model options information
+/// \param e [in] ensemble member index
+//
+void CEnsemble::SetMemberOutput(optStruct &Options,const int e) const
+{
+  Options.output_dir=_aOutputDirs[e];
+  Options.run_name  =_aRunNames[e];
+}
+//////////////////////////////////////////////////////////////////
 /// \brief initializes ensemble
 /// \param &Options [out] Global model options information
 //
@@ -182,6 +291,7 @@ CMonteCarloEnsemble::CMonteCarloEnsemble(const int num_members,const optStruct &
   _type=ENSEMBLE_MONTECARLO;
   _nParamDists=0;
   _pParamDists=NULL;
+  _aParamValues=NULL;
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Monte Carlo Ensemble Destrucutor
@@ -192,6 +302,10 @@ CMonteCarloEnsemble::~CMonteCarloEnsemble()
     delete _pParamDists[i];
   }
   delete [] _pParamDists; _nParamDists=0;
+  if (_aParamValues!=NULL){
+    for(int e=0;e<_nMembers;e++) {delete [] _aParamValues[e];}
+    delete [] _aParamValues;
+  }
 }
 //////////////////////////////////////////////////////////////////
 /// \brief Adds parameter distribution to MC setup
@@ -220,6 +334,29 @@ void CMonteCarloEnsemble::Initialize(const CModel* pModel,const optStruct &Optio
   MCOUT<<"eID,";
   for (int i=0;i<_nParamDists;i++){MCOUT<<_pParamDists[i]->param_name+" ("+_pParamDists[i]->class_group+"),";}
   MCOUT<<endl;
+
+  //- Sample parameter values of all members up front, so that members may be run in any order ----
+  double val;
+  rand_key key;
+  key.seed  =_rand_seed;
+  key.stream=RAND_MC_PARAMS;
+  key.step  =0;
+  _aParamValues=new double *[_nMembers];
+  for(int e=0;e<_nMembers;e++) {
+    _aParamValues[e]=new double [max(_nParamDists,1)];
+    ExitGracefullyIf(_aParamValues[e]==NULL,"CMonteCarloEnsemble::Initialize",OUT_OF_MEMORY);
+    MCOUT<<e+1<<", ";
+    for(int i=0;i<_nParamDists;i++)
+    {
+      key.member=e;
+      key.index =i;
+      SampleFromDistribution(_pParamDists[i]->distribution,_pParamDists[i]->distpar,key,&val,1);
+      _aParamValues[e][i]=val;
+      MCOUT<<to_string(val)<<", ";
+    //  cout<<"RAND PARAM: "<<val<<" between "<<_pParamDists[i]->distpar[0]<<" and "<< _pParamDists[i]->distpar[1]<<endl;
+    }
+    MCOUT<<endl;
+  }
   MCOUT.close();
 }
 //////////////////////////////////////////////////////////////////
@@ -233,36 +370,173 @@ void CMonteCarloEnsemble::UpdateModel(CModel *pModel,optStruct &Options, const i
   ExitGracefullyIf(e>=_nMembers,"CMonteCarloEnsemble::UpdateMode: invalid ensemble member index",RUNTIME_ERR);
 
   //- update output file/ run names ----------------------------
-  Options.output_dir=_aOutputDirs[e];
-  Options.run_name  =_aRunNames[e];
+  SetMemberOutput(Options,e);
 
-  //- Update parameter values ----------------------------------
-  ofstream MCOUT;
-  string filename=Options.main_output_dir+"MonteCarloOutput.csv";
-  MCOUT.open(filename.c_str(),ios::app);
-  MCOUT<<e+1<<", ";
-
-  double val;
+  //- Update parameter values (sampled in Initialize()) --------
   for(int i=0;i<_nParamDists;i++)
   {
-    val=SampleFromDistribution(_pParamDists[i]->distribution,_pParamDists[i]->distpar);
     pModel->UpdateParameter(_pParamDists[i]->param_class,
                             _pParamDists[i]->param_name,
                             _pParamDists[i]->class_group,
-                            val);
-    MCOUT<<to_string(val)<<", ";
-  //  cout<<"RAND PARAM: "<<val<<" between "<<_pParamDists[i]->distpar[0]<<" and "<< _pParamDists[i]->distpar[1]<<endl;
+                            _aParamValues[e][i]);
   }
-  MCOUT<<endl;
 
   //- Re-read initial conditions to update state variables----
   if(!ParseInitialConditions(pModel,Options)) {
     ExitGracefully("Cannot find or read .rvc file",BAD_DATA);}
   pModel->CalculateInitialWaterStorage(Options);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  MCOUT.close();
+// FORECAST ENSEMBLE CLASS
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// in .rvi file:
+//  :EnsembleMode ENSEMBLE_FORECAST [#forecast members]
+//  :GriddedForcing ... :FileNameNC ./meteo/forecast_*.nc # (spin-up uses forcings of member 1)
+//
+// in .rve file:
+//  :ForecastHorizon 10                  # [d] last 10 days of :Duration are forecast from the shared spin-up state
+//  :OutputDirectoryFormat ./output/fc_* # forecast member output directories (spin-up output written to main output directory)
+//  :NumParallelMembers 8                # optional
+//  :ExtraRVTFilename ./meteo/forecast_*.rvt # optional member-specific time series
+//
+//////////////////////////////////////////////////////////////////
+/// \brief Forecast Ensemble Constructor
+/// \param num_members [in] number of forecast members (not including spin-up run)
+/// \param &Options [out] Global model options information
+//
+CForecastEnsemble::CForecastEnsemble(const int num_members,const optStruct &Options)
+                  :CEnsemble(num_members,Options)
+{
+  _type=ENSEMBLE_FORECAST;
+  _forecast_horizon=0.0;
+  _t_forecast      =0.0;
+  _full_duration   =Options.duration;
+  _spinup_runname  ="";
+  _extra_rvt       ="";
+  _aSpinupState    =NULL;
 }
-double SampleFromGamma(const double& shape,const double& scale)
+//////////////////////////////////////////////////////////////////
+/// \brief Forecast Ensemble Destructor
+//
+CForecastEnsemble::~CForecastEnsemble()
+{
+  delete [] _aSpinupState;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Accessor - gets number of ensemble member runs
+/// \return number of forecast members, plus one for the spin-up run
+//
+int CForecastEnsemble::GetNumMembers() const {
+  return _nMembers+1;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Accessor - gets local model start time of ensemble member run e
+/// \return start of simulation for spin-up (e=0), start of forecast otherwise
+//
+double CForecastEnsemble::GetStartTime(const int e) const {
+  if (e==0){return 0.0;}
+  return _t_forecast;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief Accessor - gets number of runs which must complete before forecast members are dispatched to worker processes
+/// \return 1 (spin-up run)
+//
+int CForecastEnsemble::GetNumLeadingMembers() const {
+  return 1;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief sets duration of forecast
+/// \param horizon [in] duration of forecast following spin-up, at end of simulation [d]
+//
+void CForecastEnsemble::SetForecastHorizon(const double horizon) {
+  _forecast_horizon=horizon;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief sets extra .rvt file name, read prior to each member run
+/// \param filename [in] .rvt filename with or without '*' wildcard. If * is present, will be replaced with forecast member ID
+//
+void CForecastEnsemble::SetExtraRVTFile(string filename) {
+  _extra_rvt=filename;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief initializes forecast ensemble
+/// \param pModel [in] pointer to global model instance
+/// \param &Options [in] Global model options information
+//
+void CForecastEnsemble::Initialize(const CModel* pModel,const optStruct &Options)
+{
+  CEnsemble::Initialize(pModel,Options);
+
+  ExitGracefullyIf(_forecast_horizon<=0.0,
+    "CForecastEnsemble::Initialize: a positive :ForecastHorizon must be specified in the .rve file for ENSEMBLE_FORECAST",BAD_DATA);
+  ExitGracefullyIf(_forecast_horizon>=Options.duration,
+    "CForecastEnsemble::Initialize: :ForecastHorizon must be shorter than the simulation duration",BAD_DATA);
+
+  //forecast starts at the first time step on or after (duration - horizon)
+  _full_duration=Options.duration;
+  _t_forecast   =ceil((_full_duration-_forecast_horizon)/Options.timestep-TIME_CORRECTION)*Options.timestep;
+
+  if (Options.run_name==""){_spinup_runname="spinup";}
+  else                     {_spinup_runname=Options.run_name+"_spinup";}
+
+  _aSpinupState=new double [pModel->GetStateSnapshotSize()];
+  ExitGracefullyIf(_aSpinupState==NULL,"CForecastEnsemble::Initialize",OUT_OF_MEMORY);
+}
+//////////////////////////////////////////////////////////////////
+/// \brief updates model - called prior to each model ensemble run
+/// \details run e=0 simulates the spin-up period using the forcings of forecast member 1; run e>0 restores the
+/// end-of-spin-up state and simulates the forecast period of member e (forcing wildcards replaced with e)
+/// \param pModel [out] pointer to global model instance
+/// \param &Options [out] Global model options information
+/// \param e [in] ensemble member run index
+//
+void CForecastEnsemble::UpdateModel(CModel *pModel,optStruct &Options,const int e)
+{
+  ExitGracefullyIf(e>=GetNumMembers(),"CForecastEnsemble::UpdateModel: invalid ensemble member index",RUNTIME_ERR);
+
+  int ee=max(e-1,0); //forecast member index
+  CEnsemble::UpdateModel(pModel,Options,ee);
+
+  if (e==0) //spin-up, starting from base model initial conditions (already read)
+  {
+    Options.output_dir=Options.main_output_dir;
+    Options.run_name  =_spinup_runname;
+    Options.duration  =_t_forecast;
+  }
+  else
+  {
+    SetMemberOutput(Options,ee);
+    Options.duration=_full_duration;
+
+    pModel->RestoreStateSnapshot(_aSpinupState);
+    pModel->ClearCumulativeStorage();
+    pModel->CalculateInitialWaterStorage(Options);
+    pModel->ExpireForcingGridChunks(); //chunk at start of forecast must be re-read from member forcing files
+  }
+
+  // read ensemble-member specific time series, if present
+  if (_extra_rvt != "") {
+    string rvt_name=_extra_rvt;
+    SubstringReplace(rvt_name,"*",to_string(ee+1));//replaces wildcard
+    Options.rvt_filename=rvt_name;
+    ParseTimeSeriesFile(pModel,Options);
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief called after each model ensemble run; stores end-of-spin-up state in memory
+/// \param pModel [in] pointer to global model instance
+/// \param e [in] ensemble member run index
+//
+void CForecastEnsemble::FinishEnsembleRun(CModel *pModel,optStruct &,const time_struct &,const int e)
+{
+  if (e==0){
+    pModel->SaveStateSnapshot(_aSpinupState);
+  }
+}
+double SampleFromGamma(const double& shape,const double& scale,const rand_key &key,const int j)
 {
   //From Cheng 1977 as documented in Devroye, L. Non-uniform random variate generation, Springer-Verlag, New York, 1986 (chap 9)
   double a=shape;
@@ -273,8 +547,7 @@ double SampleFromGamma(const double& shape,const double& scale)
   bool accept=false;
   do {
     iter++;
-     U=UniformRandom();
-     V=UniformRandom();
+     UniformPair(key,j,iter-1,U,V);
      X=a*exp(V);
      Y=a*log(V/(1-V));
      Z=U*V*V;
@@ -292,39 +565,43 @@ void TestGammaSampling()
   ofstream GOUT;
   GOUT.open("gamma_sample.csv");
   GOUT<<"(3-1),(1-0.5),(0.5-2),(5-1.0)"<<endl;
+  rand_key key={0,RAND_MC_PARAMS,0,0,0};
   for(int i=0;i<5000; i++) {
     cout<<i<<endl;
-    GOUT<<SampleFromGamma(3,1)<<" "<<SampleFromGamma(1,0.5)<<" "<<SampleFromGamma(0.5,2)<<" "<<SampleFromGamma(5,1.0)<<endl;
+    GOUT<<SampleFromGamma(3,1,key,4*i)<<" "<<SampleFromGamma(1,0.5,key,4*i+1)<<" "<<SampleFromGamma(0.5,2,key,4*i+2)<<" "<<SampleFromGamma(5,1.0,key,4*i+3)<<endl;
   }
   GOUT.close();
 }
 //////////////////////////////////////////////////////////////////
-/// \brief updates model - called prior to each model ensemble run
-/// \param pModel [out] pointer to global model instance
-/// \param &Options [out] Global model options information
+/// \brief generates samples 0 to n-1 of random sequence from specified distribution
+/// \details sample j depends only upon key and j, so results are independent of
+/// the order in which (or process/thread by which) members and time steps are sampled
+/// \param distribution [in] statistical distribution
+/// \param distpar [in] distribution parameters
+/// \param &key [in] identifies random sequence
+/// \param *values [out] array of sampled values [size: n]
+/// \param n [in] number of samples
 //
-double SampleFromDistribution(disttype distribution, double distpar[3])
+void SampleFromDistribution(disttype distribution,const double distpar[3],const rand_key &key,double *values,const int n)
 {
-  double value=0;
-
-  //std::mt19937 generator;
-
+  int j;
   if(distribution==DIST_UNIFORM)
   {
-    //std::uniform_real_distribution<double> distribution(dist->distpar[0],dist->distpar[1]);
-    //value=distribution(generator);
-    value=distpar[0]+(distpar[1]-distpar[0])*UniformRandom();
+    RandomUniform(key,values,n);
+    for(j=0;j<n;j++) { values[j]=distpar[0]+(distpar[1]-distpar[0])*values[j]; }
   }
   else if(distribution==DIST_NORMAL)
   {
-    //std::normal_distribution<double> distribution(dist->distpar[0],dist->distpar[1]);
-    //value = distribution(generator);
-    value=distpar[0]+(distpar[1]*GaussRandom());
+    RandomGauss(key,values,n);
+    for(j=0;j<n;j++) { values[j]=distpar[0]+(distpar[1]*values[j]); }
   }
   else if (distribution == DIST_LOGNORMAL) {
     double mu =distpar[0];
     double std=distpar[1];
-    value=exp(mu+std*GaussRandom());
+    RandomGauss(key,values,n);
+    for(j=0;j<n;j++) { values[j]=exp(mu+std*values[j]); }
+  }
+  else {
+    for(j=0;j<n;j++) { values[j]=0.0; }
   }
-  return value;
 }
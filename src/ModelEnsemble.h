@@ -26,7 +26,34 @@ struct param_dist
   //transformation trans; e.g., log transform
 
 };
-double SampleFromDistribution(disttype distribution,double distpar[3]);
+
+////////////////////////////////////////////////////////////////////
+/// \brief independent streams of random numbers, one per use
+//
+enum rand_stream
+{
+  RAND_MC_PARAMS,       ///< Monte Carlo parameter sampling
+  RAND_DDS_SELECT,      ///< DDS selection of perturbed parameters
+  RAND_DDS_PERTURB,     ///< DDS parameter perturbation
+  RAND_FORCING_PERTURB, ///< EnKF forcing perturbations
+  RAND_OBS_PERTURB      ///< EnKF observation perturbations
+};
+
+////////////////////////////////////////////////////////////////////
+/// \brief identifies a reproducible sequence of random numbers
+/// \details random numbers are generated from a counter-based generator (Philox4x32-10), so that sample j of the
+/// sequence depends only upon the key and j - not upon how many other numbers have been drawn, or in what order
+//
+struct rand_key
+{
+  unsigned int seed;         ///< random seed (from :RandomSeed command)
+  rand_stream  stream;       ///< purpose of random numbers
+  int          member;       ///< ensemble member index
+  int          index;        ///< parameter, perturbation, or observation index
+  int          step;         ///< time step index
+};
+void   RandomUniform         (const rand_key &key,double *u,const int n);
+void   SampleFromDistribution(disttype distribution,const double distpar[3],const rand_key &key,double *values,const int n);
 
 ////////////////////////////////////////////////////////////////////
 /// \brief Data abstraction for model ensemble run
@@ -43,33 +70,47 @@ protected:/*------------------------------------------------------*/
   string       *_aRunNames;      ///< array of output runnames [size: _nMembers]
   string       *_aSolutionFiles; ///< array of input solution filenames [size: _nMembers]
 
-  int           _rand_seed;      ///< random seed
+  unsigned int  _rand_seed;      ///< random seed
 
   bool          _disable_output; ///< true if output from ensemble should be turned off (default: false)
 
+  int           _nParallel;      ///< maximum number of members run simultaneously in separate worker processes (default: 1)
+
 public:/*-------------------------------------------------------*/
   CEnsemble(const int num_members, const optStruct &Options);
   ~CEnsemble();
 
   //Acessor Function
-  int            GetNumMembers() const;
+  virtual int    GetNumMembers() const;
   ensemble_type  GetType() const;
 
   virtual double GetStartTime(const int e) const;
 
+  unsigned int   GetRandomSeed() const;
   bool           DontWriteOutput() const;
+  int            GetNumParallelMembers() const;
+  bool           HasDistinctMemberOutput() const;
 
   //Manipulator Functions
   void SetRandomSeed     (const unsigned int seed);
   void SetOutputDirectory(const string OutDirString);
   void SetRunNames       (const string RunNames);
   void SetSolutionFiles  (const string SolFiles);
+  void SetNumParallelMembers(const int nParallel);
+  void SetMemberOutput   (optStruct &Options,const int e) const;
 
   virtual void Initialize       (const CModel* pModel,const optStruct &Options); //called prior to ALL ensemble runs
   virtual void UpdateModel      (CModel *pModel,optStruct &Options,const int e); //called prior to each ensemble run
   virtual void StartTimeStepOps (CModel* pModel,optStruct &Options,const time_struct &tt,const int e) {} //called at start of every timestep
   virtual void CloseTimeStepOps (CModel* pModel,optStruct &Options,const time_struct &tt,const int e) {} //called at end of each timestep
   virtual void FinishEnsembleRun(CModel *pModel,optStruct &Options,const time_struct &tt,const int e) {} //called after all ensembles run
+
+  //parallel ensembles only (see RunParallelEnsemble())
+  virtual void   PrepareMemberRun  (CModel *,optStruct &,const int) {}                  //called in parent process before member e is dispatched
+  virtual double GetMemberResult   (const CModel *,const int) const {return 0.0;}       //called in worker process after member e is run
+  virtual void   AcceptMemberResult(const int,const double) {}                          //called in parent process once member e is finished; replaces FinishEnsembleRun
+  virtual int    GetNumLeadingMembers() const {return 0;}                               //members 0..n-1 are run in parent process (with FinishEnsembleRun) before any workers are created
+  virtual bool   TerminateMemberRun(const int) const {return false;}                    //called at end of each timestep; true ends simulation of member e early
 };
 
 ////////////////////////////////////////////////////////////////////
@@ -82,6 +123,7 @@ private:
   int          _nParamDists; ///< number of parameter distributions for sampling
   param_dist **_pParamDists; ///< array of pointers to parameter distributions
 
+  double     **_aParamValues;///< sampled parameter values of each member [size: _nMembers x _nParamDists]
 
 public:
   CMonteCarloEnsemble(const int num_members,const optStruct &Options);
@@ -103,6 +145,13 @@ private:
   double      *_BestParams;  ///< vector of best parameter values
   double      *_TestParams;  ///< vector of test parameter values
   double       _Fbest;       ///< best obj function val
+  int          _nCompleted;  ///< number of completed DDS iterations
+
+  double     **_aCandidates; ///< candidate parameter vector of each member dispatched to a worker process [size: _nMembers x _nParamDists] (NULL in serial DDS)
+
+  bool              _early_term; ///< true if candidate runs are terminated once bound on objective function is worse than best
+  CDiagAccumulator *_pObjAccum;  ///< online accumulator of objective function of current candidate (NULL if not early termination)
+  bool              _terminated; ///< true if current candidate run was terminated early
 
   int          _nParamDists; ///< number of parameter distributions for sampling
   param_dist **_pParamDists; ///< array of pointers to parameter distributions
@@ -114,8 +163,11 @@ private:
   ofstream     _DDSOUT;      ///< output file stream
 
   double PerturbParam(const double &x_best,
-                      const double &upperbound,
-                      const double &lowerbound);
+                      const double &z,
+                      const double &lowerbound,
+                      const double &upperbound);
+  void   GenerateCandidate(const int e,double *params);
+  void   RecordResult     (const int e,const double &Ftest,const double *params);
 
 public:
   CDDSEnsemble(const int num_members,const optStruct &Options);
@@ -123,10 +175,50 @@ public:
 
   void SetPerturbationValue(const double &perturb);
   void SetCalibrationTarget(const long SBID, const diag_type object_diag, const string period);
+  void SetEarlyTermination (const bool early_term);
   void AddParamDist(const param_dist *dist);
 
   void Initialize(const CModel* pModel,const optStruct &Options);
   void UpdateModel(CModel *pModel,optStruct &Options,const int e);
+  void CloseTimeStepOps (CModel* pModel,optStruct &Options,const time_struct &tt,const int e);
+  void FinishEnsembleRun(CModel *pModel,optStruct &Options,const time_struct &tt,const int e);
+  bool TerminateMemberRun(const int e) const;
+
+  void   PrepareMemberRun  (CModel *pModel,optStruct &Options,const int e);
+  double GetMemberResult   (const CModel *pModel,const int e) const;
+  void   AcceptMemberResult(const int e,const double result);
+};
+
+////////////////////////////////////////////////////////////////////
+/// \brief Data abstraction for forecast ensemble launched from a single spin-up run
+/// \details Member 0 simulates the spin-up period shared by all forecast members; its final state is held in memory
+/// and each of the _nMembers forecast members (1.._nMembers) is started from it, reading its own forcings via the '*' wildcard
+//
+class CForecastEnsemble : public CEnsemble
+{
+private:
+  double       _forecast_horizon; ///< duration of forecast following spin-up [d]
+  double       _t_forecast;       ///< local model time of forecast start [d]
+  double       _full_duration;    ///< simulation duration of spin-up and forecast, from .rvi file [d]
+
+  string       _spinup_runname;   ///< run name of spin-up output
+  string       _extra_rvt;        ///< name of extra-data .rvt file for ensemble member-specific time series
+
+  double      *_aSpinupState;     ///< in-memory snapshot of model state at end of spin-up [size: pModel::GetStateSnapshotSize()]
+
+public:
+  CForecastEnsemble(const int num_members,const optStruct &Options);
+  ~CForecastEnsemble();
+
+  int    GetNumMembers       () const;
+  double GetStartTime        (const int e) const;
+  int    GetNumLeadingMembers() const;
+
+  void SetForecastHorizon(const double horizon);
+  void SetExtraRVTFile   (string filename);
+
+  void Initialize       (const CModel* pModel,const optStruct &Options);
+  void UpdateModel      (CModel *pModel,optStruct &Options,const int e);
   void FinishEnsembleRun(CModel *pModel,optStruct &Options,const time_struct &tt,const int e);
 };
 #endif
@@ -12,6 +12,8 @@
    -GenerateMinMaxSubdailyTempFromAve
    -GeneratePrecipFromSnowRain
    -GetAverageSnowFrac
+   -ExpireForcingGridChunks
+   -FinishForcingGridReads
 ------------------------------------------------------------------
 *****************************************************************/
 
@@ -31,7 +33,7 @@ CForcingGrid *CModel::ForcingCopyCreate(const CForcingGrid *pGrid,
   { // for the first chunk, the derived grid does not exist and has to be added to the model
     // all weights, etc., are copied from the base grid
 
-    pTout = new CForcingGrid(*pGrid);  // copy everything from pGrid; matrices are deep copies
+    pTout = new CForcingGrid(*pGrid);  // copy everything from pGrid; grid weights are shared, data matrices are deep copies
 
     //following values are overwritten:
     int    GridDims[3];
@@ -161,13 +163,7 @@ void CModel::GenerateGriddedTempVars(const optStruct &Options)
   {
 
     pGrid_daily_tave = ForcingCopyCreate(pGrid_tave,F_TEMP_DAILY_AVE,pGrid_tave->GetInterval(),pGrid_tave->GetChunkSize(),Options);
-    int chunk_size =pGrid_tave->GetChunkSize();
-    int nNonZero   =pGrid_tave->GetNumberNonZeroGridCells();
-    for(int it=0; it<chunk_size; it++) {           // loop over time points in buffer
-      for(int ic=0; ic<nNonZero;ic++) {             // loop over non-zero grid cell indexes
-        pGrid_daily_tave->SetValue(ic,it,pGrid_tave->GetValue(ic,it)); //copy values //\todo[optimize] - is this necessary - should copy in ForcingCopyCreate
-      }
-    }
+    pGrid_daily_tave->ViewValuesOf(pGrid_tave); //identical values - no copy needed
     AddForcingGrid(pGrid_daily_tave,F_TEMP_DAILY_AVE);
     temp_ave_gridded=false;
     temp_daily_ave_gridded=true;
@@ -259,12 +255,12 @@ void CModel::GenerateAveSubdailyTempFromMinMax(const optStruct &Options)
     int nNonZero  =pTave->GetNumberNonZeroGridCells();
     double time_shift=Options.julian_start_day-floor(Options.julian_start_day+TIME_CORRECTION);
     for (int it=0; it<nVals; it++) {                   // loop over all time points (nVals)
+      time_idx_chunk = int(floor(t+TIME_CORRECTION));
+      T1corr = pTave->DailyTempCorrection(t+time_shift);                  // same for all grid cells
+      T2corr = pTave->DailyTempCorrection(t+time_shift+Options.timestep);
       for (int ic=0; ic<nNonZero; ic++){               // loop over non-zero grid cell indexes
-        time_idx_chunk = int(floor(t+TIME_CORRECTION));
         Tmin   = pTmin->GetValue_avg(ic, floor(t +time_shift+TIME_CORRECTION)*nValsPerDay, nValsPerDay);
         Tmax   = pTmax->GetValue_avg(ic, floor(t +time_shift+TIME_CORRECTION)*nValsPerDay, nValsPerDay);
-        T1corr = pTave->DailyTempCorrection(t+time_shift);
-        T2corr = pTave->DailyTempCorrection(t+time_shift+Options.timestep);
         val=pTave_daily->GetValue(ic, time_idx_chunk)+0.25*(Tmax-Tmin)*(T1corr+T2corr);
         pTave->SetValue( ic, it, val);
       }
@@ -278,13 +274,7 @@ void CModel::GenerateAveSubdailyTempFromMinMax(const optStruct &Options)
     {
       int    nVals     = pTave_daily->GetChunkSize();
       pTave = ForcingCopyCreate(pTave_daily,F_TEMP_AVE,1.0,nVals,Options);
-
-      int nNonZero  =pTave->GetNumberNonZeroGridCells();
-      for(int it=0; it<nVals; it++) {                                 // loop over time points in buffer
-        for(int ic=0; ic<nNonZero; ic++) {                                  // loop over non-zero grid cell indexes
-          pTave->SetValue(ic,it,pTave_daily->GetValue(ic,it));  // --> just copy daily average values
-        }
-      }
+      pTave->ViewValuesOf(pTave_daily);                       // --> just use daily average values
       AddForcingGrid(pTave,F_TEMP_AVE);
     }
   }
@@ -308,18 +298,20 @@ void CModel::GenerateMinMaxAveTempFromSubdaily(const optStruct &Options)
   pTmax_daily = ForcingCopyCreate(pTave,F_TEMP_DAILY_MAX,1.0,nVals,Options);
   pTave_daily = ForcingCopyCreate(pTave,F_TEMP_DAILY_AVE,1.0,nVals,Options);
 
-  double time;
+  double time,Tmin,Tmax,Tave;
   double time_shift=Options.julian_start_day-floor(Options.julian_start_day+TIME_CORRECTION);
   int    nsteps_in_day=int(1.0/interval);
+  int    nNonZero  =pTave->GetNumberNonZeroGridCells();
 
   for (int it=0; it<nVals; it++) {                    // loop over time points in buffer
     time=(double)it*1.0/interval;
     time=floor(time-time_shift+TIME_CORRECTION); //model time corresponding to 00:00 on day of it
 
-    for (int ic=0; ic<pTave->GetNumberNonZeroGridCells(); ic++){         // loop over non-zero grid cell indexes
-      pTmin_daily->SetValue(ic, it, pTave->GetValue_min(ic, time, nsteps_in_day));
-      pTmax_daily->SetValue(ic, it, pTave->GetValue_max(ic, time, nsteps_in_day));
-      pTave_daily->SetValue(ic, it, pTave->GetValue_avg(ic, time, nsteps_in_day));
+    for (int ic=0; ic<nNonZero; ic++){                // loop over non-zero grid cell indexes
+      pTave->GetValue_stats(ic, time, nsteps_in_day, Tmin, Tmax, Tave); // single pass over subdaily values
+      pTmin_daily->SetValue(ic, it, Tmin);
+      pTmax_daily->SetValue(ic, it, Tmax);
+      pTave_daily->SetValue(ic, it, Tave);
     }
   }
 
@@ -416,12 +408,7 @@ void CModel::GenerateRainFromPrecip(const optStruct &Options)
   pRain = ForcingCopyCreate(pPre,F_RAINFALL,pPre->GetInterval(),nVals,Options);
 
   // set forcing values
-  int nNonZero  =pRain->GetNumberNonZeroGridCells();
-  for(int it=0; it<nVals; it++) {                   // loop over time points in buffer
-    for(int ic=0; ic<nNonZero; ic++){                    // loop over non-zero grid cell indexes
-      pRain->SetValue(ic,it,pPre->GetValue(ic,it));      // copies precipitation values
-    }
-  }
+  pRain->ViewValuesOf(pPre);                        // shares precipitation values (no copy)
 
   AddForcingGrid(pRain,F_RAINFALL);
 }
@@ -440,13 +427,16 @@ void CModel::GenerateZeroSnow(const optStruct &Options)
   pPre->Initialize(Options);//needed for correct mapping from time series to model time
 
   int    nVals     = pPre->GetChunkSize();
+  bool   is_new    = (GetForcingGridIndexFromType(F_SNOWFALL)==DOESNT_EXIST);
 
   pSnow = ForcingCopyCreate(pPre,F_SNOWFALL,pPre->GetInterval(),nVals,Options);
 
-  int nNonZero  =pSnow->GetNumberNonZeroGridCells();
-  for (int it=0; it<nVals; it++) {                   // loop over time points in buffer
-    for (int ic=0; ic<nNonZero; ic++){                    // loop over non-zero grid cell indexes
-      pSnow->SetValue(ic, it , 0.0);                      // fills everything with 0.0
+  if (is_new) { //zeros persist in snowfall grid storage; no need to re-fill for subsequent chunks
+    int nNonZero  =pSnow->GetNumberNonZeroGridCells();
+    for (int it=0; it<nVals; it++) {                   // loop over time points in buffer
+      for (int ic=0; ic<nNonZero; ic++){                    // loop over non-zero grid cell indexes
+        pSnow->SetValue(ic, it , 0.0);                      // fills everything with 0.0
+      }
     }
   }
 
@@ -475,3 +465,28 @@ double CModel::GetAverageSnowFrac(const int ic, const double t, const int n) con
   return snow/(snow+rain);
 
 }
+
+//////////////////////////////////////////////////////////////////
+/// \brief forces all gridded forcings to be re-read from file at the next time step
+/// \details required when ensemble member changes ('*' wildcard in forcing filenames refers
+///  to another member) but the simulation does not start at the beginning of a chunk
+//
+void CModel::ExpireForcingGridChunks()
+{
+  for (int f=0;f<_nForcingGrids;f++){
+    _pForcingGrids[f]->ExpireChunk();
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief waits for all background reads of gridded forcing chunks to complete and closes forcing files
+/// \details called at end of each simulation, so that no prefetch threads are active and no NetCDF
+///  files are open while files are (re-)parsed or the next ensemble member is set up
+//
+void CModel::FinishForcingGridReads()
+{
+  for (int f=0;f<_nForcingGrids;f++){
+    _pForcingGrids[f]->FinishPrefetch();
+  }
+  CForcingGrid::CloseNetCDFFiles();
+}
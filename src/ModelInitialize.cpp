@@ -257,6 +257,66 @@ void CModel::Initialize(const optStruct &Options)
     }
   }
 
+  // Determine whether HRUs may be processed in parallel/in blocks by solver
+  //--------------------------------------------------------------
+  _nThreads =max(Options.num_threads,1);
+  _nHRUBlock=MAX_HRU_BLOCK;
+  for (j=0; j<_nProcesses;j++){
+    if (!_pProcesses[j]->IsThreadSafe()){
+      if (_nThreads>1){
+        string warn="CModel::Initialize: process "+GetProcessName(_pProcesses[j]->GetProcessType())+" cannot be simulated in parallel. HRUs will be processed serially.";
+        WriteWarning(warn,Options.noisy);
+      }
+      _nThreads=1; _nHRUBlock=1; break;
+    }
+  }
+  if (_nParamOverrides>0){ //parameters are overridden one HRU at a time
+    if (_nThreads>1){
+      WriteWarning("CModel::Initialize: local parameter overrides cannot be used with parallel HRU processing. HRUs will be processed serially.",Options.noisy);
+    }
+    _nThreads=1; _nHRUBlock=1;
+  }
+
+  // Determine whether subbasins of the same routing level may be routed in parallel by solver
+  //--------------------------------------------------------------
+  _nRoutingThreads=max(Options.num_threads,1);
+  if (Options.management_optimization){_nRoutingThreads=1;} //reservoir outflows/deliveries determined jointly
+  for (p=0;p<_nSubBasins;p++){
+    if ((_pSubBasins[p]->GetReservoir()!=NULL) && (_pSubBasins[p]->GetReservoir()->DependsOnOtherBasins())){
+      if (_nRoutingThreads>1){
+        WriteAdvisory("CModel::Initialize: one or more reservoirs depend upon the state of other subbasins (downstream flow targets or control structures). Subbasins will be routed serially.",Options.noisy);
+      }
+      _nRoutingThreads=1; break;
+    }
+  }
+
+  // Move HRU state variables into contiguous model-wide storage
+  //--------------------------------------------------------------
+  CStateMatrix *pOldStates=_pStateMatrix;
+  _pStateMatrix=new CStateMatrix(_nHydroUnits,_nStateVars,Options.state_storage);
+  ExitGracefullyIf(_pStateMatrix==NULL,"CModel::Initialize (_pStateMatrix)",OUT_OF_MEMORY);
+  for (k=0;k<_nHydroUnits;k++){
+    _pHydroUnits[k]->BindStateStorage(_pStateMatrix->GetDataAddress(),
+                                      k*_pStateMatrix->GetHRUStride(),_pStateMatrix->GetSVStride());
+  }
+  delete pOldStates; //only non-NULL if model is re-initialized
+
+  // Reserve solver working memory
+  //--------------------------------------------------------------
+  delete _pSolverWS;
+  _pSolverWS=new CSolverWorkspace(_nHydroUnits,_nStateVars,_nSubBasins,_nProcesses,
+                                  _pTransModel->GetNumConstituents(),_nThreads,_nRoutingThreads,
+                                  Options.sol_method,Options.state_storage);
+  ExitGracefullyIf(_pSolverWS==NULL,"CModel::Initialize (_pSolverWS)",OUT_OF_MEMORY);
+
+  // Precompile sequence of processes applied by solver
+  //--------------------------------------------------------------
+  CompileExecutionPlan(Options);
+
+  // Build dependency graph of HRU processing and routing tasks (task graph scheduling only)
+  //--------------------------------------------------------------
+  BuildTaskGraph(Options);
+
   // Initialize NetCDF Output File IDs
   //--------------------------------------------------------------
   /* initialize all potential NetCDF file IDs with -9 == "not existing and hence not opened" */
@@ -540,8 +600,11 @@ void CModel::InitializeRoutingNetwork()
   int zerocount(0);
   _aOrderedSBind=new int [_nSubBasins];
   ExitGracefullyIf(_aOrderedSBind==NULL,"CModel::InitializeRoutingNetwork(2)",OUT_OF_MEMORY);
+  _aRoutingLevelStart=new int [_maxSubBasinOrder+2];
+  ExitGracefullyIf(_aRoutingLevelStart==NULL,"CModel::InitializeRoutingNetwork(3)",OUT_OF_MEMORY);
   for (ord=_maxSubBasinOrder;ord>=0;ord--)
   {
+    _aRoutingLevelStart[_maxSubBasinOrder-ord]=pp;
     if (noisy){cout<<"      order["<<ord<<"]:";}
     for (p=0;p<_nSubBasins;p++)
     {
@@ -558,6 +621,7 @@ void CModel::InitializeRoutingNetwork()
     }
     if (noisy){cout<<endl;}
   }
+  _aRoutingLevelStart[_maxSubBasinOrder+1]=_nSubBasins;
   if (noisy){cout <<"      number of zero-order outlets: "<<zerocount<<endl;}
 
   for (p = 0; p < _nSubBasins; p++)
@@ -774,6 +838,109 @@ void CModel::InitializeParameterOverrides()
   }
 }
 
+//////////////////////////////////////////////////////////////////
+/// \brief Compiles sequence of processes applied to each block of HRUs by solver
+/// \details Stores connectivity of all processes and the type of each connection (exchange, storage connected
+/// to itself, or non-storage accumulation), then determines which processes apply in each HRU block
+/// \remark Called at end of Initialize(), once processes are initialized and the solver HRU block size is known
+///
+/// \param &Options [in] Global model options information
+//
+void CModel::CompileExecutionPlan(const optStruct &Options)
+{
+  int nBlock=1;
+  if ((Options.sol_method==ORDERED_SERIES) || (Options.sol_method==EULER)){nBlock=_nHRUBlock;} //iterated Heun processes HRUs individually
+
+  delete _pExecPlan;
+  _pExecPlan=new CExecutionPlan(_nProcesses,_nHydroUnits,nBlock,_nTotalConnections);
+  ExitGracefullyIf(_pExecPlan==NULL,"CModel::CompileExecutionPlan",OUT_OF_MEMORY);
+
+  conn_type ctype[MAX_CONNECTIONS];
+  for (int j=0;j<_nProcesses;j++)
+  {
+    const int *iFrom=_pProcesses[j]->GetFromIndices();
+    const int *iTo  =_pProcesses[j]->GetToIndices();
+    int nConnections=_pProcesses[j]->GetNumConnections();
+    ExitGracefullyIf(nConnections>MAX_CONNECTIONS,"CModel::CompileExecutionPlan: maximum number of connections exceeded",RUNTIME_ERR);
+    for (int q=0;q<nConnections;q++)
+    {
+      sv_type typ=_aStateVarType[iFrom[q]];
+      if      (iTo[q]!=iFrom[q])                                          {ctype[q]=CONN_EXCHANGE;  }
+      else if (CStateVariable::IsWaterStorage(typ) && (typ!=CONVOLUTION)){ctype[q]=CONN_TO_ITSELF; }
+      else                                                                {ctype[q]=CONN_ACCUMULATE;}
+    }
+    _pExecPlan->SetConnections(j,nConnections,iFrom,iTo,ctype);
+  }
+  RefreshExecutionPlan();
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Updates processes applied in each HRU block of execution plan from _aShouldApplyProcess and HRU status
+/// \details Flows of processes which do not apply to an HRU are zeroed here, as the solver does not revisit them
+/// \remark Called upon compilation of plan and whenever HRU classes change during simulation
+//
+void CModel::RefreshExecutionPlan()
+{
+  bool **apply=new bool *[_nProcesses];
+  for (int j=0;j<_nProcesses;j++)
+  {
+    apply[j]=new bool [_nHydroUnits];
+    int qs=_pExecPlan->GetFirstConnection(j);
+    for (int k=0;k<_nHydroUnits;k++)
+    {
+      apply[j][k]=_aShouldApplyProcess[j][k] && _pHydroUnits[k]->IsEnabled();
+      if (!apply[j][k]){
+        for (int q=0;q<_pExecPlan->GetNumConnections(j);q++){_aFlowBal[k][qs+q]=0.0;}
+      }
+    }
+  }
+  _pExecPlan->SetApplicability(apply);
+
+  for (int j=0;j<_nProcesses;j++){delete [] apply[j];} delete [] apply;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Builds dependency graph of HRU block processing and subbasin routing tasks, if task graph scheduling is requested
+/// \details Task graph scheduling requires that HRUs and subbasins may be processed in parallel, and that
+/// nothing couples HRUs or subbasins between HRU processing and routing (i.e., lateral flow processes,
+/// coupled groundwater, flow or stage assimilation, management optimization). Otherwise, a warning is issued
+/// and staged scheduling is used.
+/// \remark Called at end of Initialize(), after the execution plan is compiled
+///
+/// \param &Options [in] Global model options information
+//
+void CModel::BuildTaskGraph(const optStruct &Options)
+{
+  delete _pTaskGraph; _pTaskGraph=NULL;
+  if (Options.schedule!=SCHEDULE_TASK_GRAPH){return;}
+
+  string reason="";
+  if      ((_nThreads<=1) || (_nRoutingThreads<_nThreads)){reason="HRUs or subbasins must be processed serially";}
+  else if (Options.sol_method!=ORDERED_SERIES)         {reason="only the ordered series solution method is supported";}
+  else if (_nLatFlowProcesses>0)                       {reason="lateral flow processes couple HRUs";}
+  else if (Options.modeltype==MODELTYPE_COUPLED)       {reason="groundwater model couples HRUs";}
+  else if (Options.assimilate_flow)                    {reason="flow assimilation is used";}
+  else if (Options.assimilate_stage)                   {reason="reservoir stage assimilation is used";}
+  else if (Options.management_optimization)            {reason="management optimization couples subbasins";}
+  if (reason!=""){
+    WriteWarning("CModel::BuildTaskGraph: task graph scheduling cannot be used ("+reason+"). Staged scheduling will be used.",Options.noisy);
+    return;
+  }
+
+  int *aHRUBasin=new int [_nHydroUnits];
+  int *aResHRU  =new int [_nSubBasins];
+  for (int k=0;k<_nHydroUnits;k++){aHRUBasin[k]=_pHydroUnits[k]->GetSubBasinIndex();}
+  for (int p=0;p<_nSubBasins;p++){
+    aResHRU[p]=DOESNT_EXIST;
+    if (_pSubBasins[p]->GetReservoir()!=NULL){aResHRU[p]=_pSubBasins[p]->GetReservoir()->GetHRUIndex();}
+  }
+  _pTaskGraph=new CTaskGraph(_nHydroUnits,_pExecPlan->GetBlockSize(),_nSubBasins,aHRUBasin,aResHRU,_aDownstreamInds,_aOrderedSBind);
+  ExitGracefullyIf(_pTaskGraph==NULL,"CModel::BuildTaskGraph",OUT_OF_MEMORY);
+
+  delete [] aHRUBasin;
+  delete [] aResHRU;
+}
+
 //////////////////////////////////////////////////////////////////
 /// \brief Generates gauge weights
 /// \details Populates an array aWts with interpolation weightings for distribution of gauge station data to HRUs
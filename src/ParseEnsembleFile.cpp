@@ -82,6 +82,10 @@ bool ParseEnsembleFile(CModel *&pModel,const optStruct &Options)
     else if(!strcmp(s[0],":ObservationErrorModel"))       { code=16; }
     else if(!strcmp(s[0],":EnKFMode"))                    { code=18; }
     else if(!strcmp(s[0],":ExtraRVTFilename"))            { code=19; }
+    else if(!strcmp(s[0],":NumParallelMembers"))          { code=20; }
+    else if(!strcmp(s[0],":ForecastHorizon"))             { code=21; }
+    else if(!strcmp(s[0],":LocalizationRadius"))          { code=22; }
+    else if(!strcmp(s[0],":EarlyTermination"))            { code=23; }
     else if(!strcmp(s[0],":AssimilateStreamflow"))        { code=101;}
 
     switch(code)
@@ -439,6 +443,7 @@ bool ParseEnsembleFile(CModel *&pModel,const optStruct &Options)
         else if (!strcmp(s[1],"ENKF_OPEN_LOOP"    )){mode=ENKF_OPEN_LOOP;}
         else if (!strcmp(s[1],"ENKF_FORECAST"     )){mode=ENKF_FORECAST;}
         else if (!strcmp(s[1],"ENKF_OPEN_FORECAST")){mode=ENKF_OPEN_FORECAST;}
+        else if (!strcmp(s[1],"ENKF_CLOSED_FORECAST")){mode=ENKF_CLOSED_FORECAST;}
 
         else if (!strcmp(s[1],"ENKF_CLOSEDLOOP"   )){mode=ENKF_CLOSED_LOOP;}
         else if (!strcmp(s[1],"ENKF_OPENLOOP"     )){mode=ENKF_OPEN_LOOP;}
@@ -461,8 +466,69 @@ bool ParseEnsembleFile(CModel *&pModel,const optStruct &Options)
         string file=CorrectForRelativePath(s[1],Options.rvi_filename);//with .rvt extension! (may include * wildcard operator for filename)
         pEnKF->SetExtraRVTFile(file);
       }
+      else if(pEnsemble->GetType()==ENSEMBLE_FORECAST) {
+        CForecastEnsemble* pFC=((CForecastEnsemble*)(pEnsemble));
+        pFC->SetExtraRVTFile(CorrectForRelativePath(s[1],Options.rvi_filename));
+      }
+      else {
+        WriteWarning(":ExtraRVTFilename command will be ignored; only valid for EnKF or forecast ensemble simulation.",Options.noisy);
+      }
+      break;
+    }
+    case(20):  //----------------------------------------------
+    {/*:NumParallelMembers [number of members run simultaneously]*/
+      if(Options.noisy) { cout <<":NumParallelMembers"<<endl; }
+      ExitGracefullyIf(Len<2,"Parse Ensemble File: incorrect number of terms in :NumParallelMembers command.",BAD_DATA);
+      if((pEnsemble->GetType()==ENSEMBLE_MONTECARLO) || (pEnsemble->GetType()==ENSEMBLE_DDS) || (pEnsemble->GetType()==ENSEMBLE_FORECAST)) {
+        pEnsemble->SetNumParallelMembers(s_to_i(s[1]));
+      }
+      else {
+        WriteWarning(":NumParallelMembers command will be ignored; only valid for Monte Carlo, DDS, or forecast ensemble simulation.",Options.noisy);
+      }
+      break;
+    }
+    case(21):  //----------------------------------------------
+    {/*:ForecastHorizon [duration of forecast following assimilation, in days]*/
+      if(Options.noisy) { cout <<":ForecastHorizon"<<endl; }
+      ExitGracefullyIf(Len<2,"Parse Ensemble File: incorrect number of terms in :ForecastHorizon command.",BAD_DATA);
+      if(pEnsemble->GetType()==ENSEMBLE_ENKF) {
+        CEnKFEnsemble* pEnKF=((CEnKFEnsemble*)(pEnsemble));
+        pEnKF->SetForecastHorizon(s_to_d(s[1]));
+      }
+      else if(pEnsemble->GetType()==ENSEMBLE_FORECAST) {
+        CForecastEnsemble* pFC=((CForecastEnsemble*)(pEnsemble));
+        pFC->SetForecastHorizon(s_to_d(s[1]));
+      }
+      else {
+        WriteWarning(":ForecastHorizon command will be ignored; only valid for EnKF or forecast ensemble simulation.",Options.noisy);
+      }
+      break;
+    }
+    case(22):  //----------------------------------------------
+    {/*:LocalizationRadius [max network distance, in # of subbasin links] {UPSTREAM_ONLY}*/
+      if(Options.noisy) { cout <<":LocalizationRadius"<<endl; }
+      ExitGracefullyIf(Len<2,"Parse Ensemble File: incorrect number of terms in :LocalizationRadius command.",BAD_DATA);
+      if(pEnsemble->GetType()==ENSEMBLE_ENKF) {
+        CEnKFEnsemble* pEnKF=((CEnKFEnsemble*)(pEnsemble));
+        bool upstream_only=((Len>=3) && (!strcmp(s[2],"UPSTREAM_ONLY")));
+        ExitGracefullyIf((Len>=3) && (!upstream_only),"Parse Ensemble File: unrecognized option in :LocalizationRadius command; expected UPSTREAM_ONLY",BAD_DATA);
+        ExitGracefullyIf(s_to_i(s[1])<0,"Parse Ensemble File: :LocalizationRadius must be zero or positive",BAD_DATA);
+        pEnKF->SetLocalization(s_to_i(s[1]),upstream_only);
+      }
+      else {
+        WriteWarning(":LocalizationRadius command will be ignored; only valid for EnKF ensemble simulation.",Options.noisy);
+      }
+      break;
+    }
+    case(23):  //----------------------------------------------
+    {/*:EarlyTermination*/
+      if(Options.noisy) { cout <<":EarlyTermination"<<endl; }
+      if(pEnsemble->GetType()==ENSEMBLE_DDS) {
+        CDDSEnsemble *pDDS=((CDDSEnsemble*)(pEnsemble));
+        pDDS->SetEarlyTermination(true);
+      }
       else {
-        WriteWarning(":ExtraRVTFilename command will be ignored; only valid for EnKF ensemble simulation.",Options.noisy);
+        WriteWarning(":EarlyTermination command will be ignored; only valid for DDS calibration.",Options.noisy);
       }
       break;
     }
@@ -255,6 +255,7 @@ bool ParseNetCDFRunInfoFile(CModel *&pModel, optStruct &Options, bool runname_ov
         else if (!strcmp(modestr,"ENKF_OPEN_LOOP"    )){mode=ENKF_OPEN_LOOP;}
         else if (!strcmp(modestr,"ENKF_FORECAST"     )){mode=ENKF_FORECAST;}
         else if (!strcmp(modestr,"ENKF_OPEN_FORECAST")){mode=ENKF_OPEN_FORECAST;}
+        else if (!strcmp(modestr,"ENKF_CLOSED_FORECAST")){mode=ENKF_CLOSED_FORECAST;}
         else {
           ExitGracefully("ParseEnsembleFile: EnKFMode-  invalid mode specified",BAD_DATA_WARN);
         }
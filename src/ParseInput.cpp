@@ -332,6 +332,12 @@ bool ParseMainInputFile (CModel     *&pModel,
   Options.flowinfo_filename       ="";
 
   Options.NetCDF_chunk_mem        =10; //MB
+  Options.NetCDF_cache_mem        =100;//MB
+  Options.NetCDF_prefetch         =false;
+  Options.NetCDF_single_prec      =false;
+  Options.num_threads             =1;
+  Options.state_storage           =LAYOUT_HRU_MAJOR;
+  Options.schedule                =SCHEDULE_STAGED;
 
   Options.management_optimization =false;
 
@@ -476,6 +482,12 @@ bool ParseMainInputFile (CModel     *&pModel,
     else if  (!strcmp(s[0],":FEWSStateInfoFile"         )){code=110;}
     else if  (!strcmp(s[0],":FEWSParamInfoFile"         )){code=111;}
     else if  (!strcmp(s[0],":FEWSBasinStateInfoFile"    )){code=112;}
+    else if  (!strcmp(s[0],":NumThreads"                )){code=113;}
+    else if  (!strcmp(s[0],":StateStorageLayout"        )){code=114;}
+    else if  (!strcmp(s[0],":ParallelSchedule"          )){code=115;}
+    else if  (!strcmp(s[0],":ForcingCacheSize"          )){code=116;}
+    else if  (!strcmp(s[0],":PrefetchForcingChunks"     )){code=117;}
+    else if  (!strcmp(s[0],":SinglePrecisionForcings"   )){code=118;}
 
     else if  (!strcmp(s[0],":WriteGroundwaterHeads"     )){code=510;}//GWMIGRATE -TO REMOVE
     else if  (!strcmp(s[0],":WriteGroundwaterFlows"     )){code=511;}//GWMIGRATE -TO REMOVE
@@ -1367,6 +1379,7 @@ bool ParseMainInputFile (CModel     *&pModel,
       else if (!strcmp(s[1],"ENSEMBLE_DDS"       )) { Options.ensemble=ENSEMBLE_DDS; }
       else if (!strcmp(s[1],"ENSEMBLE_MONTECARLO")) { Options.ensemble=ENSEMBLE_MONTECARLO; }
       else if (!strcmp(s[1],"ENSEMBLE_ENKF"      )) { Options.ensemble=ENSEMBLE_ENKF; }
+      else if (!strcmp(s[1],"ENSEMBLE_FORECAST"  )) { Options.ensemble=ENSEMBLE_FORECAST; }
       else { ExitGracefully("ParseInput:EnsembleMode: Unrecognized ensemble simulation mode",BAD_DATA_WARN); }
       num_ensemble_members=s_to_i(s[2]);
       break;
@@ -1912,6 +1925,60 @@ bool ParseMainInputFile (CModel     *&pModel,
       Options.flowinfo_filename = CorrectForRelativePath(s[1], Options.rvi_filename);//with .nc extension!
       break;
     }
+    case(113):  //--------------------------------------------
+    {/*:NumThreads [number of threads]*/
+      if (Options.noisy) { cout << "Number of threads" << endl; }
+      if (Len<2){ImproperFormatWarning(":NumThreads",p,Options.noisy); break;}
+      Options.num_threads=max(s_to_i(s[1]),1);
+#ifndef _OPENMP
+      if (Options.num_threads>1){
+        WriteWarning(":NumThreads: Raven was compiled without OpenMP support. Simulation will be run using a single thread.",Options.noisy);
+        Options.num_threads=1;
+      }
+#endif
+      break;
+    }
+    case(114):  //--------------------------------------------
+    {/*:StateStorageLayout [HRU_MAJOR/SV_MAJOR]*/
+      if (Options.noisy) { cout << "State variable storage layout" << endl; }
+      if (Len<2){ImproperFormatWarning(":StateStorageLayout",p,Options.noisy); break;}
+      if      (!strcmp(s[1],"HRU_MAJOR")){Options.state_storage=LAYOUT_HRU_MAJOR;}
+      else if (!strcmp(s[1],"SV_MAJOR" )){Options.state_storage=LAYOUT_SV_MAJOR;}
+      else {
+        ExitGracefully("ParseMainInputFile: Unrecognized :StateStorageLayout (should be HRU_MAJOR or SV_MAJOR)",BAD_DATA_WARN);
+      }
+      break;
+    }
+    case(115):  //--------------------------------------------
+    {/*:ParallelSchedule [STAGED/TASK_GRAPH]*/
+      if (Options.noisy) { cout << "Parallel schedule" << endl; }
+      if (Len<2){ImproperFormatWarning(":ParallelSchedule",p,Options.noisy); break;}
+      if      (!strcmp(s[1],"STAGED"    )){Options.schedule=SCHEDULE_STAGED;}
+      else if (!strcmp(s[1],"TASK_GRAPH")){Options.schedule=SCHEDULE_TASK_GRAPH;}
+      else {
+        ExitGracefully("ParseMainInputFile: Unrecognized :ParallelSchedule (should be STAGED or TASK_GRAPH)",BAD_DATA_WARN);
+      }
+      break;
+    }
+    case(116):  //--------------------------------------------
+    {/*:ForcingCacheSize [size, in MB]*/
+      if (Options.noisy) { cout << "Gridded forcing cache size" << endl; }
+      if (Len<2){ImproperFormatWarning(":ForcingCacheSize",p,Options.noisy); break;}
+      Options.NetCDF_cache_mem=max(s_to_i(s[1]),0);
+      break;
+    }
+    case(117):  //--------------------------------------------
+    {/*:PrefetchForcingChunks*/
+      if (Options.noisy) { cout << "Prefetch gridded forcing chunks" << endl; }
+      Options.NetCDF_prefetch=true;
+      break;
+    }
+    case(118):  //--------------------------------------------
+    {/*:SinglePrecisionForcings*/
+      if (Options.noisy) { cout << "Single precision gridded forcing storage" << endl; }
+      Options.NetCDF_single_prec=true;
+      break;
+    }
     case(160):  //--------------------------------------------
     {/*:rvh_Filename [filename.rvh]*/
       if(Options.noisy) { cout <<"rvh filename: "<<s[1]<<endl; }
@@ -3521,6 +3588,10 @@ bool ParseMainInputFile (CModel     *&pModel,
   if((Options.nNetCDFattribs>0) && (Options.output_format!=OUTPUT_NETCDF)){
     WriteAdvisory("ParseMainInputFile: NetCDF attributes were specified but output format is not NetCDF.",Options.noisy);
   }
+  if((Options.NetCDF_prefetch) && (Options.output_format==OUTPUT_NETCDF)){
+    WriteWarning("ParseMainInputFile: :PrefetchForcingChunks cannot be used with NetCDF output (NetCDF library is not thread-safe); forcing chunks will be read synchronously.",Options.noisy);
+    Options.NetCDF_prefetch=false;
+  }
   for(int i=0; i<pModel->GetNumStateVars();i++) {
     if((pModel->GetStateVarType(i)==SOIL) && ((pModel->GetStateVarLayer(i))>(Options.num_soillayers-1))) {
       string warn="A soil variable with an index ("+to_string(pModel->GetStateVarLayer(i))+") greater than that allowed by the limiting number of layers indicated in the :SoilModel command ("+to_string(Options.num_soillayers)+") was included in the .rvi file";
@@ -3548,6 +3619,7 @@ bool ParseMainInputFile (CModel     *&pModel,
   else if(Options.ensemble==ENSEMBLE_MONTECARLO) {pEnsemble=new CMonteCarloEnsemble(num_ensemble_members,Options);}
   else if(Options.ensemble==ENSEMBLE_DDS)        {pEnsemble=new CDDSEnsemble(num_ensemble_members,Options); }
   else if(Options.ensemble==ENSEMBLE_ENKF      ) {pEnsemble=new CEnKFEnsemble(num_ensemble_members,Options); Options.assimilate_flow=false;}
+  else if(Options.ensemble==ENSEMBLE_FORECAST  ) {pEnsemble=new CForecastEnsemble(num_ensemble_members,Options);}
 
   pModel->SetEnsembleMode(pEnsemble);
   pEnsemble->SetRandomSeed(random_seed);
@@ -160,6 +160,7 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
     else if  (!strcmp(s[0],":StationIDNameNC"             )){code=416;}
     else if  (!strcmp(s[0],":StationElevationsByIdx"      )){code=417;}
     else if  (!strcmp(s[0],":MapStationsTo"               )){code=418;}//Alternate to :GridWeights for :StationForcing command
+    else if  (!strcmp(s[0],":ChunkCacheSizeNC"            )){code=419;}
 
     //---------STATION DATA INPUT AS NETCDF (stations,time)------
     //             code 401-405 & 407-414 are shared between
@@ -1494,12 +1495,14 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
       string filename=s[1];
       filename =CorrectForRelativePath(filename ,Options.rvt_filename);
 
-      // check for existence
+      // check for existence (of first ensemble member's file, if wildcard is used)
+      string filename_e=filename;
+      SubstringReplace(filename_e,"*",to_string(max(g_current_e,0)+1));
 
       int    retval;                // error value for NetCDF routines
-      retval = nc_open(filename.c_str(),NC_NOWRITE,&ncid);
+      retval = nc_open(filename_e.c_str(),NC_NOWRITE,&ncid);
       if (retval != 0){
-	      string warn = "ParseTimeSeriesFile: :FileNameNC command: Cannot find gridded data file "+ filename;
+	      string warn = "ParseTimeSeriesFile: :FileNameNC command: Cannot find gridded data file "+ filename_e;
 	      ExitGracefully(warn.c_str(),BAD_DATA_WARN);
 	      break;
       }
@@ -1570,6 +1573,16 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
         pGrid->ForcingGridInit(Options);
       }
 
+      // same weights already read by another forcing grid on this grid (e.g., one :RedirectToFile weights file used by all forcings)
+      string source=p->GetFilename()+":"+to_string(p->GetLineNumber());
+      if (pGrid->UseSharedWeights(source))
+      {
+        if (Options.noisy) {cout <<"GridWeights (shared)..."<<endl;}
+        while (((Len==0) || (strcmp(s[0],":EndGridWeights"))) && (!(p->Tokenize(s,Len)))) {} //skip block
+        pGrid->CalculateChunkSize(Options);
+        break;
+      }
+
       bool nHydroUnitsGiven = false;
       bool nGridCellsGiven  = false;
       int  nHydroUnits=0;
@@ -1634,6 +1647,7 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
 
       // store (sorted) grid cell ids with non-zero weight in array
       pGrid->SetIdxNonZeroGridCells(nHydroUnits,nGridCells,Options);
+      pGrid->ShareWeights(source);
       pGrid->CalculateChunkSize(Options);
       break;
     }
@@ -1958,6 +1972,15 @@ bool ParseTimeSeriesFile(CModel *&pModel, const optStruct &Options)
       delete [] junk;
       break;
     }
+    case (419)://----------------------------------------------
+    {/*:ChunkCacheSizeNC [size, in MB]*/
+      if(Options.noisy) { cout <<"   :ChunkCacheSizeNC"<<endl; }
+      ExitGracefullyIf(pGrid==NULL,"ParseTimeSeriesFile: :ChunkCacheSizeNC command must be within a :GriddedForcing or :StationForcing block",BAD_DATA);
+      ExitGracefullyIf(Len<2,      "ParseTimeSeriesFile: :ChunkCacheSizeNC expects one argument",BAD_DATA);
+      ExitGracefullyIf(s_to_d(s[1])<0.0,"ParseTimeSeriesFile: :ChunkCacheSizeNC must be non-negative",BAD_DATA);
+      pGrid->SetChunkCacheSize(s_to_d(s[1]));
+      break;
+    }
     case (500)://----------------------------------------------
     {/*:StationForcing
          :ForcingType PRECIP
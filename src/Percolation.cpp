@@ -354,3 +354,95 @@ void   CmvPercolation::ApplyConstraints(const double             *state_vars,
   room=threshMax(pHRU->GetStateVarMax(iTo[0],state_vars,Options)-state_vars[iTo[0]],0.0,0.0);
   rates[0]=threshMin(rates[0],room/Options.timestep,0.0);
 }
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns rates of percolation for a block of HRUs [mm/d]
+/// \details Method and soil layer are resolved once per block; the most common methods are
+/// evaluated in a tight HRU loop. Other methods (and lakes) use GetRatesOfChange()
+///
+/// \param **state_vars [in] state variable arrays of HRUs in block
+/// \param **pHRUs [in] HRUs in block
+/// \param nHRUs [in] number of HRUs in block
+/// \param &Options [in] Global model options information
+/// \param &tt [in] Current model time structure
+/// \param **rates [out] Rate of percolation for each HRU [mm/d]
+//
+void   CmvPercolation::GetRatesOfChangeBlock(const double      *const *state_vars,
+                                             const CHydroUnit  *const *pHRUs,
+                                             const int                 nHRUs,
+                                             const optStruct          &Options,
+                                             const time_struct        &tt,
+                                                   double      *const *rates) const
+{
+  if ((type!=PERC_CONSTANT) && (type!=PERC_GAWSER) && (type!=PERC_LINEAR) &&
+      (type!=PERC_POWER_LAW) && (type!=PERC_GR4J))
+  {
+    CHydroProcessABC::GetRatesOfChangeBlock(state_vars,pHRUs,nHRUs,Options,tt,rates);
+    return;
+  }
+
+  const int    i0   =iFrom[0];
+  const int    m    =pModel->GetStateVarLayer(i0); //which soil layer
+  const double tstep=Options.timestep;
+  double stor,max_stor;
+  const soil_struct *pSoil;
+
+  for (int b=0;b<nHRUs;b++)
+  {
+    if (pHRUs[b]->GetHRUType()==HRU_LAKE){continue;}//Lakes
+    stor     = state_vars[b][i0];                   //soil layer water content [mm]
+    max_stor = pHRUs[b]->GetSoilCapacity(m);        //maximum storage of 'from' soil layer [mm]
+    if (max_stor <= 0.0){continue;}                 //handles zero-thickness layers
+    pSoil    = pHRUs[b]->GetSoilProps(m);
+
+    switch(type)
+    {
+    case(PERC_CONSTANT):  rates[b][0]=pSoil->max_perc_rate; break;
+    case(PERC_GAWSER):
+    {
+      double field_cap=pSoil->field_capacity*max_stor; //moisture content at fc [mm]
+      rates[b][0]=pSoil->max_perc_rate*max(stor-field_cap,0.0)/(max_stor-field_cap);
+      break;
+    }
+    case(PERC_POWER_LAW): rates[b][0]=pSoil->max_perc_rate*pow(stor/max_stor,pSoil->perc_n); break;
+    case(PERC_LINEAR):    rates[b][0]=pSoil->perc_coeff*stor; break;
+    case(PERC_GR4J):      rates[b][0]=stor*(1.0-pow(1.0+pow(4.0/9.0*max(stor/max_stor,0.0),4),-0.25))/tstep; break;
+    default: break;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Corrects rates of percolation for a block of HRUs
+/// \details identical to ApplyConstraints(), applied to each HRU in block
+///
+/// \param **state_vars [in] state variable arrays of HRUs in block
+/// \param **pHRUs [in] HRUs in block
+/// \param nHRUs [in] number of HRUs in block
+/// \param &Options [in] Global model options information
+/// \param &tt [in] Current model time structure (unused)
+/// \param **rates [out] Rate of percolation for each HRU [mm/d]
+//
+void   CmvPercolation::ApplyConstraintsBlock(const double      *const *state_vars,
+                                             const CHydroUnit  *const *pHRUs,
+                                             const int                 nHRUs,
+                                             const optStruct          &Options,
+                                             const time_struct        & /*tt*/,
+                                                   double      *const *rates) const
+{
+  const int    i0      =iFrom[0];
+  const int    i1      =iTo  [0];
+  const double min_stor=g_min_storage;
+  double room;
+  for (int b=0;b<nHRUs;b++)
+  {
+    if (pHRUs[b]->GetHRUType()==HRU_LAKE){continue;}//Lakes
+
+    //cant remove more than is there
+    rates[b][0]=threshMin(rates[b][0],max(state_vars[b][i0]-min_stor,0.0)/Options.timestep,0.0);
+
+    //exceedance of max "to" compartment
+    room=threshMax(pHRUs[b]->GetStateVarMax(i1,state_vars[b],Options)-state_vars[b][i1],0.0,0.0);
+    rates[b][0]=threshMin(rates[b][0],room/Options.timestep,0.0);
+  }
+}
@@ -24,6 +24,9 @@
 #ifdef _RVNETCDF_
 #include <netcdf.h>
 #endif
+#ifdef lapack
+#define _RVLAPACK_      // BLAS/LAPACK linear algebra (Matrix.cpp); defined automatically by cmake if library is available
+#endif
 
 #include <stdlib.h>
 #include <cstring>
@@ -302,6 +305,7 @@ const int     MAX_SOILLAYERS      =50;          ///< Max number of soil layers i
 const int     MAX_STATE_VAR_TYPES =100;         ///< Max number of *types* of state variables in model
 const int     MAX_STATE_VARS      =200;         ///< Max number of simulated state variables manipulable by one process (CAdvection worst offender)
 const int     MAX_CONNECTIONS     =200;         ///< Max number of to/from connections in any single process (CAdvection worst offender)
+const int     MAX_HRU_BLOCK       =16;          ///< Max number of HRUs passed together to batched process rate calculations
 const int     MAX_LAT_CONNECTIONS =4000;        ///< Max number of lateral HRU flow connections
 const int     MAX_SOIL_PROFILES   =200;         ///< Max number of soil profiles
 const int     MAX_VEG_CLASSES     =200;         ///< Max number of vegetation classes
@@ -310,6 +314,7 @@ const int     MAX_TERRAIN_CLASSES =50;          ///< Max number of terrain class
 const int     MAX_SURVEY_PTS      =50;          ///< Max number of survey points
 const int     MAX_CONSTITUENTS    =10;          ///< Max number of transported constituents
 const int     MAX_RIVER_SEGS      =50;          ///< Max number of river segments
+const int     MAX_CONTROL_STRUCTURES=10;        ///< Max number of outflow control structures per reservoir
 const int     MAX_FILENAME_LENGTH =256;         ///< Max filename length
 const int     MAX_MULTIDATA       =10;          ///< Max multidata length
 /******************************************************************
@@ -327,6 +332,24 @@ enum numerical_method
   ITERATED_HEUN       ///< 2nd Order Convergence Method
 };
 
+///////////////////////////////////////////////////////////////////
+/// \brief Memory layout of model-wide state variable storage
+//
+enum state_layout
+{
+  LAYOUT_HRU_MAJOR,   ///< all state variables of an HRU are contiguous (default)
+  LAYOUT_SV_MAJOR     ///< values of a state variable for all HRUs are contiguous
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief Scheduling of parallel work within solver
+//
+enum parallel_schedule
+{
+  SCHEDULE_STAGED,      ///< all HRUs are processed, then subbasins are routed level by level (default)
+  SCHEDULE_TASK_GRAPH   ///< HRU blocks and subbasin routing are tasks executed as soon as their dependencies are met
+};
+
 ///////////////////////////////////////////////////////////////////
 /// \brief The type of model that is being simulated
 //
@@ -729,7 +752,8 @@ enum ensemble_type
   ENSEMBLE_NONE,         ///< standard single model run
   ENSEMBLE_MONTECARLO,   ///< basic Monte Carlo simulation
   ENSEMBLE_DDS,          ///< DDS optimization run
-  ENSEMBLE_ENKF          ///< Ensemble Kalman Filter data assimilation run
+  ENSEMBLE_ENKF,         ///< Ensemble Kalman Filter data assimilation run
+  ENSEMBLE_FORECAST      ///< forecast ensemble launched from single shared spin-up run
 };
 
 ////////////////////////////////////////////////////////////////////
@@ -1008,6 +1032,9 @@ struct optStruct
   numerical_method sol_method;                ///< numerical solution method
   double           convergence_crit;          ///< convergence criteria
   double           max_iterations;            ///< maximum number of iterations for iterative solver method
+  int              num_threads;               ///< number of threads used to process HRUs in parallel within solver (default: 1)
+  state_layout     state_storage;             ///< memory layout of model state variable storage
+  parallel_schedule schedule;                 ///< scheduling of parallel work within solver
   double           timestep;                  ///< numerical method timestep (in days)
   double           output_interval;           ///< write to output file every x number of timesteps
   ensemble_type    ensemble;                  ///< ensemble type (or ENSEMBLE_NONE if single model)
@@ -1135,6 +1162,9 @@ struct optStruct
   netcdfatt       *aNetCDFattribs;            ///< array of NetCDF attrributes {attribute/value pair}
   int              nNetCDFattribs;            ///< size of array of NetCDF attributes
   int              NetCDF_chunk_mem;          ///< [MB] size of memory chunk for each forcing grid
+  int              NetCDF_cache_mem;          ///< [MB] maximum size of decoded forcing chunks retained for re-use (e.g., by later ensemble members)
+  bool             NetCDF_prefetch;           ///< true if next chunk of each forcing grid is read by background thread while current chunk is simulated
+  bool             NetCDF_single_prec;        ///< true if gridded forcing chunks are stored in single precision (float32)
   bool             in_bmi_mode;               ///< true if in BMI mode (no rvt files, no end time)
 };
 
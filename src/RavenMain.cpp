@@ -7,6 +7,12 @@
 #include "RavenMain.h"
 #include "Model.h"
 #include "UnitTesting.h"
+#if defined(__unix__) || defined(__APPLE__)
+  #include <sys/types.h>
+  #include <sys/wait.h>
+  #include <unistd.h>
+  #define _RVN_FORK_
+#endif
 #ifdef STANDALONE
     #include "GracefulEndStandalone.h"
 #elif BMI_LIBRARY
@@ -37,9 +43,7 @@ bool ParseManagementFile       (CModel *&pModel, const optStruct &Options);
 //
 int main(int argc, char* argv[])
 {
-  double      t;
-  clock_t     t0, t1;          //computational time markers
-  time_struct tt;
+  clock_t     t0;              //computational time marker
   int         nEnsembleMembers;
   optStruct   Options;
 
@@ -101,80 +105,12 @@ int main(int argc, char* argv[])
 
   nEnsembleMembers=pModel->GetEnsemble()->GetNumMembers();
 
-  for(int e=0;e<nEnsembleMembers; e++) //only run once in standard mode
-  {
-
-    pModel->GetEnsemble()->UpdateModel(pModel,Options,e);
-    PrepareOutputdirectory(Options); //adds new output folders, if needed
-    pModel->WriteOutputFileHeaders(Options);
-
-    if(!Options.silent) {
-      cout <<endl<<"======================================================"<<endl;
-      if(nEnsembleMembers>1) { cout<<"Ensemble Member "<<e+1<<" "; g_suppress_warnings=true;}
-      cout <<"Simulation Start..."<<endl;
-    }
-
-    double t_start=0.0;
-    t_start=pModel->GetEnsemble()->GetStartTime(e);
-
-    //Write initial conditions-------------------------------------
-    JulianConvert(t_start,Options.julian_start_day,Options.julian_start_year,Options.calendar,tt);
-    pModel->RecalculateHRUDerivedParams(Options,tt);
-    pModel->UpdateHRUForcingFunctions  (Options,tt);
-    pModel->UpdateDiagnostics          (Options,tt);
-    pModel->WriteMinorOutput           (Options,tt);
-
-    //Solve water/energy balance over time--------------------------------
-    t1=clock();
-    int step=0;
-
-    for(t=t_start; t<Options.duration-TIME_CORRECTION; t+=Options.timestep)  // in [d]
-    {
-      pModel->UpdateTransientParams      (Options,tt);
-      pModel->RecalculateHRUDerivedParams(Options,tt);
-      pModel->GetEnsemble()->StartTimeStepOps(pModel,Options,tt,e);
-      pModel->UpdateHRUForcingFunctions  (Options,tt);
-      pModel->PrepareAssimilation        (Options,tt);
-      pModel->WriteSimpleOutput          (Options,tt);
-      CallExternalScript                 (Options,tt);
-      ParseLiveFile                      (pModel,Options,tt);
-
-      MassEnergyBalance(pModel,Options,tt); //where the magic happens!
-
-      pModel->IncrementCumulInput        (Options,tt);
-      pModel->IncrementCumOutflow        (Options,tt);
-
-      JulianConvert(t+Options.timestep,Options.julian_start_day,Options.julian_start_year,Options.calendar,tt);//increments time structure
-      pModel->WriteMinorOutput           (Options,tt);
-      pModel->WriteProgressOutput        (Options,clock()-t1,step,(int)ceil(Options.duration/Options.timestep));
-      pModel->UpdateDiagnostics          (Options,tt); //required to read stuff!!
-      pModel->GetEnsemble()->CloseTimeStepOps(pModel,Options,tt,e);
-
-      if ((Options.use_stopfile) && (CheckForStopfile(step, tt, pModel))) { break; }
-      step++;
-    }
-
-    //Finished Solving----------------------------------------------------
-    pModel->UpdateDiagnostics (Options,tt);
-    pModel->RunDiagnostics    (Options);
-    pModel->WriteMajorOutput  (Options,tt,"solution",true);
-    pModel->CloseOutputStreams();
-
-    if(!Options.silent)
-    {
-      cout <<"======================================================"<<endl;
-      cout <<"...Raven Simulation Complete: "<<Options.run_name<<endl;
-      cout <<"    Parsing & initialization: "<< float(t1     -t0)/CLOCKS_PER_SEC << " seconds elapsed . "<<endl;
-      cout <<"                  Simulation: "<< float(clock()-t1)/CLOCKS_PER_SEC << " seconds elapsed . "<<endl;
-      if(Options.output_dir!="") {
-        cout <<"  Output written to "        << Options.output_dir                                       <<endl;
-      }
-      cout <<"======================================================"<<endl;
-    }
-    if (Options.benchmarking) {
-      cout <<"                              "<< pModel->GetNumHRUs()*(Options.duration/Options.timestep)/(float(clock()-t1)/CLOCKS_PER_SEC)<<" HRU-time steps/second"<<endl;
-    }
+  bool parallel=(nEnsembleMembers>1) && (pModel->GetEnsemble()->GetNumParallelMembers()>1) && (RunParallelEnsemble(pModel,Options,t0));
 
+  for(int e=0;(e<nEnsembleMembers) && (!parallel); e++) //only run once in standard mode
+  {
+    time_struct tt;
+    RunEnsembleMember(pModel,Options,e,t0,tt);
     pModel->GetEnsemble()->FinishEnsembleRun(pModel,Options,tt,e);
   }/* end ensemble loop*/
 
@@ -381,3 +317,235 @@ void CallExternalScript(const optStruct &Options,const time_struct &tt)
     system(script.c_str()); //Calls script
   }
 }
+/////////////////////////////////////////////////////////////////
+/// \brief Simulates a single ensemble member (or the only model run, in standard mode)
+///
+/// \param pModel [in/out] model
+/// \param &Options [in/out] Global model options information
+/// \param e [in] ensemble member index
+/// \param t0 [in] clock time at start of program (for reporting)
+/// \param &tt [out] time structure at end of simulation (for CEnsemble::FinishEnsembleRun)
+//
+void RunEnsembleMember(CModel *pModel, optStruct &Options, const int e, const clock_t t0, time_struct &tt)
+{
+  double      t;
+  clock_t     t1;
+  int         nEnsembleMembers=pModel->GetEnsemble()->GetNumMembers();
+
+  pModel->GetEnsemble()->UpdateModel(pModel,Options,e);
+  PrepareOutputdirectory(Options); //adds new output folders, if needed
+  pModel->WriteOutputFileHeaders(Options);
+
+  if(!Options.silent) {
+    cout <<endl<<"======================================================"<<endl;
+    if(nEnsembleMembers>1) { cout<<"Ensemble Member "<<e+1<<" "; g_suppress_warnings=true;}
+    cout <<"Simulation Start..."<<endl;
+  }
+
+  double t_start=0.0;
+  t_start=pModel->GetEnsemble()->GetStartTime(e);
+
+  //Write initial conditions-------------------------------------
+  JulianConvert(t_start,Options.julian_start_day,Options.julian_start_year,Options.calendar,tt);
+  pModel->RecalculateHRUDerivedParams(Options,tt);
+  pModel->UpdateHRUForcingFunctions  (Options,tt);
+  pModel->UpdateDiagnostics          (Options,tt);
+  pModel->WriteMinorOutput           (Options,tt);
+
+  //Solve water/energy balance over time--------------------------------
+  t1=clock();
+  int step=0;
+
+  for(t=t_start; t<Options.duration-TIME_CORRECTION; t+=Options.timestep)  // in [d]
+  {
+    pModel->UpdateTransientParams      (Options,tt);
+    pModel->RecalculateHRUDerivedParams(Options,tt);
+    pModel->GetEnsemble()->StartTimeStepOps(pModel,Options,tt,e);
+    pModel->UpdateHRUForcingFunctions  (Options,tt);
+    pModel->PrepareAssimilation        (Options,tt);
+    pModel->WriteSimpleOutput          (Options,tt);
+    CallExternalScript                 (Options,tt);
+    ParseLiveFile                      (pModel,Options,tt);
+
+    MassEnergyBalance(pModel,Options,tt); //where the magic happens!
+
+    pModel->IncrementCumulInput        (Options,tt);
+    pModel->IncrementCumOutflow        (Options,tt);
+
+    JulianConvert(t+Options.timestep,Options.julian_start_day,Options.julian_start_year,Options.calendar,tt);//increments time structure
+    pModel->WriteMinorOutput           (Options,tt);
+    pModel->WriteProgressOutput        (Options,clock()-t1,step,(int)ceil(Options.duration/Options.timestep));
+    pModel->UpdateDiagnostics          (Options,tt); //required to read stuff!!
+    pModel->GetEnsemble()->CloseTimeStepOps(pModel,Options,tt,e);
+
+    if ((Options.use_stopfile) && (CheckForStopfile(step, tt, pModel))) { break; }
+    if (pModel->GetEnsemble()->TerminateMemberRun(e)) { break; }
+    step++;
+  }
+
+  //Finished Solving----------------------------------------------------
+  pModel->FinishForcingGridReads();
+  pModel->UpdateDiagnostics (Options,tt);
+  pModel->RunDiagnostics    (Options);
+  pModel->WriteMajorOutput  (Options,tt,"solution",true);
+  pModel->CloseOutputStreams();
+
+  if(!Options.silent)
+  {
+    cout <<"======================================================"<<endl;
+    cout <<"...Raven Simulation Complete: "<<Options.run_name<<endl;
+    cout <<"    Parsing & initialization: "<< float(t1     -t0)/CLOCKS_PER_SEC << " seconds elapsed . "<<endl;
+    cout <<"                  Simulation: "<< float(clock()-t1)/CLOCKS_PER_SEC << " seconds elapsed . "<<endl;
+    if(Options.output_dir!="") {
+      cout <<"  Output written to "        << Options.output_dir                                       <<endl;
+    }
+    cout <<"======================================================"<<endl;
+  }
+  if (Options.benchmarking) {
+    cout <<"                              "<< pModel->GetNumHRUs()*(Options.duration/Options.timestep)/(float(clock()-t1)/CLOCKS_PER_SEC)<<" HRU-time steps/second"<<endl;
+  }
+}
+/////////////////////////////////////////////////////////////////
+/// \brief Simulates ensemble members simultaneously, each in its own worker process
+/// \details Each worker is forked from the fully initialized model, and so begins with an in-memory
+/// copy of the entire model (processes, HRUs, subbasins, forcings and outputs) without re-reading any
+/// input other than the member's initial conditions. At most GetNumParallelMembers() workers run at once;
+/// each member writes output to its own directory, as in sequential mode.
+/// Members are dispatched in order; CEnsemble::PrepareMemberRun() is called in this (parent) process just
+/// before member e is dispatched, and the worker returns CEnsemble::GetMemberResult() through a pipe, which
+/// is handed to CEnsemble::AcceptMemberResult() as soon as the worker finishes. This permits asynchronous
+/// algorithms (e.g., parallel DDS) in which later members depend upon the results of earlier ones.
+/// The first CEnsemble::GetNumLeadingMembers() members (e.g., a spin-up shared by forecast members) are
+/// instead run in this process, in order, before any workers are created, so that all workers inherit their results.
+/// These are simulated with a single thread, since OpenMP threads started in this process are not usable in workers.
+/// If a worker fails, no further members are dispatched and the program exits with an error once running
+/// workers finish, except in DDS, where the failed candidate is simply rejected
+/// \remark Requires fork() (unix/macOS); otherwise, or if members share output files, a warning is
+/// issued and false is returned, so that members are run sequentially
+///
+/// \param pModel [in/out] initialized model
+/// \param &Options [in/out] Global model options information
+/// \param t0 [in] clock time at start of program (for reporting)
+/// \return true if all members were simulated
+//
+bool RunParallelEnsemble(CModel *pModel, optStruct &Options, const clock_t t0)
+{
+  CEnsemble *pEnsemble=pModel->GetEnsemble();
+  string reason="";
+#ifndef _RVN_FORK_
+  reason="worker processes are not supported on this platform";
+#endif
+  if      ((pEnsemble->GetType()!=ENSEMBLE_MONTECARLO) &&
+           (pEnsemble->GetType()!=ENSEMBLE_DDS) &&
+           (pEnsemble->GetType()!=ENSEMBLE_FORECAST))  {reason="only Monte Carlo, DDS, and forecast ensembles are supported";}
+  else if (!pEnsemble->HasDistinctMemberOutput())   {reason="members must write output to distinct directories or run names";}
+  if (reason!=""){
+    WriteWarning("RunParallelEnsemble: ensemble members cannot be run in parallel ("+reason+"). Ensemble members will be run sequentially.",Options.noisy);
+    return false;
+  }
+#ifdef _RVN_FORK_
+  int nMembers =pEnsemble->GetNumMembers();
+  int nLeading =pEnsemble->GetNumLeadingMembers();
+  int nParallel=max(min(pEnsemble->GetNumParallelMembers(),nMembers-nLeading),1);
+  int nRunning =0;
+  int failed   =DOESNT_EXIST; //first member whose worker did not complete successfully
+  int k,status;
+  int fd[2];
+
+  pid_t  *aWorkerPID   =new pid_t[nParallel]; //process ID of each worker slot (or 0 if idle)
+  int    *aWorkerMember=new int  [nParallel]; //ensemble member simulated in each worker slot
+  int    *aWorkerPipe  =new int  [nParallel]; //read end of pipe from each worker slot
+  for(k=0;k<nParallel;k++) { aWorkerPID[k]=0; }
+
+  //OpenMP threads do not survive fork(), and workers would wait forever upon threads started in this process:
+  //members run before workers are forked are simulated serially, and workers then use all threads
+  int nThreads     =pModel->GetNumThreads();
+  int nRouteThreads=pModel->GetNumRoutingThreads();
+  if((nLeading>0) && (max(nThreads,nRouteThreads)>1)) {
+    WriteAdvisory("RunParallelEnsemble: the first "+to_string(nLeading)+" ensemble member(s) are simulated with a single thread before worker processes are created",Options.noisy);
+    pModel->SetNumThreads(1,1);
+  }
+  int e=0;
+  for(e=0;e<nLeading;e++) //members which all others depend upon are run before workers are forked
+  {
+    time_struct tt;
+    RunEnsembleMember(pModel,Options,e,t0,tt);
+    pEnsemble->FinishEnsembleRun(pModel,Options,tt,e);
+  }
+  pModel->SetNumThreads(nThreads,nRouteThreads);
+
+  if(!Options.silent) {
+    cout <<endl<<"======================================================"<<endl;
+    cout <<"Running "<<nMembers-nLeading<<" ensemble members, up to "<<nParallel<<" at a time..."<<endl;
+  }
+  while(((e<nMembers) && (failed==DOESNT_EXIST)) || (nRunning>0))
+  {
+    if((e<nMembers) && (failed==DOESNT_EXIST) && (nRunning<nParallel))
+    {
+      //dispatch member e to an idle worker slot
+      for(k=0;k<nParallel;k++) {
+        if(aWorkerPID[k]==0) { break; }
+      }
+      pEnsemble->PrepareMemberRun(pModel,Options,e);
+
+      cout.flush(); //otherwise buffered output is duplicated in worker
+      ExitGracefullyIf(pipe(fd)!=0,"RunParallelEnsemble: unable to create pipe to worker process",RUNTIME_ERR);
+      pid_t pid=fork();
+      ExitGracefullyIf(pid<0,"RunParallelEnsemble: unable to create worker process",RUNTIME_ERR);
+      if(pid==0) { //worker: simulate member e, report result, then exit without finalizing shared model
+        close(fd[0]);
+        time_struct tt;
+        RunEnsembleMember(pModel,Options,e,t0,tt);
+        double result=pEnsemble->GetMemberResult(pModel,e);
+        if(write(fd[1],&result,sizeof(double))!=sizeof(double)) { _exit(1); }
+        close(fd[1]);
+        cout.flush();
+        _exit(0);
+      }
+      close(fd[1]);
+      aWorkerPID   [k]=pid;
+      aWorkerMember[k]=e;
+      aWorkerPipe  [k]=fd[0];
+      nRunning++;
+      e++;
+    }
+    else
+    {
+      //wait for any worker to finish, then collect its result
+      pid_t pid=wait(&status);
+      ExitGracefullyIf(pid<0,"RunParallelEnsemble: lost track of worker processes",RUNTIME_ERR);
+      for(k=0;k<nParallel;k++) {
+        if(aWorkerPID[k]==pid) { break; }
+      }
+      if(k==nParallel) { continue; } //not one of our workers
+
+      double result=ALMOST_INF;
+      bool   good  =((WIFEXITED(status)) && (WEXITSTATUS(status)==0));
+      if((read(aWorkerPipe[k],&result,sizeof(double))!=sizeof(double)) || (!good)) {
+        if(pEnsemble->GetType()==ENSEMBLE_DDS) { //failed candidate is simply rejected
+          WriteWarning("RunParallelEnsemble: worker process for ensemble member "+to_string(aWorkerMember[k]+1)+" did not complete successfully",Options.noisy);
+        }
+        else if(failed==DOESNT_EXIST) { //no further members are dispatched; running workers are collected
+          failed=aWorkerMember[k];
+        }
+        result=ALMOST_INF;
+      }
+      close(aWorkerPipe[k]);
+      aWorkerPID[k]=0;
+      nRunning--;
+      pEnsemble->AcceptMemberResult(aWorkerMember[k],result);
+    }
+  }
+
+  delete [] aWorkerPID;
+  delete [] aWorkerMember;
+  delete [] aWorkerPipe;
+
+  if(failed!=DOESNT_EXIST) {
+    string error="RunParallelEnsemble: worker process for ensemble member "+to_string(failed+1)+" did not complete successfully";
+    FinalizeGracefully(error.c_str(),RUNTIME_ERR);
+    exit(1); //unlike ExitGracefully(), failure of ensemble run must be reported to calling process
+  }
+#endif
+  return true;
+}
@@ -21,5 +21,7 @@ void ProcessExecutableArguments(int argc, char* argv[], optStruct   &Options);
 void CheckForErrorWarnings     (bool quiet, CModel *pModel);
 bool CheckForStopfile          (const int step, const time_struct &tt, CModel *pModel);
 void CallExternalScript        (const optStruct &Options, const time_struct &tt);
+void RunEnsembleMember         (CModel *pModel, optStruct &Options, const int e, const clock_t t0, time_struct &tt);
+bool RunParallelEnsemble       (CModel *pModel, optStruct &Options, const clock_t t0);
 
 #endif
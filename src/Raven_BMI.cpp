@@ -442,7 +442,7 @@ void CRavenBMI::GetValue(std::string name, void* dest)
   {
     out=new double [pModel->GetNumHRUs()];
     for (k = 0; k < pModel->GetNumHRUs(); k++) {
-      out[k]=pModel->GetHydroUnit(k)->GetStateVarArray()[iSV];
+      out[k]=pModel->GetHydroUnit(k)->GetStateVarValue(iSV);
     }
     memcpy(dest,out,pModel->GetNumSubBasins()*sizeof(double));
     delete [] out;
@@ -478,7 +478,7 @@ void CRavenBMI::GetValueAtIndices(std::string name, void* dest, int* inds, int c
   {
     for (i = 0; i <count; i++) {
       k=inds[i];
-      out[k]=pModel->GetHydroUnit(k)->GetStateVarArray()[iSV];
+      out[k]=pModel->GetHydroUnit(k)->GetStateVarValue(iSV);
     }
   }
   memcpy(dest,out,count*sizeof(double));
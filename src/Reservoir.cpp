@@ -526,6 +526,14 @@ int CReservoir::GetNumControlStructures() const
   return _nControlStructures;
 }
 //////////////////////////////////////////////////////////////////
+/// \returns true if outflow depends upon the state of other subbasins (downstream flow targets or control structure conditions)
+/// \remark such reservoirs must be routed in strict upstream-to-downstream sequence
+//
+bool CReservoir::DependsOnOtherBasins() const
+{
+  return ((_pQdownSB!=NULL) || (_nControlStructures>0));
+}
+//////////////////////////////////////////////////////////////////
 /// \returns crest width, in meters
 //
 double CReservoir::GetCrestWidth() const
@@ -1703,6 +1711,43 @@ void CReservoir::WriteToSolutionFile (ofstream &RVC) const
   }
 }
 //////////////////////////////////////////////////////////////////
+/// \brief returns number of values stored by SaveToSnapshot()
+/// \return size of reservoir state in an in-memory model snapshot
+//
+int CReservoir::GetSnapshotSize() const
+{
+  return 6+2*_nControlStructures;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief copies reservoir state variables (same as those in solution file) to in-memory snapshot
+/// \param *aSnapshot [out] snapshot array
+/// \param &ii [in/out] current position in snapshot array (incremented by GetSnapshotSize())
+//
+void CReservoir::SaveToSnapshot(double *aSnapshot, int &ii) const
+{
+  aSnapshot[ii++]=_Qout;    aSnapshot[ii++]=_Qout_last;
+  aSnapshot[ii++]=_stage;   aSnapshot[ii++]=_stage_last;
+  aSnapshot[ii++]=_DAscale; aSnapshot[ii++]=_DAscale_last;
+  for (int i = 0; i < _nControlStructures; i++) {
+    aSnapshot[ii++]=_aQstruct[i]; aSnapshot[ii++]=_aQstruct_last[i];
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief restores reservoir state variables from in-memory snapshot written by SaveToSnapshot()
+/// \note unlike SetInitialFlow(), never re-estimates stage from flow
+/// \param *aSnapshot [in] snapshot array
+/// \param &ii [in/out] current position in snapshot array (incremented by GetSnapshotSize())
+//
+void CReservoir::RestoreFromSnapshot(const double *aSnapshot, int &ii)
+{
+  _Qout   =aSnapshot[ii++]; _Qout_last   =aSnapshot[ii++];
+  _stage  =aSnapshot[ii++]; _stage_last  =aSnapshot[ii++];
+  _DAscale=aSnapshot[ii++]; _DAscale_last=aSnapshot[ii++];
+  for (int i = 0; i < _nControlStructures; i++) {
+    _aQstruct[i]=aSnapshot[ii++]; _aQstruct_last[i]=aSnapshot[ii++];
+  }
+}
+//////////////////////////////////////////////////////////////////
 /// \brief interpolates the volume from the volume-stage rating curve
 /// \param ht [in] reservoir stage
 /// \returns reservoir volume [m3] corresponding to stage ht
@@ -209,6 +209,7 @@ public:/*-------------------------------------------------------*/
   double            GetDemandMultiplier      () const;
   double            GetCrestWidth            () const;
   int               GetNumControlStructures  () const;
+  bool              DependsOnOtherBasins     () const;
   double            GetAET                   () const; //[mm/d]
   string            GetRegimeName            (const int i, const time_struct &tt) const;
   long              GetControlFlowTarget     (const int i) const;
@@ -279,6 +280,9 @@ public:/*-------------------------------------------------------*/
                                               const optStruct   &Options,
                                               const time_struct &tt);
   void              WriteToSolutionFile      (ofstream &OUT) const;
+  int               GetSnapshotSize          () const;
+  void              SaveToSnapshot           (double *aSnapshot, int &ii) const;
+  void              RestoreFromSnapshot      (const double *aSnapshot, int &ii);
   void              UpdateReservoir          (const time_struct &tt, const optStruct &Options);
   void              UpdateMassBalance        (const time_struct &tt, const double &tstep, const optStruct &Options);
   double            ScaleFlow                (const double &scale, const bool overriding,const double &tstep,const double &t);
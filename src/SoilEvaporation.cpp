@@ -767,3 +767,99 @@ void   CmvSoilEvap::ApplyConstraints( const double               *state_vars,
   }
   rates[_nConnections-1]-=corr;
 }
+
+//////////////////////////////////////////////////////////////////
+/// \brief Returns rates of loss from soil to atmosphere for a block of HRUs [mm/day]
+/// \details Method and state variable indices are resolved once per block; the single-layer
+/// HBV, TOPMODEL, linear and 'all' methods are evaluated in a tight HRU loop. Other methods
+/// (and non-standard HRUs) use GetRatesOfChange()
+///
+/// \param **state_vars [in] state variable arrays of HRUs in block
+/// \param **pHRUs [in] HRUs in block
+/// \param nHRUs [in] number of HRUs in block
+/// \param &Options [in] Global model options information
+/// \param &tt [in] Specified point at time at which this accessing takes place
+/// \param **rates [out] Rate of loss from "from" compartment for each HRU [mm/day]
+//
+void CmvSoilEvap::GetRatesOfChangeBlock(const double      *const *state_vars,
+                                        const CHydroUnit  *const *pHRUs,
+                                        const int                 nHRUs,
+                                        const optStruct          &Options,
+                                        const time_struct        &tt,
+                                              double      *const *rates) const
+{
+  if ((type!=SOILEVAP_HBV) && (type!=SOILEVAP_TOPMODEL) && (type!=SOILEVAP_LINEAR) && (type!=SOILEVAP_ALL))
+  {
+    CHydroProcessABC::GetRatesOfChangeBlock(state_vars,pHRUs,nHRUs,Options,tt,rates);
+    return;
+  }
+
+  const int  i0   =iFrom[0];
+  const int  iAET =pModel->GetStateVarIndex(AET);
+  const int  iSnow=pModel->GetStateVarIndex(SNOW);
+  const int  qAET =_nConnections-1;
+  double     PET;
+
+  for (int b=0;b<nHRUs;b++)
+  {
+    if (pHRUs[b]->GetHRUType()!=HRU_STANDARD){
+      GetRatesOfChange(state_vars[b],pHRUs[b],Options,tt,rates[b]); //Lake/Glacier case
+      continue;
+    }
+
+    PET=pHRUs[b]->GetForcingFunctions()->PET;
+    if (!Options.suppressCompetitiveET){
+      //competitive ET - reduce PET by AET
+      PET-=(state_vars[b][iAET]/Options.timestep);
+      PET=max(PET,0.0);
+    }
+
+    if      (type==SOILEVAP_LINEAR){
+      rates[b][0]=min(pHRUs[b]->GetSurfaceProps()->AET_coeff*state_vars[b][i0],PET);
+    }
+    else if (type==SOILEVAP_ALL){
+      rates[b][0]=PET;
+    }
+    else { //HBV or TOPMODEL
+      rates[b][0]=PET*min(state_vars[b][i0]/pHRUs[b]->GetSoilTensionStorageCapacity(0),1.0);
+      if ((type==SOILEVAP_HBV) && (iSnow!=DOESNT_EXIST) && (state_vars[b][iSnow]>REAL_SMALL)) {
+        rates[b][0]=(pHRUs[b]->GetSurfaceProps()->forest_coverage)*rates[b][0]; //correction for snow in non-forested areas
+      }
+    }
+    rates[b][qAET]=rates[b][0]; //updated used PET
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Corrects rates of loss from soil to atmosphere for a block of HRUs
+/// \details identical to ApplyConstraints(), applied to each HRU in block
+///
+/// \param **state_vars [in] state variable arrays of HRUs in block
+/// \param **pHRUs [in] HRUs in block
+/// \param nHRUs [in] number of HRUs in block
+/// \param &Options [in] Global model options information
+/// \param &tt [in] Specified point at time at which this accessing takes place (unused)
+/// \param **rates [out] Rate of loss from "from" compartment for each HRU [mm/day]
+//
+void CmvSoilEvap::ApplyConstraintsBlock(const double      *const *state_vars,
+                                        const CHydroUnit  *const *pHRUs,
+                                        const int                 nHRUs,
+                                        const optStruct          &Options,
+                                        const time_struct        & /*tt*/,
+                                              double      *const *rates) const
+{
+  double corr,oldrate;
+  for (int b=0;b<nHRUs;b++)
+  {
+    if (pHRUs[b]->GetHRUType()!=HRU_STANDARD){continue;}//Lake/Glacier case
+
+    corr=0.0;
+    for (int q=0;q<_nConnections-1;q++){
+      oldrate=rates[b][q];
+      //cant remove more than is there
+      rates[b][q]=threshMin(rates[b][q],state_vars[b][iFrom[q]]/Options.timestep,0.0); //presumes these are all water storage
+      corr+=oldrate-rates[b][q];
+    }
+    rates[b][_nConnections-1]-=corr;
+  }
+}
@@ -70,6 +70,18 @@ public:/*-------------------------------------------------------*/
                         const optStruct   &Options,
                         const time_struct &tt,
                         double      *rates) const;
+  void GetRatesOfChangeBlock(const double      *const *state_vars,
+                             const CHydroUnit  *const *pHRUs,
+                             const int                 nHRUs,
+                             const optStruct          &Options,
+                             const time_struct        &tt,
+                                   double      *const *rates) const;
+  void ApplyConstraintsBlock(const double      *const *state_vars,
+                             const CHydroUnit  *const *pHRUs,
+                             const int                 nHRUs,
+                             const optStruct          &Options,
+                             const time_struct        &tt,
+                                   double      *const *rates) const;
 
   void        GetParticipatingParamList   (string  *aP , class_type *aPC , int &nP) const;
   static void GetParticipatingStateVarList(baseflow_type btype,
@@ -138,6 +150,18 @@ public:/*-------------------------------------------------------*/
                         const optStruct   &Options,
                         const time_struct &tt,
                         double           *rates) const;
+  void GetRatesOfChangeBlock(const double      *const *state_vars,
+                             const CHydroUnit  *const *pHRUs,
+                             const int                 nHRUs,
+                             const optStruct          &Options,
+                             const time_struct        &tt,
+                                   double      *const *rates) const;
+  void ApplyConstraintsBlock(const double      *const *state_vars,
+                             const CHydroUnit  *const *pHRUs,
+                             const int                 nHRUs,
+                             const optStruct          &Options,
+                             const time_struct        &tt,
+                                   double      *const *rates) const;
 
   void        GetParticipatingParamList   (string *aP ,
                                            class_type *aPC,
@@ -241,6 +265,18 @@ public:/*-------------------------------------------------------*/
                         const optStruct   &Options,
                         const time_struct &tt,
                         double      *rates) const;
+  void GetRatesOfChangeBlock(const double      *const *state_vars,
+                             const CHydroUnit  *const *pHRUs,
+                             const int                 nHRUs,
+                             const optStruct          &Options,
+                             const time_struct        &tt,
+                                   double      *const *rates) const;
+  void ApplyConstraintsBlock(const double      *const *state_vars,
+                             const CHydroUnit  *const *pHRUs,
+                             const int                 nHRUs,
+                             const optStruct          &Options,
+                             const time_struct        &tt,
+                                   double      *const *rates) const;
 
   void        GetParticipatingParamList   (string  *aP , class_type *aPC , int &nP) const;
   static void GetParticipatingStateVarList(perc_type    p_type,
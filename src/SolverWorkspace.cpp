@@ -0,0 +1,164 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2023 the Raven Development Team
+  ----------------------------------------------------------------*/
+#include "SolverWorkspace.h"
+
+//////////////////////////////////////////////////////////////////
+/// \brief Constructor - reserves all solver working memory
+///
+/// \param nHRUs [in] number of HRUs in model
+/// \param nStateVars [in] number of state variables in model
+/// \param nSubBasins [in] number of subbasins in model
+/// \param nProcesses [in] number of hydrological processes in model
+/// \param nConstituents [in] number of transport constituents (transport arrays reserved only if >0)
+/// \param nThreads [in] number of threads used to process HRUs
+/// \param nRoutingThreads [in] number of threads used to route subbasins
+/// \param method [in] numerical solution method (determines which arrays are reserved)
+/// \param layout [in] layout of model state matrix; for HRU-major layout, aPhinew rows view the state matrix scratch block
+//
+CSolverWorkspace::CSolverWorkspace(const int              nHRUs,
+                                   const int              nStateVars,
+                                   const int              nSubBasins,
+                                   const int              nProcesses,
+                                   const int              nConstituents,
+                                   const int              nThreads,
+                                   const int              nRoutingThreads,
+                                   const numerical_method method,
+                                   const state_layout     layout)
+{
+  int NS=nStateVars;
+  _nHRUs     =nHRUs;
+  _nSubBasins=nSubBasins;
+  _nProcesses=nProcesses;
+  _nThreads  =max(nThreads,1);
+  _nRouteThreads=max(nRoutingThreads,1);
+
+  //state variable arrays - each stored as contiguous [nHRUs x NS] block with row pointers
+  aPhi        =NULL; _aPhiBlock     =NULL;
+  aPhiPrevIter=NULL; _aPrevIterBlock=NULL;
+  _aPhinewBlock=NULL;
+  aPhinew     =new double *[_nHRUs];
+  if (layout==LAYOUT_SV_MAJOR)
+  {
+    _aPhinewBlock=new double [_nHRUs*NS];
+    ExitGracefullyIf(_aPhinewBlock==NULL,"CSolverWorkspace::Constructor(aPhinew)",OUT_OF_MEMORY);
+    SetNewStateRows(_aPhinewBlock,NS);
+  }
+  else {
+    for (int k=0;k<_nHRUs;k++){aPhinew[k]=NULL;} //set to view state matrix scratch block by solver
+  }
+  if (method!=ORDERED_SERIES) //start-of-timestep values needed separately
+  {
+    _aPhiBlock=new double [_nHRUs*NS];
+    ExitGracefullyIf(_aPhiBlock==NULL,"CSolverWorkspace::Constructor(aPhi)",OUT_OF_MEMORY);
+    aPhi=new double *[_nHRUs];
+    for (int k=0;k<_nHRUs;k++){aPhi[k]=_aPhiBlock+k*NS;}
+  }
+  if (method==ITERATED_HEUN)
+  {
+    _aPrevIterBlock=new double [_nHRUs*NS];
+    ExitGracefullyIf(_aPrevIterBlock==NULL,"CSolverWorkspace::Constructor(aPhiPrevIter)",OUT_OF_MEMORY);
+    aPhiPrevIter=new double *[_nHRUs];
+    for (int k=0;k<_nHRUs;k++){aPhiPrevIter[k]=_aPrevIterBlock+k*NS;}
+  }
+
+  aQinnew     =new double [_nSubBasins];
+  aRouted     =new double [_nSubBasins];
+  aQoutnew    =new double *[_nRouteThreads];
+  aResQstruct =new double *[_nRouteThreads];
+  for (int n=0;n<_nRouteThreads;n++){
+    aQoutnew   [n]=new double [MAX_RIVER_SEGS];
+    aResQstruct[n]=new double [MAX_CONTROL_STRUCTURES];
+    ExitGracefullyIf(aResQstruct[n]==NULL,"CSolverWorkspace::Constructor",OUT_OF_MEMORY);
+  }
+
+  aMinnew     =NULL;
+  aMoutnew    =NULL;
+  aRoutedMass =NULL;
+  if (nConstituents>0)
+  {
+    aMinnew     =new double [_nSubBasins];
+    aRoutedMass =new double [_nSubBasins];
+    aMoutnew    =new double [MAX_RIVER_SEGS];
+    ExitGracefullyIf(aMoutnew==NULL,"CSolverWorkspace::Constructor(2)",OUT_OF_MEMORY);
+  }
+
+  rate_guess=NULL;
+  if (method==ITERATED_HEUN)
+  {
+    rate_guess = new double **[_nThreads];         //one set of guesses for each thread
+    for (int n=0;n<_nThreads;n++){
+      rate_guess[n] = new double *[_nProcesses];
+      for (int j=0;j<_nProcesses;j++){
+        rate_guess[n][j]=new double [NS*NS];       //maximum number of connections possible
+      }
+    }
+  }
+
+  //For lateral flow processes
+  kFrom         =new int   [MAX_LAT_CONNECTIONS];
+  kTo           =new int   [MAX_LAT_CONNECTIONS];
+  exchange_rates=new double[MAX_LAT_CONNECTIONS];
+
+  Reset();
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Destructor - releases all solver working memory
+//
+CSolverWorkspace::~CSolverWorkspace()
+{
+  if (DESTRUCTOR_DEBUG){cout<<"  DELETING SOLVER WORKSPACE"<<endl;}
+  delete [] aPhi;         delete [] _aPhiBlock;
+  delete [] aPhinew;      delete [] _aPhinewBlock;
+  delete [] aPhiPrevIter; delete [] _aPrevIterBlock;
+  if (rate_guess!=NULL)
+  {
+    for (int n=0;n<_nThreads;n++){
+      for (int j=0;j<_nProcesses;j++) { delete [] rate_guess[n][j]; } delete [] rate_guess[n];
+    }
+    delete [] rate_guess;
+  }
+  delete [] aQinnew;
+  for (int n=0;n<_nRouteThreads;n++){delete [] aQoutnew[n]; delete [] aResQstruct[n];}
+  delete [] aQoutnew;
+  delete [] aResQstruct;
+  delete [] aRouted;
+  delete [] aMinnew;
+  delete [] aRoutedMass;
+  delete [] aMoutnew;
+  delete [] kFrom;
+  delete [] kTo;
+  delete [] exchange_rates;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Points rows of end-of-timestep state array aPhinew into contiguous HRU-major block
+///
+/// \param block [in] contiguous state storage (e.g., model state matrix scratch block)
+/// \param ld [in] distance between consecutive HRU rows in block (>=number of state variables)
+//
+void CSolverWorkspace::SetNewStateRows(double *block, const int ld)
+{
+  for (int k=0;k<_nHRUs;k++){aPhinew[k]=block+k*ld;}
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Zeroes transport loading arrays which persist between time steps
+/// \remark called upon construction and at the end of every simulation, so that each
+///   ensemble member starts from the same solver state
+//
+void CSolverWorkspace::Reset()
+{
+  if (aMinnew!=NULL)
+  {
+    for (int p=0;p<_nSubBasins;p++) {
+      aMinnew    [p]=0.0;
+      aRoutedMass[p]=0.0;
+    }
+    for (int i=0;i<MAX_RIVER_SEGS;i++) {
+      aMoutnew   [i]=0.0;
+    }
+  }
+}
@@ -0,0 +1,67 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2023 the Raven Development Team
+  ----------------------------------------------------------------
+  class definitions:
+  CSolverWorkspace
+  ----------------------------------------------------------------*/
+
+#ifndef SOLVERWORKSPACE_H
+#define SOLVERWORKSPACE_H
+
+#include "RavenInclude.h"
+
+///////////////////////////////////////////////////////////////////
+/// \brief Data abstraction for working memory used by MassEnergyBalance()
+/// \details Each model owns its own workspace, allocated once in CModel::Initialize(),
+///   such that multiple models (or ensemble members) may be solved within a single process.
+///   Members are public and used directly as scratch arrays by the solver
+//
+class CSolverWorkspace
+{
+private:/*------------------------------------------------------*/
+  int        _nHRUs;          ///< number of HRUs (first dimension of state variable arrays)
+  int        _nSubBasins;     ///< number of subbasins
+  int        _nProcesses;     ///< number of hydrological processes (second dimension of rate_guess)
+  int        _nThreads;       ///< number of threads (first dimension of rate_guess)
+  int        _nRouteThreads;  ///< number of routing threads (first dimension of aQoutnew and aResQstruct)
+
+  double    *_aPhiBlock;      ///< contiguous storage of aPhi (NULL if not required by solution method)
+  double    *_aPhinewBlock;   ///< contiguous storage of aPhinew (NULL if rows view model state matrix)
+  double    *_aPrevIterBlock; ///< contiguous storage of aPhiPrevIter (NULL if not required by solution method)
+
+public:/*-------------------------------------------------------*/
+  double   **aPhi;            ///< [mm;C;mg/m2;MJ/m2] state variable arrays at start of timestep [size: nHRUs x NS] (NULL for ordered series method)
+  double   **aPhinew;         ///< [mm;C;mg/m2;MJ/m2] state variable arrays at end of timestep; value after convergence [size: nHRUs x NS]
+  double   **aPhiPrevIter;    ///< [mm;C;mg/m2;MJ/m2] state variable arrays from previous iteration [size: nHRUs x NS] (NULL for non-iterative methods)
+
+  double    *aQinnew;         ///< [m3/s] inflow rate to subbasin reach p at t+dt [size: nSubBasins]
+  double   **aQoutnew;        ///< [m3/s] final outflow from reach segment seg at time t+dt, for each routing thread [size: nRoutingThreads x MAX_RIVER_SEGS]
+  double   **aResQstruct;     ///< [m3/s] reservoir control structure outflows, for each routing thread [size: nRoutingThreads x MAX_CONTROL_STRUCTURES]
+  double    *aRouted;         ///< [m3] volume of water routed from HRUs to subbasin p [size: nSubBasins]
+
+  double    *aMinnew;         ///< [mg/d] or [MJ/d] mass/energy loading of constituents to subbasin reach p at t+dt [size: nSubBasins] (NULL w/o transport)
+  double    *aMoutnew;        ///< [mg/d] or [MJ/d] final mass/energy output from reach segment seg at time t+dt [size: MAX_RIVER_SEGS] (NULL w/o transport)
+  double    *aRoutedMass;     ///< [mg/d] or [MJ/d] amount of mass/energy [size: nSubBasins] (NULL w/o transport)
+
+  double  ***rate_guess;      ///< rate guesses for iterated Heun method [size: nThreads x nProcesses x NS*NS] (NULL for other methods)
+
+  int       *kFrom;           ///< HRU indices of lateral exchange sources [size: MAX_LAT_CONNECTIONS]
+  int       *kTo;             ///< HRU indices of lateral exchange recipients [size: MAX_LAT_CONNECTIONS]
+  double    *exchange_rates;  ///< lateral exchange rates [size: MAX_LAT_CONNECTIONS]
+
+  CSolverWorkspace(const int              nHRUs,
+                   const int              nStateVars,
+                   const int              nSubBasins,
+                   const int              nProcesses,
+                   const int              nConstituents,
+                   const int              nThreads,
+                   const int              nRoutingThreads,
+                   const numerical_method method,
+                   const state_layout     layout);
+  ~CSolverWorkspace();
+
+  void SetNewStateRows(double *block, const int ld);
+  void Reset();
+};
+#endif
@@ -6,6 +6,305 @@
 #include "RavenInclude.h"
 #include "Model.h"
 #include "GWRiverConnection.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+///////////////////////////////////////////////////////////////////
+/// \brief Applies all processes to one block of consecutive HRUs using the ordered series or Euler approach
+/// \remark Only rows of HRUs in block are modified, so blocks may be processed simultaneously
+///
+/// \param *pModel [in & out] Model
+/// \param *pPlan [in] precompiled sequence of processes applied to each HRU block
+/// \param **aPhiRates [in] state variable arrays used to calculate rates: aPhinew for ordered series (newest states), aPhi for Euler (start of timestep)
+/// \param **aPhinew [in & out] state variable arrays at end of timestep [size: nHRUs x NS]
+/// \param kb [in] global index of first HRU in block
+/// \param nb [in] number of HRUs in block
+/// \param &Options [in] Global model options information
+/// \param &tt [in] Time structure at start of timestep
+//
+static void SolveHRUBlock(CModel               *pModel,
+                          const CExecutionPlan *pPlan,
+                          double              **aPhiRates,
+                          double              **aPhinew,
+                          const int             kb,
+                          const int             nb,
+                          const optStruct      &Options,
+                          const time_struct    &tt)
+{
+  int     j,k,q,qs,nConnections;
+  double  tstep=Options.timestep;
+  double  block_rates[MAX_HRU_BLOCK][MAX_CONNECTIONS];
+  double *aRates     [MAX_HRU_BLOCK];
+  for (int b=0;b<nb;b++){aRates[b]=block_rates[b];}
+  bool    overrides=(Options.sol_method==ORDERED_SERIES) && (pPlan->GetBlockSize()==1);
+  if (overrides){pModel->ApplyLocalParamOverrrides(kb, false);}
+
+  for(int n=0;n<pPlan->GetNumActive(kb);n++)
+  {
+    j=pPlan->GetActiveProcess(kb,n);
+    const unsigned int mask =pPlan->GetActiveMask(kb,n);  //HRUs in block to which process j applies
+    const int         *pFrom=pPlan->GetFromIndices(j);
+    const int         *pTo  =pPlan->GetToIndices  (j);
+    const conn_type   *ctype=pPlan->GetConnTypes  (j);
+    nConnections=pPlan->GetNumConnections (j);
+    qs          =pPlan->GetFirstConnection(j);
+
+    pModel->ApplyProcessBlock(j,kb,nb,mask,aPhiRates+kb,Options,tt,aRates); //note for ordered series, aPhiRates is newest state variable vector
+
+    for(q=0;q<nConnections;q++)//each process may have multiple connections
+    {
+      for(int b=0;b<nb;b++)
+      {
+        if (!(mask & (1u<<b))){continue;}
+        k=kb+b;
+        double &rate=aRates[b][q];
+        switch (ctype[q])
+        {
+        case CONN_EXCHANGE:
+          aPhinew[k][pFrom[q]]-=rate*tstep;//mass/energy balance maintained
+          aPhinew[k][pTo  [q]]+=rate*tstep;//change is an exchange of energy or mass, which must be preserved
+          break;
+        case CONN_TO_ITSELF:
+          rate=0.0;
+          aPhinew[k][pTo  [q]]+=0.0;       //likely from redirect - water moves back to itself
+          break;
+        case CONN_ACCUMULATE:
+          aPhinew[k][pTo  [q]]+=rate*tstep;//for state vars that are not storage compartments
+          break;
+        }
+        pModel->IncrementBalance(qs+q,k,rate*tstep);   //this is only this easy for Euler/Ordered!
+      }
+    }//end for q=0 to nConnections
+  }//end for n=0 to number of active processes
+
+  if (overrides){pModel->ApplyLocalParamOverrrides(kb, true);}
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief Moves surface water of (enabled) HRU k to its subbasin reach or reservoir, tracking net runoff
+///
+/// \param *pModel [in & out] Model
+/// \param k [in] global HRU index
+/// \param **aPhinew [in & out] state variable arrays at end of timestep
+/// \param *aRouted [in & out] [m3] volume delivered to each subbasin reach over timestep [size: nSubBasins]
+/// \param iSW [in] surface water state variable index
+/// \param iRO [in] runoff state variable index
+//
+static void CollectHRURunoff(CModel *pModel, const int k, double **aPhinew, double *aRouted, const int iSW, const int iRO)
+{
+  CHydroUnit *pHRU=pModel->GetHydroUnit(k);
+  int    p    =pHRU->GetSubBasinIndex();
+  double SWvol=(aPhinew[k][iSW]/MM_PER_METER)*(pHRU->GetArea()*M2_PER_KM2);//[m3]
+  if(pHRU->IsLinkedToReservoir()) {
+    pModel->GetSubBasin(p)->GetReservoir()->SetPrecip(SWvol);//[SW is treated as precip on reservoir]
+  }
+  else{
+    //surface water moved instantaneously from HRU to basin reach/channel storage
+    aRouted[p]+=SWvol;
+  }
+  aPhinew[k][iRO]=aPhinew[k][iSW]; //track net runoff [mm]
+  aPhinew[k][iSW]=0.0;             //zero out surface water storage
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief Adds diversions and specified inflows to subbasin inflows and prepares all subbasins for routing
+/// \remark diversions are based upon flows at start of timestep, so this may precede routing of any subbasin
+///
+/// \param *pModel [in & out] Model
+/// \param *aQinnew [in & out] [m3/s] inflow rate to each subbasin reach at t+dt [size: nSubBasins]
+/// \param *aRouted [in & out] [m3] volume delivered to each subbasin reach over timestep [size: nSubBasins]
+/// \param *pGW2River [in] groundwater model river connection (NULL if not coupled to groundwater model)
+/// \param &Options [in] Global model options information
+/// \param &tt [in] Time structure at start of timestep
+/// \param update_basins [in] true if UpdateSubBasin() is to be called for each subbasin here; if false, the caller must
+///   call it for each subbasin after runoff has been collected from its HRUs and before it is routed
+//
+static void PrepareSubBasinInflows(CModel                   *pModel,
+                                   double                   *aQinnew,
+                                   double                   *aRouted,
+                                   const CGWRiverConnection *pGW2River,
+                                   const optStruct          &Options,
+                                   const time_struct        &tt,
+                                   const bool                update_basins)
+{
+  double div_Q;
+  int    pDivert;
+  double tstep=Options.timestep;
+  for(int p=0;p<pModel->GetNumSubBasins();p++)
+  {
+    //Regular Diversions
+    CSubBasin *pBasin=pModel->GetSubBasin(p);
+    for(int i=0; i<pBasin->GetNumDiversions();i++) {
+      div_Q=pBasin->GetDiversionFlow(i,pBasin->GetChannelOutflowRate(),Options,tt,pDivert); //diversions based upon flows at start of timestep
+      if(pDivert!=DOESNT_EXIST)
+      {
+        aQinnew[pDivert]+=div_Q;
+      }
+    }
+    //Diversions from reservoir control structures
+    CReservoir *pRes=pBasin->GetReservoir();
+    if (pRes != NULL) {
+      for (int i = 0; i < pRes->GetNumControlStructures(); i++) {
+        if (pRes->GetControlFlowTarget(i) != pBasin->GetDownstreamID()) {
+          pDivert=pModel->GetSubBasinIndex(pRes->GetControlFlowTarget(i)); //p, not SBID
+          if (pDivert!=DOESNT_EXIST){
+            aQinnew[pDivert]+=pRes->GetControlOutflow(i);
+          }
+        }
+      }
+    }
+    //User-specified inflows to upstream end of subbasin reach
+    aQinnew[p]+=pBasin->GetSpecifiedInflow(tt.model_time+tstep);
+
+    //groundwater contributions to reach
+    if (pGW2River!=NULL)
+    {
+      aRouted[p]+= pGW2River->CalcRiverFlowBySB(p)*tstep;      // [m3]
+    }
+
+    //preparatory step prior to routing: used to assimilate lake levels and update routing hydrograph for timestep
+    if (update_basins){pBasin->UpdateSubBasin(tt,Options);}
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief Routes water through reach and reservoir of (enabled) subbasin p over timestep
+/// \remark Subbasins which do not drain into one another may be routed simultaneously, provided each thread uses its own scratch arrays
+///
+/// \param *pModel [in & out] Model
+/// \param p [in] subbasin index
+/// \param *aQinnew [in] [m3/s] inflow rate to each subbasin reach at t+dt [size: nSubBasins]
+/// \param *aRouted [in] [m3] volume delivered to each subbasin reach over timestep [size: nSubBasins]
+/// \param *aQout [out] scratch array for reach segment outflows [size: MAX_RIVER_SEGS]
+/// \param *aQstruct [out] scratch array for reservoir control structure outflows [size: MAX_CONTROL_STRUCTURES]
+/// \param &Options [in] Global model options information
+/// \param &tt [in] Time structure at start of timestep
+//
+static void RouteSubBasin(CModel            *pModel,
+                          const int          p,
+                          const double      *aQinnew,
+                          const double      *aRouted,
+                          double            *aQout,
+                          double            *aQstruct,
+                          const optStruct   &Options,
+                          const time_struct &tt)
+{
+  double res_ht,res_outflow,down_Q,irr_Q,div_Q_total;
+  int    pDiv;
+  res_constraint res_const;
+  double t    =tt.model_time;
+  double tstep=Options.timestep;
+  CSubBasin *pB=pModel->GetSubBasin(p);
+
+  pB->UpdateInflow(aQinnew[p]);                  // from upstream, diversions, and specified flows
+
+  down_Q=pB->GetDownstreamInflow(t);             // treated as additional runoff (period starting)
+
+  pB->UpdateLateralInflow(aRouted[p]/(tstep*SEC_PER_DAY)+down_Q);//[m3/d]->[m3/s]
+
+  pB->RouteWater    (aQout,Options,tt);
+
+  irr_Q=pB->ApplyIrrigationDemand(t+tstep,aQout[pB->GetNumSegments()-1],Options.management_optimization);
+
+  div_Q_total=0;
+  for(int i=0; i<pB->GetNumDiversions();i++) { //downstream of reservoir!
+    div_Q_total+=pB->GetDiversionFlow(i,pB->GetChannelOutflowRate(),Options,tt,pDiv); //diversions based upon flows at start of timestep (without diversions)
+  }
+
+  res_ht=res_outflow=0.0; res_const=RC_NATURAL;
+  if (pB->GetReservoir()!=NULL)
+  {
+    double res_inflow_last = pB->GetOutflowArray()[pB->GetNumSegments()-1];
+    double res_inflow =max((aQout[pB->GetNumSegments()-1]-div_Q_total-irr_Q),0.0);
+    res_ht=pB->GetReservoir()->RouteWater(res_inflow_last,res_inflow,pModel,Options,tt,res_outflow,res_const,aQstruct);
+  }
+
+  pB->UpdateOutflows(aQout,irr_Q,div_Q_total,res_ht,res_outflow,res_const,aQstruct,Options,tt,false);//actually updates flow values here
+}
+
+///////////////////////////////////////////////////////////////////
+/// \brief Solver state shared by all tasks of task graph within one timestep
+//
+struct task_context
+{
+  CModel               *pModel;
+  CTaskGraph           *pTG;
+  const CExecutionPlan *pPlan;
+  double              **aPhinew;     ///< [mm;C;mg/m2;MJ/m2] state variable arrays at end of timestep
+  double               *aQinnew;     ///< [m3/s] inflow rate to each subbasin reach at t+dt
+  double               *aRouted;     ///< [m3] volume delivered to each subbasin reach over timestep
+  double              **aQoutnew;    ///< [m3/s] reach segment outflows, for each thread
+  double              **aResQstruct; ///< [m3/s] reservoir control structure outflows, for each thread
+  int                   iSW,iRO,iAET;
+  const optStruct      *pOptions;
+  const time_struct    *pTime;
+};
+
+///////////////////////////////////////////////////////////////////
+/// \brief Executes task n of task graph, then spawns each dependent task whose dependencies are all complete
+/// \details HRU block tasks apply all processes to the block. Routing tasks collect runoff from the HRUs of the
+///   subbasin (in ascending order), prepare the subbasin for routing (UpdateSubBasin()), add outflows of upstream
+///   subbasins (in routing order) and route the subbasin, so that the order of all floating point operations is
+///   identical to staged scheduling
+///
+/// \param n [in] task index
+/// \param *pTC [in] solver state shared by all tasks
+//
+static void ExecuteTask(const int n, const task_context *pTC)
+{
+  CModel     *pModel=pTC->pModel;
+  CTaskGraph *pTG   =pTC->pTG;
+  if (pTG->IsHRUBlockTask(n))
+  {
+    SolveHRUBlock(pModel,pTC->pPlan,pTC->aPhinew,pTC->aPhinew,pTG->GetBlockStart(n),pTG->GetBlockSize(n),*(pTC->pOptions),*(pTC->pTime));
+  }
+  else
+  {
+    int th=0; //thread index
+#ifdef _OPENMP
+    th=omp_get_thread_num();
+#endif
+    int        p     =pTG->GetSubBasinIndex(n);
+    CSubBasin *pBasin=pModel->GetSubBasin(p);
+    for (int i=0;i<pTG->GetNumBasinHRUs(p);i++)
+    {
+      int k=pTG->GetBasinHRU(p,i);
+      if (pModel->GetHydroUnit(k)->IsEnabled()){
+        CollectHRURunoff(pModel,k,pTC->aPhinew,pTC->aRouted,pTC->iSW,pTC->iRO);
+      }
+    }
+    pBasin->UpdateSubBasin(*(pTC->pTime),*(pTC->pOptions)); //after all HRUs draining to subbasin are processed
+
+    if (pBasin->IsEnabled())
+    {
+      for (int i=0;i<pTG->GetNumUpstream(p);i++)
+      {
+        CSubBasin *pUp=pModel->GetSubBasin(pTG->GetUpstream(p,i));
+        if (pUp->IsEnabled()){pTC->aQinnew[p]+=pUp->GetOutflowRate();}
+      }
+
+      RouteSubBasin(pModel,p,pTC->aQinnew,pTC->aRouted,pTC->aQoutnew[th],pTC->aResQstruct[th],*(pTC->pOptions),*(pTC->pTime));
+
+      if(pBasin->GetReservoir()!=NULL) {//update AET for reservoir-linked HRUs
+        int k=pBasin->GetReservoir()->GetHRUIndex();
+        if ((k!=DOESNT_EXIST) && (pTC->iAET!=DOESNT_EXIST)){
+          pTC->aPhinew[k][pTC->iAET]=pBasin->GetReservoir()->GetAET();//[mm/d]
+        }
+      }
+    }
+  }
+
+  for (int i=0;i<pTG->GetNumSuccessors(n);i++)
+  {
+    int s=pTG->GetSuccessor(n,i);
+    if (pTG->Release(s))
+    {
+      #pragma omp task firstprivate(s,pTC)
+      ExecuteTask(s,pTC);
+    }
+  }
+}
 
 ///////////////////////////////////////////////////////////////////
 /// \brief Solves system of energy and mass balance ODEs/PDEs for one timestep
@@ -22,11 +321,11 @@ void MassEnergyBalance( CModel            *pModel,
   int i,j,k,p,pp,pTo,q,qs,c;                   //counters
   int NS,NB,nHRUs,nConnections=0,nProcesses;   //array sizes (local copies)
   int nConstituents;                           //
+  int nThreads;                                //number of threads used to process HRUs
   int iSW, iAtm, iAET, iGW, iRO;               //Surface water, atmospheric precip, used PET, runoff indices
 
   int                iFrom          [MAX_CONNECTIONS]; //arrays used to pass values through GetRatesOfChange routines
   int                iTo            [MAX_CONNECTIONS];
-  double             rates_of_change[MAX_CONNECTIONS];
 
   double             tstep;       //[d] timestep
   double             t;           //[d] model time
@@ -34,26 +333,13 @@ void MassEnergyBalance( CModel            *pModel,
 
   CHydroUnit        *pHRU;        //pointer to current HRU
   CSubBasin         *pBasin;      //pointer to current SubBasin
-  CGroundwaterModel *pGWModel;    //pointer to GW model
-  CGWRiverConnection*pGW2River;   //pointer to GW model river connection
-
-  static double    **aPhi=NULL;   //[mm;C;mg/m2;MJ/m2] state variable arrays at initial, intermediate times;
-  static double    **aPhinew;     //[mm;C;mg/m2;MJ/m2] state variable arrays at end of timestep; value after convergence
-  static double    **aPhiPrevIter;
-
-  static double     *aQinnew;     //[m3/s] inflow rate to subbasin reach p at t+dt [size=_nSubBasins]
-  static double     *aQoutnew;    //[m3/s] final outflow from reach segment seg at time t+dt [size=MAX_RIVER_SEGS]
-  static double     *aRouted;     //[m3]
+  CGroundwaterModel *pGWModel=NULL;  //pointer to GW model
+  CGWRiverConnection*pGW2River=NULL; //pointer to GW model river connection
 
-  static double     *aMinnew;     //[mg/d] or [MJ/d] mass/energy loading of constituents to subbasin reach p at t+dt [size=_nSubBasins]
-  static double     *aMoutnew;    //[mg/d] or [MJ/d] final mass/energy output from reach segment seg at time t+dt [size= MAX_RIVER_SEGS]
-  static double     *aRoutedMass; //[mg/d] or [MJ/d] amount of mass/energy [size= _nSubBasins]
-
-  static double    **rate_guess;  //need to set first array to nProcesses
-
-  static int        *kFrom;
-  static int        *kTo;
-  static double     *exchange_rates=NULL;
+  CSolverWorkspace  *pWS;         //pointer to model-owned solver working memory
+  CStateMatrix      *pSM;         //pointer to model-wide state variable storage
+  const CExecutionPlan *pPlan;    //pointer to precompiled sequence of processes applied to each HRU
+  CTaskGraph        *pTG;         //pointer to task graph (NULL unless task graph scheduling is used)
 
   //local shorthand for often-used variables
   NS           =pModel->GetNumStateVars();
@@ -61,63 +347,37 @@ void MassEnergyBalance( CModel            *pModel,
   nHRUs        =pModel->GetNumHRUs();
   nProcesses   =pModel->GetNumProcesses();
   nConstituents=pModel->GetTransportModel()->GetNumConstituents();
+  nThreads     =pModel->GetNumThreads();
   tstep        =Options.timestep;
   t            =tt.model_time;
 
   JulianConvert(t+tstep,Options.julian_start_day,Options.julian_start_year,Options.calendar,tt_end);
 
-  //Reserve static memory ===========================================
-  //(only gets called once in course of simulation)
-  if (aPhi==NULL)
-  {
+  //Retrieve working memory (reserved once in CModel::Initialize) ===
+  pWS=pModel->GetSolverWorkspace();
+  pSM=pModel->GetStateMatrix();
+  pPlan=pModel->GetExecutionPlan();
+  pTG  =pModel->GetTaskGraph();
+  ExitGracefullyIf((pWS==NULL) || (pSM==NULL) || (pPlan==NULL),"MassEnergyBalance: model must be initialized before solving",RUNTIME_ERR);
 
-    aPhi        =new double *[nHRUs];
-    aPhinew     =new double *[nHRUs];
-    aPhiPrevIter=new double *[nHRUs];
+  double          **aPhi          =pWS->aPhi;         //[mm;C;mg/m2;MJ/m2] state variable arrays at start of timestep (NULL for ORDERED_SERIES)
+  double          **aPhinew       =pWS->aPhinew;      //[mm;C;mg/m2;MJ/m2] state variable arrays at end of timestep; value after convergence
+  double          **aPhiPrevIter  =pWS->aPhiPrevIter; //[mm;C;mg/m2;MJ/m2] state variable arrays from previous iteration (ITERATED_HEUN only)
 
-    for (k=0;k<nHRUs;k++)
-    {
-      aPhi[k]        =new double [NS];
-      aPhinew[k]     =new double [NS];
-      aPhiPrevIter[k]=new double [NS];
-    }
+  double           *aQinnew       =pWS->aQinnew;      //[m3/s] inflow rate to subbasin reach p at t+dt [size=_nSubBasins]
+  double          **aQoutnew      =pWS->aQoutnew;     //[m3/s] final outflow from reach segment seg at time t+dt, for each routing thread [size=nRouteThreads x MAX_RIVER_SEGS]
+  double          **aResQstruct   =pWS->aResQstruct;  //[m3/s] reservoir control structure outflows, for each routing thread [size=nRouteThreads x MAX_CONTROL_STRUCTURES]
+  double           *aRouted       =pWS->aRouted;      //[m3]
 
-    aQoutnew    =NULL;
-    aQinnew     =new double [NB];
-    aRouted     =new double [NB];
-    aQoutnew    =new double [MAX_RIVER_SEGS];
-    ExitGracefullyIf(aQoutnew==NULL,"MassEnergyBalance",OUT_OF_MEMORY);
+  double           *aMinnew       =pWS->aMinnew;      //[mg/d] or [MJ/d] mass/energy loading of constituents to subbasin reach p at t+dt [size=_nSubBasins]
+  double           *aMoutnew      =pWS->aMoutnew;     //[mg/d] or [MJ/d] final mass/energy output from reach segment seg at time t+dt [size= MAX_RIVER_SEGS]
+  double           *aRoutedMass   =pWS->aRoutedMass;  //[mg/d] or [MJ/d] amount of mass/energy [size= _nSubBasins]
 
-    aMinnew     =NULL;
-    aMoutnew    =NULL;
-    aRoutedMass =NULL;
-    if(nConstituents>0)
-    {
-      aMinnew     =new double [NB];
-      aRoutedMass =new double [NB];
-      aMoutnew    =new double[MAX_RIVER_SEGS];
-      ExitGracefullyIf(aMoutnew==NULL,"MassEnergyBalance(2)",OUT_OF_MEMORY);
-      for(p=0;p<NB;p++) {
-        aMinnew    [p] =0;
-        aRoutedMass[p] =0;
-      }
-      for(i=0;i<MAX_RIVER_SEGS;i++) {
-        aMoutnew   [i]=0.0;
-      }
-    }
+  double         ***rate_guess    =pWS->rate_guess;   //[thread][process][connection]
 
-    if(Options.sol_method==ITERATED_HEUN)
-    {
-      rate_guess = new double *[nProcesses];    //need to set first array to numProcesses
-      for (j=0;j<nProcesses;j++){
-        rate_guess[j]=new double [NS*NS];       //maximum number of connections possible
-      }
-    }
-    //For lateral flow processes
-    kFrom         =new int   [MAX_LAT_CONNECTIONS];
-    kTo           =new int   [MAX_LAT_CONNECTIONS];
-    exchange_rates=new double[MAX_LAT_CONNECTIONS];
-  }//end static memory if
+  int              *kFrom         =pWS->kFrom;
+  int              *kTo           =pWS->kTo;
+  double           *exchange_rates=pWS->exchange_rates;
 
   if(Options.modeltype == MODELTYPE_COUPLED)
   {
@@ -130,16 +390,24 @@ void MassEnergyBalance( CModel            *pModel,
   {
     iFrom          [i]=DOESNT_EXIST;
     iTo            [i]=DOESNT_EXIST;
-    rates_of_change[i]=0.0;
   }
-  for (k=0;k<nHRUs;k++)
+  // HRU-major storage: end-of-timestep states are computed in the state matrix scratch block
+  // (one contiguous copy), which becomes the current block at the end of the timestep
+  if (pSM->GetLayout()==LAYOUT_HRU_MAJOR)
   {
-    pHRU=pModel->GetHydroUnit(k);
-    for (i=0;i<NS ;i++)
-    {
-      aPhi        [k][i]=pHRU->GetStateVarValue(i);
-      aPhinew     [k][i]=aPhi[k][i];
-      aPhiPrevIter[k][i]=aPhi[k][i];
+    pSM->CopyToScratch();
+    pWS->SetNewStateRows(pSM->GetScratch(),pSM->GetHRUStride());
+  }
+  else
+  {
+    for (i=0;i<NS;i++){
+      const double *col=pSM->GetData()+i*pSM->GetSVStride();
+      for (k=0;k<nHRUs;k++){aPhinew[k][i]=col[k];}
+    }
+  }
+  if (aPhi!=NULL){
+    for (k=0;k<nHRUs;k++){
+      for (i=0;i<NS;i++){aPhi[k][i]=aPhinew[k][i];}
     }
   }
 
@@ -152,17 +420,15 @@ void MassEnergyBalance( CModel            *pModel,
   if(iAET!=DOESNT_EXIST) {
     for(k=0;k<nHRUs;k++)
     {
-      aPhi        [k][iAET]=0.0;
-      aPhinew     [k][iAET]=0.0;
-      aPhiPrevIter[k][iAET]=0.0;
+      if (aPhi!=NULL){aPhi[k][iAET]=0.0;}
+      aPhinew[k][iAET]=0.0;
     }
   }
   if(iRO!=DOESNT_EXIST) {
     for(k=0;k<nHRUs;k++)
     {
-      aPhi        [k][iRO ]=0.0;
-      aPhinew     [k][iRO ]=0.0;
-      aPhiPrevIter[k][iRO ]=0.0;
+      if (aPhi!=NULL){aPhi[k][iRO ]=0.0;}
+      aPhinew[k][iRO ]=0.0;
     }
   }
 
@@ -171,65 +437,68 @@ void MassEnergyBalance( CModel            *pModel,
   if(iGW!=DOESNT_EXIST) {
     for(k=0;k<nHRUs;k++)
     {
-      aPhi        [k][iGW]=0.0;
-      aPhinew     [k][iGW]=0.0;
-      aPhiPrevIter[k][iGW]=0.0;
+      if (aPhi!=NULL){aPhi[k][iGW]=0.0;}
+      aPhinew[k][iGW]=0.0;
     }
   }
 
+  // HRUs are independent of one another until lateral exchange/routing below, and may be processed in parallel.
+  // Each thread uses its own connection arrays; IncrementBalance only modifies the row of HRU k,
+  // so the results are identical to serial processing regardless of the number of threads
+  const int HRU_CHUNK=16; //number of HRUs dispatched to a thread at a time
+
   //=================================================================
-  //==Standard (in series) approach==================================
-  // -order is critical!
-  if (Options.sol_method==ORDERED_SERIES)
+  //==Task graph scheduling (ordered series only)====================
+  // HRU blocks and subbasin routing are executed as tasks: each subbasin is routed as soon as all of its
+  // HRUs and upstream subbasins are complete, overlapping HRU processing with routing. Routing is completed here
+  if (pTG!=NULL)
   {
-    for (k=0;k<nHRUs;k++)
+    for (p=0;p<NB;p++)
     {
-      pHRU=pModel->GetHydroUnit(k);
-      pModel->ApplyLocalParamOverrrides(k, false);
-
-      if(pHRU->IsEnabled())
+      aRouted[p]=0.0;
+      aQinnew[p]=0.0;
+    }
+    PrepareSubBasinInflows(pModel,aQinnew,aRouted,NULL,Options,tt,false); //diversions use start-of-timestep flows
+
+    task_context TC;
+    TC.pModel=pModel;  TC.pTG=pTG;  TC.pPlan=pPlan;
+    TC.aPhinew=aPhinew; TC.aQinnew=aQinnew; TC.aRouted=aRouted;
+    TC.aQoutnew=aQoutnew; TC.aResQstruct=aResQstruct;
+    TC.iSW=iSW; TC.iRO=iRO; TC.iAET=iAET;
+    TC.pOptions=&Options; TC.pTime=&tt;
+    const task_context *pTC=&TC;
+
+    pTG->Reset();
+    #pragma omp parallel num_threads(nThreads)
+    {
+      #pragma omp single
       {
-        qs=0;
-        for(j=0;j<nProcesses;j++)
+        for (int n=0;n<pTG->GetNumTasks();n++)
         {
-          nConnections=0;
-          if(pModel->ApplyProcess(j,aPhinew[k],pHRU,Options,tt,iFrom,iTo,nConnections,rates_of_change)) //note aPhinew is newest state variable vector
-          {
-#ifdef _STRICTCHECK_
-            if(nConnections>MAX_CONNECTIONS) {
-              cout<<nConnections<<endl;
-              ExitGracefully("MassEnergyBalance:: Maximum number of connections exceeded. Please contact author.",RUNTIME_ERR); }
-#endif
-            for(q=0;q<nConnections;q++)//each process may have multiple connections
-            {
-              sv_type typ=pModel->GetStateVarType(iFrom[q]);
-              if(iTo[q]!=iFrom[q]) {
-                aPhinew[k][iFrom[q]]-=rates_of_change[q]*tstep;//mass/energy balance maintained
-                aPhinew[k][iTo  [q]]+=rates_of_change[q]*tstep;//change is an exchange of energy or mass, which must be preserved
-              }
-              else if (CStateVariable::IsWaterStorage(typ) && (typ!=CONVOLUTION)){
-                rates_of_change[q]=0.0;
-                aPhinew[k][iTo  [q]]+=0.0; //likely from redirect - water moves back to itself
-              }
-              else {
-                aPhinew[k][iTo  [q]]+=rates_of_change[q]*tstep;//for state vars that are not storage compartments
-              }
-              pModel->IncrementBalance(qs,k,rates_of_change[q]*tstep);   //this is only this easy for Euler/Ordered!
-              qs++;
-            }//end for q=0 to nConnections
-          }// end if (pModel->ApplyProcess
-          else
+          if (pTG->IsInitiallyReady(n))
           {
-            for(q=0;q<nConnections;q++)
-            {
-              pModel->IncrementBalance(qs,k,0.0);
-              qs++;
-            }
+            #pragma omp task firstprivate(n,pTC)
+            ExecuteTask(n,pTC);
           }
-        }//end for j=0 to nProcesses
+        }
       }
-      pModel->ApplyLocalParamOverrrides(k, true);
-    }//end for k=0 to nHRUs
+    }//all tasks complete at end of parallel region
+  }
+  //=================================================================
+  //==Standard (in series) approach==================================
+  // -order is critical!
+  else if (Options.sol_method==ORDERED_SERIES)
+  {
+    // HRUs are processed in blocks of nBlock: each process is evaluated for all HRUs in the block with one
+    // (batched) call, then applied; the order of processes applied to any single HRU is unchanged.
+    // Only processes which apply to the block (per the execution plan) are visited
+    const int nBlock=pPlan->GetBlockSize();
+
+    #pragma omp parallel for schedule(dynamic,1) num_threads(nThreads) if(nThreads>1)
+    for (int kb=0;kb<nHRUs;kb+=nBlock)
+    {
+      SolveHRUBlock(pModel,pPlan,aPhinew,aPhinew,kb,min(nBlock,nHRUs-kb),Options,tt);
+    }//end for kb=0 to nHRUs
 
   }//end if Options.sol_method==ORDERED_SERIES
 
@@ -238,52 +507,14 @@ void MassEnergyBalance( CModel            *pModel,
   // -order of processes doesn't matter
   else if (Options.sol_method==EULER)
   {
-    for (k=0;k<nHRUs;k++)
-    {
-      pHRU=pModel->GetHydroUnit(k);
+    // As for ordered series, but all rates are calculated from start-of-timestep states aPhi
+    const int nBlock=pPlan->GetBlockSize();
 
-      //model all hydrologic processes occuring at HRU scale
-      //-----------------------------------------------------------------
-      qs=0;
-      for (j=0;j<nProcesses;j++)
-      {
-        nConnections=0;
-
-        if (pModel->ApplyProcess(j,aPhi   [k],pHRU,Options,tt,iFrom,iTo,nConnections,rates_of_change))//note aPhi is info from start of timestep
-        {
-#ifdef _STRICTCHECK_
-          if(nConnections>MAX_CONNECTIONS) {
-            cout<<nConnections<<endl;
-            ExitGracefully("MassEnergyBalance:: Maximum number of connections exceeded. Please contact author.",RUNTIME_ERR);}
-#endif
-          for (q=0;q<nConnections;q++)//each process may have multiple connections
-          {
-            sv_type typ=pModel->GetStateVarType(iFrom[q]);
-            if (iTo[q]!=iFrom[q]){
-              aPhinew[k][iFrom[q]]-=rates_of_change[q]*tstep;//mass/energy balance maintained
-              aPhinew[k][iTo  [q]]+=rates_of_change[q]*tstep;//change is an exchange of energy or mass, which must be preserved
-            }
-            else if (CStateVariable::IsWaterStorage(typ) && (typ!=CONVOLUTION)){
-              rates_of_change[q]=0.0;
-              aPhinew[k][iTo  [q]]+=0.0; //likely from redirect - water moves back to itself
-            }
-            else{
-              aPhinew[k][iTo  [q]]+=rates_of_change[q]*tstep;//for state vars that are not storage compartments
-            }
-            pModel->IncrementBalance(qs,k,rates_of_change[q]*tstep);//this is only this easy for Euler/Ordered!
-            qs++;
-          }//end for q=0 to nConnections
-        }
-        else
-        {
-          for(q=0;q<nConnections;q++)
-          {
-            pModel->IncrementBalance(qs,k,0.0);
-            qs++;
-          }
-        }
-      }//end for j=0 to nProcesses
-    }//end for k=0 to nHRUs
+    #pragma omp parallel for schedule(dynamic,1) num_threads(nThreads) if(nThreads>1)
+    for (int kb=0;kb<nHRUs;kb+=nBlock)
+    {
+      SolveHRUBlock(pModel,pPlan,aPhi,aPhinew,kb,min(nBlock,nHRUs-kb),Options,tt);
+    }//end for kb=0 to nHRUs
   }//end if Options.sol_method==EULER
 
   //===================================================================
@@ -291,16 +522,21 @@ void MassEnergyBalance( CModel            *pModel,
   // -order of processes doesn't matter, converges to specified criteria
   else if(Options.sol_method==ITERATED_HEUN)
   {
-    qs= 0;
-    int    iter = 0;              //iteration counter
-    bool   converg = false;
-    double converg_check = 0.0;
-    double rate1[MAX_CONNECTIONS];
-    double rate2[MAX_CONNECTIONS];
-
-    //Go through all HRUs
+    //Go through all HRUs - each HRU iterates to convergence independently, so HRUs are not
+    //batched into blocks (execution plan block size is 1); the plan only limits the processes visited
+    #pragma omp parallel for schedule(dynamic,HRU_CHUNK) num_threads(nThreads) if(nThreads>1) private(pHRU,i,j,q,qs,nConnections,iFrom,iTo)
     for (k=0;k<nHRUs;k++)
     {
+      int    iter = 0;              //iteration counter
+      bool   converg = false;
+      double converg_check = 0.0;
+      double rate1[MAX_CONNECTIONS];
+      double rate2[MAX_CONNECTIONS];
+      double **guess=rate_guess[0]; //thread-specific rate guesses
+#ifdef _OPENMP
+      guess=rate_guess[omp_get_thread_num()];
+#endif
+
       pHRU=pModel->GetHydroUnit(k);
 
       do  //Iterate
@@ -313,44 +549,41 @@ void MassEnergyBalance( CModel            *pModel,
           aPhinew     [k][i]=aPhi   [k][i];
         }
 
-        //model all other hydrologic processes occuring at HRU scale
+        //model all other hydrologic processes occuring at HRU scale (only those which apply, per the execution plan)
         //-----------------------------------------------------------------
-        for (j=0;j<nProcesses;j++)
+        for (int n=0;n<pPlan->GetNumActive(k);n++)
         {
+          j=pPlan->GetActiveProcess(k,n);
+          const conn_type *ctype=pPlan->GetConnTypes(j);
+
           // ROC 1 - uses initial state var values
           // ROC 2 - uses previous iteration values
-          if (pModel->ApplyProcess(j,aPhi[k]        ,pHRU,Options,tt     ,iFrom,iTo,nConnections,rate1))
+          pModel->ApplyProcess(j,aPhi[k]        ,pHRU,Options,tt     ,iFrom,iTo,nConnections,rate1);
+          pModel->ApplyProcess(j,aPhiPrevIter[k],pHRU,Options,tt_end ,iFrom,iTo,nConnections,rate2);
+
+          for (q=0;q<nConnections;q++)//each process may have multiple connections
           {
-            pModel->ApplyProcess(j,aPhiPrevIter[k],pHRU,Options,tt_end ,iFrom,iTo,nConnections,rate2);
+            guess[j][q] = 0.5*(rate1[q] + rate2[q]);
 
-            if(nConnections>MAX_CONNECTIONS) {
-              cout<<nConnections<<endl;
-              ExitGracefully("MassEnergyBalance:: Maximum number of connections exceeded. Please contact author.",RUNTIME_ERR);
+            if(iFrom[q]==iAtm){               //check if water is coming from precipitation
+              guess[j][q] = rate1[q];    //sets the rate of change to be the original (prevents over filling of SV's)
             }
 
-            for (q=0;q<nConnections;q++)//each process may have multiple connections
+            switch (ctype[q])
             {
-              sv_type typ=pModel->GetStateVarType(iFrom[q]);
-              rate_guess[j][q] = 0.5*(rate1[q] + rate2[q]);
-
-              if(iFrom[q]==iAtm){               //check if water is coming from precipitation
-                rate_guess[j][q] = rate1[q];    //sets the rate of change to be the original (prevents over filling of SV's)
-              }
-
-              if (iTo[q]!=iFrom[q]){
-                aPhinew[k][iFrom[q]]  -= rate_guess[j][q]*tstep;//mass/energy balance maintained
-                aPhinew[k][iTo  [q]]  += rate_guess[j][q]*tstep;//change is an exchange of energy or mass, which must be preserved
-              }
-              else if (CStateVariable::IsWaterStorage(typ) && (typ!=CONVOLUTION)){
-                rates_of_change[q]=0.0;
-                aPhinew[k][iTo  [q]]+=0.0; //likely from redirect - water moves back to itself
-              }
-              else{   //correction for state vars that are not storage compartments
-                aPhinew[k][iTo  [q]]  += rate_guess[j][q]*tstep;
-              }
-            }//end for q=0 to nConnections
-          }
-        }//end for j=0 to nProcesses
+            case CONN_EXCHANGE:
+              aPhinew[k][iFrom[q]]  -= guess[j][q]*tstep;//mass/energy balance maintained
+              aPhinew[k][iTo  [q]]  += guess[j][q]*tstep;//change is an exchange of energy or mass, which must be preserved
+              break;
+            case CONN_TO_ITSELF:
+              aPhinew[k][iTo  [q]]+=0.0; //likely from redirect - water moves back to itself
+              break;
+            case CONN_ACCUMULATE:   //correction for state vars that are not storage compartments
+              aPhinew[k][iTo  [q]]  += guess[j][q]*tstep;
+              break;
+            }
+          }//end for q=0 to nConnections
+        }//end for n=0 to number of active processes
 
         //Calculate convegence criterion
         for(i=0;i<NS;i++)
@@ -365,17 +598,18 @@ void MassEnergyBalance( CModel            *pModel,
         if((converg_check <= Options.convergence_crit) ||
            (iter          == Options.max_iterations))   //convergence check
         {
-          qs  =0;
           iter=0;
           converg = true;
 
-          for(j=0;j<nProcesses;j++)
+          //only processes which apply to HRU k contribute to its cumulative balance (none, if HRU k is disabled)
+          for (int n=0;n<pPlan->GetNumActive(k);n++)
           {
-            nConnections=pModel->GetNumConnections(j);
+            j           =pPlan->GetActiveProcess  (k,n);
+            qs          =pPlan->GetFirstConnection(j);
+            nConnections=pPlan->GetNumConnections (j);
             for(q=0;q<nConnections;q++)
             {
-              pModel->IncrementBalance(qs,k,rate_guess[j][q]*tstep);
-              qs++;
+              pModel->IncrementBalance(qs+q,k,guess[j][q]*tstep);
             }
           }
         }//end of (converg_check <=...)
@@ -466,133 +700,82 @@ void MassEnergyBalance( CModel            *pModel,
   //-----------------------------------------------------------------
   //      ROUTING
   //-----------------------------------------------------------------
-  double res_ht,res_outflow;
-  double down_Q,irr_Q,div_Q, SWvol,div_Q_total;
-  int    pDivert;
-  res_constraint res_const;
-  const int MAX_CONTROL_STRUCTURES=10;
-  double *res_Qstruct=new double [MAX_CONTROL_STRUCTURES];
-  //determine total outflow from HRUs into respective basins (aRouted[p])
-  for (p=0;p<NB;p++)
+  // (with task graph scheduling, runoff collection and routing has already been completed above)
+  const int nRouteThreads=pModel->GetNumRoutingThreads();
+  const int BASIN_CHUNK=8; //number of subbasins dispatched to a thread at a time
+  if (pTG==NULL)
   {
-    aRouted[p]=0.0;
-    aQinnew[p]=0.0;
-  }
-  for (k=0;k<nHRUs;k++)
-  {
-    pHRU=pModel->GetHydroUnit(k);
-    if(pHRU->IsEnabled())
+    //determine total outflow from HRUs into respective basins (aRouted[p])
+    for (p=0;p<NB;p++)
     {
-      p   =pHRU->GetSubBasinIndex();
-      SWvol=(aPhinew[k][iSW]/MM_PER_METER)*(pHRU->GetArea()*M2_PER_KM2);//[m3]
-      if(pHRU->IsLinkedToReservoir()) {
-        pModel->GetSubBasin(p)->GetReservoir()->SetPrecip(SWvol);//[SW is treated as precip on reservoir]
-      }
-      else{
-        //surface water moved instantaneously from HRU to basin reach/channel storage
-        aRouted[p]+=SWvol;
-      }
-      aPhinew[k][iRO]=aPhinew[k][iSW]; //track net runoff [mm]
-      aPhinew[k][iSW]=0.0;             //zero out surface water storage
+      aRouted[p]=0.0;
+      aQinnew[p]=0.0;
     }
-  }
-  // Identify magnitude of flow diversions, calculate inflows
-  for(p=0;p<NB;p++)
-  {
-    //Regular Diversions
-    pBasin=pModel->GetSubBasin(p);
-    for(int i=0; i<pBasin->GetNumDiversions();i++) {
-      div_Q=pBasin->GetDiversionFlow(i,pBasin->GetChannelOutflowRate(),Options,tt,pDivert); //diversions based upon flows at start of timestep
-      if(pDivert!=DOESNT_EXIST)
-      {
-        aQinnew[pDivert]+=div_Q;
-      }
-    }
-    //Diversions from reservoir control structures
-    CReservoir *pRes=pBasin->GetReservoir();
-    if (pRes != NULL) {
-      for (int i = 0; i < pRes->GetNumControlStructures(); i++) {
-        if (pRes->GetControlFlowTarget(i) != pBasin->GetDownstreamID()) {
-          pDivert=pModel->GetSubBasinIndex(pRes->GetControlFlowTarget(i)); //p, not SBID
-          if (pDivert!=DOESNT_EXIST){
-            aQinnew[pDivert]+=pRes->GetControlOutflow(i);
-          }
-        }
+    for (k=0;k<nHRUs;k++)
+    {
+      if(pModel->GetHydroUnit(k)->IsEnabled()){
+        CollectHRURunoff(pModel,k,aPhinew,aRouted,iSW,iRO);
       }
     }
-    //User-specified inflows to upstream end of subbasin reach
-    aQinnew[p]+=pBasin->GetSpecifiedInflow(t+tstep);
+    // Identify magnitude of flow diversions, calculate inflows
+    PrepareSubBasinInflows(pModel,aQinnew,aRouted,pGW2River,Options,tt,true);
 
-    //groundwater contributions to reach
-    if (Options.modeltype == MODELTYPE_COUPLED)
-	  {
-      aRouted[p]+= pGW2River->CalcRiverFlowBySB(p)*tstep;      // [m3]
+    // Management optimization - determines optimal demand delivery/reservoir outflows
+    // ----------------------------------------------------------------------------------------
+    if (Options.management_optimization)
+    {
+      pModel->GetDemandOptimizer()->SolveDemandProblem(pModel, Options, aRouted, tt);
     }
 
-    //preparatory step prior to routing: used to assimilate lake levels and update routing hydrograph for timestep
-    pBasin->UpdateSubBasin(tt,Options);
-  }
-
-  // Management optimization - determines optimal demand delivery/reservoir outflows
-  // ----------------------------------------------------------------------------------------
-  if (Options.management_optimization)
-  {
-    pModel->GetDemandOptimizer()->SolveDemandProblem(pModel, Options, aRouted, tt);
-  }
-
-  // Route water over timestep
-  // ----------------------------------------------------------------------------------------
-  // calculations performed in order from upstream (pp=0) to downstream (pp=nSubBasins-1)
-  for (pp=0;pp<NB;pp++)
-  {
-    p=pModel->GetOrderedSubBasinIndex(pp); //p refers to actual index of basin, pp is ordered list index upstream to down
-
-    pBasin=pModel->GetSubBasin(p);
-    if(pBasin->IsEnabled())
+    // Route water over timestep
+    // ----------------------------------------------------------------------------------------
+    // calculations performed in order from upstream (pp=0) to downstream (pp=nSubBasins-1), one routing level
+    // (i.e., subbasin order) at a time. Subbasins within a level do not drain into one another and are routed in
+    // parallel, each thread using its own outflow arrays. Assimilation and downstream inflows are then applied
+    // serially in the original order, so that results are independent of the number of threads
+    for (int lev=0;lev<pModel->GetNumRoutingLevels();lev++)
     {
-      pBasin->UpdateInflow(aQinnew[p]);              // from upstream, diversions, and specified flows
+      const int pp_start=pModel->GetRoutingLevelStart(lev);
+      const int pp_end  =pModel->GetRoutingLevelStart(lev+1);
 
-      down_Q=pBasin->GetDownstreamInflow(t);         // treated as additional runoff (period starting)
-
-      pBasin->UpdateLateralInflow(aRouted[p]/(tstep*SEC_PER_DAY)+down_Q);//[m3/d]->[m3/s]
-
-      pBasin->RouteWater    (aQoutnew,Options,tt);   
-
-      irr_Q=pBasin->ApplyIrrigationDemand(t+tstep,aQoutnew[pBasin->GetNumSegments()-1],Options.management_optimization);
-
-      div_Q_total=0;
-      for(int i=0; i<pBasin->GetNumDiversions();i++) { //downstream of reservoir!
-        div_Q=pBasin->GetDiversionFlow(i,pBasin->GetChannelOutflowRate(),Options,tt,pDivert); //diversions based upon flows at start of timestep (without diversions)
-        div_Q_total+=div_Q; 
-      }
-
-      res_ht=res_outflow=0.0; res_const=RC_NATURAL;
-      if (pBasin->GetReservoir()!=NULL)
+      #pragma omp parallel for schedule(dynamic,BASIN_CHUNK) num_threads(nRouteThreads) if((nRouteThreads>1) && (pp_end-pp_start>BASIN_CHUNK))
+      for (int ppl=pp_start;ppl<pp_end;ppl++)
       {
-        double res_inflow_last = pBasin->GetOutflowArray()[pBasin->GetNumSegments()-1];
-        double res_inflow =max((aQoutnew[pBasin->GetNumSegments()-1]-div_Q_total-irr_Q),0.0);
-        res_ht=pBasin->GetReservoir()->RouteWater(res_inflow_last,res_inflow,pModel,Options,tt,res_outflow,res_const,res_Qstruct);
-      }
-
-      pBasin->UpdateOutflows(aQoutnew,irr_Q,div_Q_total,res_ht,res_outflow,res_const,res_Qstruct,Options,tt,false);//actually updates flow values here
-
-      pModel->AssimilationOverride(p,Options,tt); //modifies flows using assimilation, if needed
+        int th=0;     //routing thread index
+#ifdef _OPENMP
+        th=omp_get_thread_num();
+#endif
+        int pl=pModel->GetOrderedSubBasinIndex(ppl); //pl refers to actual index of basin, ppl is ordered list index upstream to down
+        if(pModel->GetSubBasin(pl)->IsEnabled())
+        {
+          RouteSubBasin(pModel,pl,aQinnew,aRouted,aQoutnew[th],aResQstruct[th],Options,tt);
+        }
+      }//end for ppl...
 
-      pTo   =pModel->GetDownstreamBasin(p);
-      if(pTo!=DOESNT_EXIST)//update downstream inflows
+      for (pp=pp_start;pp<pp_end;pp++)
       {
-        aQinnew[pTo]+=pBasin->GetOutflowRate();
-      }
+        p=pModel->GetOrderedSubBasinIndex(pp);
+        pBasin=pModel->GetSubBasin(p);
+        if(pBasin->IsEnabled())
+        {
+          pModel->AssimilationOverride(p,Options,tt); //modifies flows using assimilation, if needed
 
-      if(pBasin->GetReservoir()!=NULL) {//update AET for reservoir-linked HRUs
-        k=pBasin->GetReservoir()->GetHRUIndex();
-        if ((k!=DOESNT_EXIST) && (iAET!=DOESNT_EXIST)){
-          aPhinew[k][iAET]=pBasin->GetReservoir()->GetAET();//[mm/d]
+          pTo   =pModel->GetDownstreamBasin(p);
+          if(pTo!=DOESNT_EXIST)//update downstream inflows
+          {
+            aQinnew[pTo]+=pBasin->GetOutflowRate();
+          }
+
+          if(pBasin->GetReservoir()!=NULL) {//update AET for reservoir-linked HRUs
+            k=pBasin->GetReservoir()->GetHRUIndex();
+            if ((k!=DOESNT_EXIST) && (iAET!=DOESNT_EXIST)){
+              aPhinew[k][iAET]=pBasin->GetReservoir()->GetAET();//[mm/d]
+            }
+          }
         }
-      }
-    }
-  }//end for pp...
-  delete [] res_Qstruct;
+      }//end for pp...
+    }//end for lev...
+  }//end if pTG==NULL
 
   //-----------------------------------------------------------------
   //      CONSTITUENT (MASS OR ENERGY) ROUTING
@@ -659,36 +842,28 @@ void MassEnergyBalance( CModel            *pModel,
   }//end (c=0;c<nConstituents;c++)
 
   //update state variable values=====================================
-  for (k=0;k<nHRUs;k++){
-    pHRU=pModel->GetHydroUnit(k);
-    if(pHRU->IsEnabled())
-    {
-      for(i=0;i<NS;i++){
-        pHRU->SetStateVarValue(i,aPhinew[k][i]);
+  //disabled HRUs retain their start-of-timestep states
+  if (pSM->GetLayout()==LAYOUT_HRU_MAJOR)
+  {
+    for (k=0;k<nHRUs;k++){
+      if(!pModel->GetHydroUnit(k)->IsEnabled()){
+        memcpy(aPhinew[k],pSM->GetData()+k*pSM->GetHRUStride(),NS*sizeof(double));
+      }
+    }
+    pSM->SwapScratch();
+  }
+  else
+  {
+    for (k=0;k<nHRUs;k++){
+      if(pModel->GetHydroUnit(k)->IsEnabled()){
+        for(i=0;i<NS;i++){pSM->SetValue(k,i,aPhinew[k][i]);}
       }
     }
   }
 
-  //delete static arrays (only called once)=========================
+  //reset persistent working memory at end of simulation (e.g., prior to next ensemble member)
   if(t>=Options.duration-Options.timestep)
   {
-    if(DESTRUCTOR_DEBUG) { cout<<"DELETING STATIC ARRAYS IN MASSENERGYBALANCE"<<endl; }
-    for(k=0;k<nHRUs;k++) { delete[] aPhi[k];         } delete[] aPhi;         aPhi=NULL;
-    for(k=0;k<nHRUs;k++) { delete[] aPhinew[k];      } delete[] aPhinew;      aPhinew=NULL;
-    for(k=0;k<nHRUs;k++) { delete[] aPhiPrevIter[k]; } delete[] aPhiPrevIter; aPhiPrevIter=NULL;
-    if(Options.sol_method == ITERATED_HEUN)
-    {
-      for(j=0;j<nProcesses;j++) { delete[] rate_guess[j]; }  delete[] rate_guess; rate_guess=NULL;
-    }
-    delete[] aQinnew;      aQinnew     = NULL;
-    delete[] aQoutnew;     aQoutnew    = NULL;
-    delete[] aRouted;      aRouted     = NULL;
-    //delete transport static arrays.
-    if(nConstituents>0)
-    {
-      delete[] aMinnew;
-      delete[] aRoutedMass;
-      delete[] aMoutnew;
-    }
+    pWS->Reset();
   }
 }
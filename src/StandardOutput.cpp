@@ -2918,22 +2918,24 @@ void WriteNetCDFBasinList(const int ncid,const int varid,const CModel* pModel,bo
 }
 
 
-//JRC \todo[clean] - find a best place to put this. Might eventually require separate file?
 //////////////////////////////////////////////////////////////////
-/// \brief return calibration objective function
-/// \notes right now only supports hydrograph goodness of fit metrics at one subbasin
+/// \brief finds observation series, diagnostic, and evaluation period of calibration objective function
 /// \param &calib_SBID [in] target subbasin ID
 /// \param &calib_Obj [in] calibration objective diagnostics (e.g., NSE)
+/// \param calib_period [in] name of calibration diagnostic period
+/// \param ii [out] observation index
+/// \param jj [out] diagnostic index
 //
-double CModel::GetObjFuncVal(long calib_SBID,diag_type calib_Obj, const string calib_period) const
+void CModel::GetObjFuncTarget(long calib_SBID, diag_type calib_Obj, const string calib_period,
+                              int &ii, int &jj, double &starttime, double &endtime,
+                              comparison &compare, double &thresh) const
 {
-  double starttime=0.0;
-  double endtime  =0.0;
-  comparison compare=COMPARE_GREATERTHAN;
-  double thresh=-ALMOST_INF;
-  double objval;
-  int ii=DOESNT_EXIST; // observation index
-  int jj=DOESNT_EXIST; // diagnostic measure
+  starttime=0.0;
+  endtime  =0.0;
+  compare  =COMPARE_GREATERTHAN;
+  thresh   =-ALMOST_INF;
+  ii=DOESNT_EXIST;
+  jj=DOESNT_EXIST;
 
   //- grab diagnostic information -----------------------------------
   for(int d=0;d<_nDiagPeriods;d++) {
@@ -2955,6 +2957,24 @@ double CModel::GetObjFuncVal(long calib_SBID,diag_type calib_Obj, const string c
   ExitGracefullyIf(ii==DOESNT_EXIST,"GetObjFuncVal: unable to find calibration target time series (hydrograph in basin :CalibrationSBID)",BAD_DATA);
   ExitGracefullyIf(jj==DOESNT_EXIST,"GetObjFuncVal: unable to find calibration target diagnostic ",BAD_DATA);
   ExitGracefullyIf(endtime==0.0,    "GetObjFuncVal: unable to find calibration period with this name ",BAD_DATA);
+}
+
+//JRC \todo[clean] - find a best place to put this. Might eventually require separate file?
+//////////////////////////////////////////////////////////////////
+/// \brief return calibration objective function
+/// \notes right now only supports hydrograph goodness of fit metrics at one subbasin
+/// \param &calib_SBID [in] target subbasin ID
+/// \param &calib_Obj [in] calibration objective diagnostics (e.g., NSE)
+//
+double CModel::GetObjFuncVal(long calib_SBID,diag_type calib_Obj, const string calib_period) const
+{
+  double starttime,endtime,thresh;
+  comparison compare;
+  double objval;
+  int ii; // observation index
+  int jj; // diagnostic measure
+
+  GetObjFuncTarget(calib_SBID,calib_Obj,calib_period,ii,jj,starttime,endtime,compare,thresh);
 
   //- Calculate objective function -----------------------------------
   objval=_pDiagnostics[jj]->CalculateDiagnostic(_pModeledTS[ii],_pObservedTS[ii],_pObsWeightTS[ii],starttime,endtime,compare,thresh,*_pOptStruct);
@@ -2966,3 +2986,21 @@ double CModel::GetObjFuncVal(long calib_SBID,diag_type calib_Obj, const string c
   }
   return objval;
 }
+
+//////////////////////////////////////////////////////////////////
+/// \brief creates online accumulator of calibration objective function, updated during simulation
+/// \param &calib_SBID [in] target subbasin ID
+/// \param &calib_Obj [in] calibration objective diagnostic (must satisfy CDiagAccumulator::IsBounded())
+/// \param calib_period [in] name of calibration diagnostic period
+/// \return pointer to new accumulator; must be deleted by calling routine
+//
+CDiagAccumulator *CModel::CreateObjFuncAccumulator(long calib_SBID,diag_type calib_Obj, const string calib_period) const
+{
+  double starttime,endtime,thresh;
+  comparison compare;
+  int ii,jj;
+
+  GetObjFuncTarget(calib_SBID,calib_Obj,calib_period,ii,jj,starttime,endtime,compare,thresh);
+
+  return new CDiagAccumulator(calib_Obj,_pModeledTS[ii],_pObservedTS[ii],_pObsWeightTS[ii],starttime,endtime,compare,thresh,*_pOptStruct);
+}
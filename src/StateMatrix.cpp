@@ -0,0 +1,81 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2023 the Raven Development Team
+  ----------------------------------------------------------------*/
+#include "StateMatrix.h"
+
+//////////////////////////////////////////////////////////////////
+/// \brief Constructor - reserves zeroed, aligned state storage
+///
+/// \param nHRUs [in] number of HRUs in model
+/// \param nSVs [in] number of state variables in model
+/// \param layout [in] memory layout of storage
+//
+CStateMatrix::CStateMatrix(const int nHRUs, const int nSVs, const state_layout layout)
+{
+  const int pad=STATE_ALIGN_BYTES/sizeof(double);
+  _nHRUs =nHRUs;
+  _nSVs  =nSVs;
+  _layout=layout;
+
+  if (_layout==LAYOUT_HRU_MAJOR){_ld=((_nSVs +pad-1)/pad)*pad; _size=_ld*_nHRUs;}
+  else                          {_ld=((_nHRUs+pad-1)/pad)*pad; _size=_ld*_nSVs; }
+
+  _aRaw[0]=_aRaw[1]=NULL;
+  _aScratch=NULL;
+  _aData   =AllocateAligned(_size,_aRaw[0]);
+  if (_layout==LAYOUT_HRU_MAJOR){
+    _aScratch=AllocateAligned(_size,_aRaw[1]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Destructor
+//
+CStateMatrix::~CStateMatrix()
+{
+  if (DESTRUCTOR_DEBUG){cout<<"  DELETING STATE MATRIX"<<endl;}
+  delete [] _aRaw[0];
+  delete [] _aRaw[1];
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Reserves zeroed array of doubles aligned to STATE_ALIGN_BYTES
+///
+/// \param size [in] number of doubles required
+/// \param raw [out] unaligned memory, to be deleted by caller
+/// \return pointer to aligned array within raw memory
+//
+double *CStateMatrix::AllocateAligned(const int size, double *&raw)
+{
+  const int pad=STATE_ALIGN_BYTES/sizeof(double);
+  raw=NULL;
+  raw=new double [size+pad];
+  ExitGracefullyIf(raw==NULL,"CStateMatrix::AllocateAligned",OUT_OF_MEMORY);
+  for (int n=0;n<size+pad;n++){raw[n]=0.0;}
+
+  size_t offset=(size_t)(raw)%STATE_ALIGN_BYTES;
+  if (offset==0){return raw;}
+  return raw+(STATE_ALIGN_BYTES-offset)/sizeof(double);
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Copies current state block into scratch block (HRU-major layout only)
+//
+void CStateMatrix::CopyToScratch()
+{
+  ExitGracefullyIf(_aScratch==NULL,"CStateMatrix::CopyToScratch: no scratch storage for this layout",RUNTIME_ERR);
+  memcpy(_aScratch,_aData,_size*sizeof(double));
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Exchanges current and scratch blocks, i.e., commits scratch block as current state (HRU-major layout only)
+/// \remark HRUs see the exchange immediately, as they view the current block through GetDataAddress()
+//
+void CStateMatrix::SwapScratch()
+{
+  ExitGracefullyIf(_aScratch==NULL,"CStateMatrix::SwapScratch: no scratch storage for this layout",RUNTIME_ERR);
+  double *tmp=_aData;
+  _aData     =_aScratch;
+  _aScratch  =tmp;
+}
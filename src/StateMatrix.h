@@ -0,0 +1,56 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2023 the Raven Development Team
+  ----------------------------------------------------------------
+  class definitions:
+  CStateMatrix
+  ----------------------------------------------------------------*/
+
+#ifndef STATEMATRIX_H
+#define STATEMATRIX_H
+
+#include "RavenInclude.h"
+
+const int STATE_ALIGN_BYTES=64; ///< alignment (in bytes) of state storage blocks and of each HRU row/state variable column
+
+///////////////////////////////////////////////////////////////////
+/// \brief Data abstraction for contiguous model-wide storage of HRU state variables
+/// \details Owned by CModel and created in CModel::Initialize(). Each CHydroUnit then
+///   views its state variables within this matrix. In the HRU-major layout, a second (scratch)
+///   block of identical size is reserved so that the solver may compute end-of-timestep states
+///   in place and exchange blocks rather than copying states back to each HRU
+//
+class CStateMatrix
+{
+private:/*------------------------------------------------------*/
+  int           _nHRUs;       ///< number of HRUs
+  int           _nSVs;        ///< number of state variables
+  state_layout  _layout;      ///< memory layout
+  int           _ld;          ///< leading dimension (padded row length for HRU-major, padded column length for SV-major)
+  int           _size;        ///< number of doubles in each block (including padding)
+
+  double       *_aRaw[2];     ///< unaligned memory of current and scratch blocks (as allocated)
+  double       *_aData;       ///< aligned current (committed) state block
+  double       *_aScratch;    ///< aligned scratch state block (NULL for SV-major layout)
+
+  static double *AllocateAligned(const int size, double *&raw);
+
+public:/*-------------------------------------------------------*/
+  CStateMatrix(const int nHRUs, const int nSVs, const state_layout layout);
+  ~CStateMatrix();
+
+  inline state_layout   GetLayout      () const { return _layout; }
+  inline int            GetHRUStride   () const { return (_layout==LAYOUT_HRU_MAJOR) ? _ld : 1;   } ///< distance between consecutive HRUs of same state variable
+  inline int            GetSVStride    () const { return (_layout==LAYOUT_HRU_MAJOR) ? 1   : _ld; } ///< distance between consecutive state variables of same HRU
+  inline int            GetBlockSize   () const { return _size; }
+  inline double        *GetData        () const { return _aData; }
+  inline double        *GetScratch     () const { return _aScratch; }
+  inline double *const *GetDataAddress () const { return &_aData; }    ///< used by HRUs to view current block through block exchanges
+
+  inline double         GetValue(const int k, const int i) const { return _aData[k*GetHRUStride()+i*GetSVStride()]; }
+  inline void           SetValue(const int k, const int i, const double &val) { _aData[k*GetHRUStride()+i*GetSVStride()]=val; }
+
+  void                  CopyToScratch  ();
+  void                  SwapScratch    ();
+};
+#endif
@@ -2271,7 +2271,7 @@ void CSubBasin::RouteWater(double *aQout_new,//[m3/s][size:_nSegments]
     dt=min(K,tstep);
     //dt=tstep;
 
-    static double aQoutStored[MAX_RIVER_SEGS];
+    double aQoutStored[MAX_RIVER_SEGS];
     for (seg=0;seg<_nSegments;seg++){aQoutStored[seg]=_aQout[seg];}
     //cout<<"check: "<< 2*K*X<<" < "<<dt<< " < " << 2*K*(1-X)<<" K="<<K<<" X="<<X<<" dt="<<dt<<endl;
     for (double t=0;t<tstep;t+=dt)//Local time-stepping
@@ -2527,6 +2527,54 @@ void CSubBasin::WriteToSolutionFile (ofstream &RVC) const
   }
 }
 //////////////////////////////////////////////////////////////////
+/// \brief returns number of values stored by SaveToSnapshot()
+/// \return size of subbasin (and reservoir) state in an in-memory model snapshot
+//
+int CSubBasin::GetSnapshotSize() const
+{
+  int size=8+(_nSegments+1)+(_nQlatHist+1)+_nQinHist;
+  if (_pReservoir!=NULL){size+=_pReservoir->GetSnapshotSize();}
+  return size;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief copies subbasin state variables (same as those in solution file) to in-memory snapshot
+/// \param *aSnapshot [out] snapshot array
+/// \param &ii [in/out] current position in snapshot array (incremented by GetSnapshotSize())
+//
+void CSubBasin::SaveToSnapshot(double *aSnapshot, int &ii) const
+{
+  aSnapshot[ii++]=_channel_storage;
+  aSnapshot[ii++]=_rivulet_storage;
+  aSnapshot[ii++]=_Qlocal;   aSnapshot[ii++]=_QlocLast; //not in solution file, but required for exact continuation
+  aSnapshot[ii++]=_Qirr;     aSnapshot[ii++]=_QirrLast;
+  aSnapshot[ii++]=_Qdiverted;aSnapshot[ii++]=_QdivLast;
+  for (int i=0;i<_nSegments;i++){aSnapshot[ii++]=_aQout    [i];} aSnapshot[ii++]=_QoutLast;
+  for (int i=0;i<_nQlatHist;i++){aSnapshot[ii++]=_aQlatHist[i];} aSnapshot[ii++]=_QlatLast;
+  for (int i=0;i<_nQinHist; i++){aSnapshot[ii++]=_aQinHist [i];}
+  if (_pReservoir!=NULL){
+    _pReservoir->SaveToSnapshot(aSnapshot,ii);
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief restores subbasin state variables from in-memory snapshot written by SaveToSnapshot()
+/// \param *aSnapshot [in] snapshot array
+/// \param &ii [in/out] current position in snapshot array (incremented by GetSnapshotSize())
+//
+void CSubBasin::RestoreFromSnapshot(const double *aSnapshot, int &ii)
+{
+  _channel_storage=aSnapshot[ii++];
+  _rivulet_storage=aSnapshot[ii++];
+  _Qlocal   =aSnapshot[ii++]; _QlocLast=aSnapshot[ii++];
+  _Qirr     =aSnapshot[ii++]; _QirrLast=aSnapshot[ii++];
+  _Qdiverted=aSnapshot[ii++]; _QdivLast=aSnapshot[ii++];
+  for (int i=0;i<_nSegments;i++){_aQout    [i]=aSnapshot[ii++];} _QoutLast=aSnapshot[ii++];
+  for (int i=0;i<_nQlatHist;i++){_aQlatHist[i]=aSnapshot[ii++];} _QlatLast=aSnapshot[ii++];
+  for (int i=0;i<_nQinHist; i++){_aQinHist [i]=aSnapshot[ii++];}
+  if (_pReservoir!=NULL){
+    _pReservoir->RestoreFromSnapshot(aSnapshot,ii);
+  }
+}
+//////////////////////////////////////////////////////////////////
 /// \brief clears all time series data for re-read of .rvt file
 /// \remark Called only in ensemble mode
 ///
@@ -322,6 +322,9 @@ public:/*-------------------------------------------------------*/
                                             const time_struct &tt) const;
 
   void            WriteToSolutionFile      (ofstream &OUT) const;
+  int             GetSnapshotSize          () const;
+  void            SaveToSnapshot           (double *aSnapshot, int &ii) const;
+  void            RestoreFromSnapshot      (const double *aSnapshot, int &ii);
 };
 
 ///////////////////////////////////////////////////////////////////
@@ -0,0 +1,172 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2023 the Raven Development Team
+  ----------------------------------------------------------------*/
+#include "TaskGraph.h"
+
+//////////////////////////////////////////////////////////////////
+/// \brief Constructor - builds task dependencies from HRU membership and subbasin connectivity
+///
+/// \param nHRUs [in] number of HRUs in model
+/// \param nBlock [in] number of consecutive HRUs processed in each HRU block task
+/// \param nSubBasins [in] number of subbasins in model
+/// \param *aHRUBasin [in] subbasin index of each HRU [size: nHRUs]
+/// \param *aResHRU [in] global index of HRU linked to reservoir of each subbasin, or DOESNT_EXIST [size: nSubBasins]
+/// \param *aDownstream [in] index of downstream subbasin of each subbasin, or DOESNT_EXIST [size: nSubBasins]
+/// \param *aOrderedSB [in] subbasin indices ordered upstream to downstream [size: nSubBasins]
+//
+CTaskGraph::CTaskGraph(const int  nHRUs,
+                       const int  nBlock,
+                       const int  nSubBasins,
+                       const int *aHRUBasin,
+                       const int *aResHRU,
+                       const int *aDownstream,
+                       const int *aOrderedSB)
+{
+  int k,p,pp,n,b;
+  ExitGracefullyIf(nBlock<1,"CTaskGraph::Constructor: invalid block size",RUNTIME_ERR);
+  _nHRUs      =nHRUs;
+  _nBlock     =nBlock;
+  _nBlockTasks=(_nHRUs+_nBlock-1)/_nBlock;
+  _nSubBasins =nSubBasins;
+  _nTasks     =_nBlockTasks+_nSubBasins;
+
+  //HRUs of each subbasin (ascending order)
+  //----------------------------------------------------------------------
+  _aHRUStart =new int [_nSubBasins+1];
+  _aBasinHRUs=new int [max(_nHRUs,1)];
+  for (p=0;p<=_nSubBasins;p++){_aHRUStart[p]=0;}
+  for (k=0;k<_nHRUs;k++){_aHRUStart[aHRUBasin[k]+1]++;}
+  for (p=0;p<_nSubBasins;p++){_aHRUStart[p+1]+=_aHRUStart[p];}
+  int *count=new int [_nSubBasins];
+  for (p=0;p<_nSubBasins;p++){count[p]=0;}
+  for (k=0;k<_nHRUs;k++){
+    p=aHRUBasin[k];
+    _aBasinHRUs[_aHRUStart[p]+count[p]]=k; count[p]++;
+  }
+
+  //upstream subbasins of each subbasin (routing order)
+  //----------------------------------------------------------------------
+  _aUpStart =new int [_nSubBasins+1];
+  _aUpstream=new int [max(_nSubBasins,1)];
+  for (p=0;p<=_nSubBasins;p++){_aUpStart[p]=0;}
+  for (p=0;p<_nSubBasins;p++){
+    if (aDownstream[p]!=DOESNT_EXIST){_aUpStart[aDownstream[p]+1]++;}
+  }
+  for (p=0;p<_nSubBasins;p++){_aUpStart[p+1]+=_aUpStart[p];}
+  for (p=0;p<_nSubBasins;p++){count[p]=0;}
+  for (pp=0;pp<_nSubBasins;pp++){
+    int pTo=aDownstream[aOrderedSB[pp]];
+    if (pTo!=DOESNT_EXIST){
+      _aUpstream[_aUpStart[pTo]+count[pTo]]=aOrderedSB[pp]; count[pTo]++;
+    }
+  }
+  delete [] count;
+
+  //successors of each task: HRU block -> routing of subbasins with HRUs in block; routing -> downstream routing
+  //----------------------------------------------------------------------
+  int *aCap     =new int [_nTasks+1];  //maximum number of successors of each task (offsets into aSuccTmp)
+  int *aNumSucc =new int [_nTasks];
+  _aNumPreds    =new int [_nTasks];
+  _aPending     =new int [_nTasks];
+  for (n=0;n<_nTasks;n++){aNumSucc[n]=0; _aNumPreds[n]=0; aCap[n+1]=1;}
+  for (n=0;n<_nBlockTasks;n++){aCap[n+1]=GetBlockSize(n);}
+  for (p=0;p<_nSubBasins;p++){
+    if (aResHRU[p]!=DOESNT_EXIST){aCap[aResHRU[p]/_nBlock+1]++;} //reservoir HRU may lie outside of subbasin
+  }
+  aCap[0]=0;
+  for (n=0;n<_nTasks;n++){aCap[n+1]+=aCap[n];}
+  int *aSuccTmp =new int [aCap[_nTasks]];
+
+  for (n=0;n<_nBlockTasks;n++)
+  {
+    for (b=0;b<GetBlockSize(n);b++){
+      AddUniqueSuccessor(aSuccTmp+aCap[n],aNumSucc[n],_nBlockTasks+aHRUBasin[n*_nBlock+b]);
+    }
+  }
+  for (p=0;p<_nSubBasins;p++)
+  {
+    if (aResHRU[p]!=DOESNT_EXIST){
+      n=aResHRU[p]/_nBlock;
+      AddUniqueSuccessor(aSuccTmp+aCap[n],aNumSucc[n],_nBlockTasks+p);
+    }
+    n=_nBlockTasks+p;
+    if (aDownstream[p]!=DOESNT_EXIST){
+      AddUniqueSuccessor(aSuccTmp+aCap[n],aNumSucc[n],_nBlockTasks+aDownstream[p]);
+    }
+  }
+
+  _aSuccStart=new int [_nTasks+1];
+  _aSuccStart[0]=0;
+  for (n=0;n<_nTasks;n++){_aSuccStart[n+1]=_aSuccStart[n]+aNumSucc[n];}
+  _aSucc=new int [max(_aSuccStart[_nTasks],1)];
+  for (n=0;n<_nTasks;n++){
+    for (int i=0;i<aNumSucc[n];i++){
+      _aSucc[_aSuccStart[n]+i]=aSuccTmp[aCap[n]+i];
+      _aNumPreds[aSuccTmp[aCap[n]+i]]++;
+    }
+  }
+  delete [] aSuccTmp;
+  delete [] aNumSucc;
+  delete [] aCap;
+
+  Reset();
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Destructor
+//
+CTaskGraph::~CTaskGraph()
+{
+  if (DESTRUCTOR_DEBUG){cout<<"  DELETING TASK GRAPH"<<endl;}
+  delete [] _aNumPreds;
+  delete [] _aPending;
+  delete [] _aSuccStart;
+  delete [] _aSucc;
+  delete [] _aUpStart;
+  delete [] _aUpstream;
+  delete [] _aHRUStart;
+  delete [] _aBasinHRUs;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Appends task n to list of successors, if not already present
+///
+/// \param *aSucc [in/out] list of successors
+/// \param &nSucc [in/out] length of list
+/// \param n [in] successor task index
+//
+void CTaskGraph::AddUniqueSuccessor(int *aSucc, int &nSucc, const int n)
+{
+  for (int i=0;i<nSucc;i++){if (aSucc[i]==n){return;}}
+  aSucc[nSucc]=n; nSucc++;
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Restores dependency counts of all tasks, prior to execution of graph in each time step
+//
+void CTaskGraph::Reset()
+{
+  for (int n=0;n<_nTasks;n++){_aPending[n]=_aNumPreds[n];}
+}
+
+//////////////////////////////////////////////////////////////////
+/// \brief Marks one dependency of task n as complete
+/// \remark may be called simultaneously from multiple threads; the atomic update is relaxed, so flushes
+///   publish the results of the completed predecessor before the decrement and make them visible
+///   to the thread that runs task n after the count reaches zero
+///
+/// \param n [in] task index
+/// \return true if all dependencies of task n are now complete (i.e., task n may be executed)
+//
+bool CTaskGraph::Release(const int n)
+{
+  int remaining;
+  #pragma omp flush
+  #pragma omp atomic capture
+  remaining=--_aPending[n];
+  if (remaining==0){
+    #pragma omp flush
+  }
+  return (remaining==0);
+}
@@ -0,0 +1,69 @@
+/*----------------------------------------------------------------
+  Raven Library Source Code
+  Copyright (c) 2008-2023 the Raven Development Team
+  ----------------------------------------------------------------
+  class definitions:
+  CTaskGraph
+  ----------------------------------------------------------------*/
+
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include "RavenInclude.h"
+
+///////////////////////////////////////////////////////////////////
+/// \brief Data abstraction for dependency graph of solver tasks (task graph scheduling)
+/// \details Two types of task are represented: (1) processing of a block of consecutive HRUs (as defined by the
+///   execution plan) and (2) routing of a subbasin. Routing of subbasin p depends upon all HRU blocks containing
+///   HRUs of subbasin p (including its reservoir HRU) and upon routing of all subbasins directly upstream.
+///   Task indices 0..nBlockTasks-1 are HRU blocks; nBlockTasks+p is routing of subbasin p.
+///   Created in CModel::Initialize() only if task graph scheduling is requested and permitted
+//
+class CTaskGraph
+{
+private:/*------------------------------------------------------*/
+  int   _nHRUs;          ///< number of HRUs
+  int   _nBlock;         ///< number of HRUs in each HRU block task
+  int   _nBlockTasks;    ///< number of HRU block tasks
+  int   _nSubBasins;     ///< number of subbasins (routing tasks)
+  int   _nTasks;         ///< total number of tasks
+
+  int  *_aNumPreds;      ///< number of tasks upon which each task depends [size: _nTasks]
+  int  *_aPending;       ///< number of dependencies not yet completed in current time step [size: _nTasks]
+  int  *_aSuccStart;     ///< index of first successor of each task in _aSucc [size: _nTasks+1]
+  int  *_aSucc;          ///< successor (dependent) task indices
+  int  *_aUpStart;       ///< index of first upstream subbasin of each subbasin in _aUpstream [size: _nSubBasins+1]
+  int  *_aUpstream;      ///< indices of subbasins draining directly into each subbasin, in routing order [size: _nSubBasins]
+  int  *_aHRUStart;      ///< index of first HRU of each subbasin in _aBasinHRUs [size: _nSubBasins+1]
+  int  *_aBasinHRUs;     ///< global indices of HRUs in each subbasin, in ascending order [size: _nHRUs]
+
+  static void AddUniqueSuccessor(int *aSucc, int &nSucc, const int n);
+
+public:/*-------------------------------------------------------*/
+  CTaskGraph(const int  nHRUs,
+             const int  nBlock,
+             const int  nSubBasins,
+             const int *aHRUBasin,
+             const int *aResHRU,
+             const int *aDownstream,
+             const int *aOrderedSB);
+  ~CTaskGraph();
+
+  inline int  GetNumTasks        ()            const { return _nTasks; }
+  inline bool IsHRUBlockTask     (const int n) const { return (n<_nBlockTasks); }
+  inline int  GetBlockStart      (const int n) const { return n*_nBlock; }                 ///< global index of first HRU in HRU block task n
+  inline int  GetBlockSize       (const int n) const { return min(_nBlock,_nHRUs-n*_nBlock); }
+  inline int  GetSubBasinIndex   (const int n) const { return n-_nBlockTasks; }            ///< subbasin index of routing task n
+  inline bool IsInitiallyReady   (const int n) const { return (_aNumPreds[n]==0); }
+
+  inline int  GetNumSuccessors   (const int n) const { return _aSuccStart[n+1]-_aSuccStart[n]; }
+  inline int  GetSuccessor       (const int n, const int i) const { return _aSucc[_aSuccStart[n]+i]; }
+  inline int  GetNumUpstream     (const int p) const { return _aUpStart[p+1]-_aUpStart[p]; }
+  inline int  GetUpstream        (const int p, const int i) const { return _aUpstream[_aUpStart[p]+i]; }
+  inline int  GetNumBasinHRUs    (const int p) const { return _aHRUStart[p+1]-_aHRUStart[p]; }
+  inline int  GetBasinHRU        (const int p, const int i) const { return _aBasinHRUs[_aHRUStart[p]+i]; }
+
+  void        Reset              ();
+  bool        Release            (const int n);
+};
+#endif
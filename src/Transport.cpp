@@ -927,3 +927,32 @@ void  CTransportModel::WriteMajorOutput(ofstream &RVC) const
     _pConstitModels[c]->WriteMajorOutput(RVC);
   }
 }
+//////////////////////////////////////////////////////////////////
+/// \brief returns number of values in in-memory snapshot of routing mass of all constituents
+//
+int   CTransportModel::GetSnapshotSize() const
+{
+  int size=0;
+  for(int c=0;c<_nConstituents;c++) {
+    size+=_pConstitModels[c]->GetSnapshotSize();
+  }
+  return size;
+}
+//////////////////////////////////////////////////////////////////
+/// \brief copies routing mass of all constituents to in-memory snapshot
+//
+void  CTransportModel::SaveToSnapshot(double *aSnapshot, int &ii) const
+{
+  for(int c=0;c<_nConstituents;c++) {
+    _pConstitModels[c]->SaveToSnapshot(aSnapshot,ii);
+  }
+}
+//////////////////////////////////////////////////////////////////
+/// \brief restores routing mass of all constituents from in-memory snapshot
+//
+void  CTransportModel::RestoreFromSnapshot(const double *aSnapshot, int &ii)
+{
+  for(int c=0;c<_nConstituents;c++) {
+    _pConstitModels[c]->RestoreFromSnapshot(aSnapshot,ii);
+  }
+}
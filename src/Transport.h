@@ -181,6 +181,10 @@ public:/*-------------------------------------------------------*/
   void   WriteMinorOutput           (const optStruct &Options,const time_struct &tt) const;
   void   WriteMajorOutput           (ofstream& RVC) const;
   void   CloseOutputFiles           () const;
+
+  int    GetSnapshotSize            () const;
+  void   SaveToSnapshot             (double *aSnapshot, int &ii) const;
+  void   RestoreFromSnapshot        (const double *aSnapshot, int &ii);
 };
 ///////////////////////////////////////////////////////////////////
 /// \brief Class for coordinating transport simulation for specific constituent
@@ -323,6 +327,10 @@ public:/*-------------------------------------------------------*/
   virtual void   WriteNetCDFMinorOutput      (const optStruct &Options,const time_struct& tt);
           void   WriteMajorOutput            (ofstream& RVC) const;
   virtual void   CloseOutputFiles            ();
+
+          int    GetSnapshotSize             () const;
+          void   SaveToSnapshot              (double *aSnapshot, int &ii) const;
+          void   RestoreFromSnapshot         (const double *aSnapshot, int &ii);
 };
 
 #endif